@@ -0,0 +1,85 @@
+/* Helpers shared by the benchmarks. Each benchmark is a standalone program
+ * which times features with events sent directly to them, and prints one line
+ * per case. Build with optimizations, e.g.
+ *
+ *   g++ -std=c++14 -O2 -I<path to Myo SDK>/include \
+ *       benchmarks/FeatureBenchmark.cpp -o feature_benchmark
+ *
+ * This header replaces the global operator new to count allocations, so it
+ * must be included by exactly one source file of a benchmark program.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+
+namespace benchmark {
+namespace detail {
+std::atomic<unsigned long long> allocations(0);
+}
+
+struct Result {
+  double ns_per_event;
+  double allocations_per_event;
+};
+
+// Calls body (which sends events_per_call events) until at least min_ms have
+// passed and returns the mean cost per event.
+template <typename Body>
+Result measure(int events_per_call, Body body, int min_ms = 200) {
+  typedef std::chrono::steady_clock Clock;
+  // Warm up caches and let lazily created state be created.
+  for (int i = 0; i < 1000; ++i) {
+    body();
+  }
+
+  long calls = 0;
+  unsigned long long start_allocations = detail::allocations;
+  Clock::time_point start = Clock::now(), end;
+  do {
+    for (int i = 0; i < 1000; ++i) {
+      body();
+    }
+    calls += 1000;
+    end = Clock::now();
+  } while (end - start < std::chrono::milliseconds(min_ms));
+  double ns =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+  double events = static_cast<double>(calls) * events_per_call;
+  unsigned long long allocations = detail::allocations - start_allocations;
+  return Result{ns / events, allocations / events};
+}
+
+void report(const std::string& name, const Result& result) {
+  std::printf("%-44s %10.1f ns/event %14.0f events/sec %8.3f allocs/event\n",
+              name.c_str(), result.ns_per_event, 1e9 / result.ns_per_event,
+              result.allocations_per_event);
+}
+}
+
+void* operator new(std::size_t size) {
+  benchmark::detail::allocations.fetch_add(1, std::memory_order_relaxed);
+  if (void* memory = std::malloc(size ? size : 1)) {
+    return memory;
+  }
+  throw std::bad_alloc();
+}
+
+// The replacements of operator delete free what the operator new above
+// mallocs. GCC does not see that the two are paired when it inlines a delete,
+// so it warns that free is given memory from new.
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+void operator delete(void* memory) noexcept { std::free(memory); }
+
+void operator delete(void* memory, std::size_t) noexcept { std::free(memory); }
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
@@ -0,0 +1,405 @@
+/* Measures the cost of every feature on synthetic IMU, EMG and pose streams,
+ * first in isolation and then in trees like the one in
+ * samples/CompleteExample.cpp. In isolation, each feature has one child which
+ * receives every event and does nothing with it. Finally, a chain of filters is
+ * given the same samples one at a time and in batches.
+ */
+
+#include <array>
+#include <cmath>
+#include <memory>
+#include <myo/myo.hpp>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "../src/core/DeviceListenerWrapper.h"
+#include "../src/core/Pipeline.h"
+#include "../src/core/Pose.h"
+#include "../src/core/SampleBatch.h"
+#include "../src/features/Blocker.h"
+#include "../src/features/CorrectForOrientation.h"
+#include "../src/features/EmgFeatureExtractor.h"
+#include "../src/features/Orientation.h"
+#include "../src/features/OrientationPoses.h"
+#include "../src/features/RootFeature.h"
+#include "../src/features/filters/Debounce.h"
+#include "../src/features/filters/EmgFilter.h"
+#include "../src/features/filters/ExponentialMovingAverage.h"
+#include "../src/features/filters/Median.h"
+#include "../src/features/filters/MovingAverage.h"
+#include "../src/features/filters/OneEuroFilter.h"
+#include "../src/features/gestures/PoseGestures.h"
+
+#include "Benchmark.h"
+
+namespace {
+// Enough distinct samples that the streams don't fit in a few cache lines.
+const int kSamples = 1024;
+
+struct SyntheticData {
+  SyntheticData();
+
+  std::vector<myo::Quaternion<float>> rotations;
+  std::vector<myo::Vector3<float>> accelerations, gyros;
+  std::vector<std::array<int8_t, 8>> emg;
+  std::vector<uint64_t> imu_timestamps;
+};
+
+SyntheticData::SyntheticData() {
+  for (int i = 0; i < kSamples; ++i) {
+    // Slowly roll the forearm back and forth so the wrist is sometimes palm
+    // up and sometimes palm down.
+    float roll = 2.f * std::sin(6.2831853f * i / kSamples);
+    rotations.emplace_back(std::sin(roll / 2), 0.f, 0.f, std::cos(roll / 2));
+    accelerations.emplace_back(0.1f * std::sin(i * 0.1f), 0.f, 1.f);
+    gyros.emplace_back(0.f, 10.f * std::cos(i * 0.1f), 0.f);
+    std::array<int8_t, 8> sample;
+    for (int j = 0; j < 8; ++j) {
+      sample[j] = static_cast<int8_t>(100 * std::sin(i * 0.3f + j));
+    }
+    emg.push_back(sample);
+    imu_timestamps.push_back(20000 * i);
+  }
+}
+
+const SyntheticData& data() {
+  static const SyntheticData synthetic_data;
+  return synthetic_data;
+}
+
+// Each stream sends a fixed number of events per call. Features other than
+// RootFeature take core poses, so the pose stream is a template.
+struct ImuStream {
+  static const int kEvents = 3;
+
+  template <typename Feature>
+  void operator()(Feature& feature) {
+    const SyntheticData& d = data();
+    feature.onOrientationData(nullptr, timestamp, d.rotations[i]);
+    feature.onAccelerometerData(nullptr, timestamp, d.accelerations[i]);
+    feature.onGyroscopeData(nullptr, timestamp, d.gyros[i]);
+    i = (i + 1) % kSamples;
+    timestamp += 20000;
+  }
+
+  int i = 0;
+  uint64_t timestamp = 0;
+};
+
+struct EmgStream {
+  static const int kEvents = 1;
+
+  template <typename Feature>
+  void operator()(Feature& feature) {
+    feature.onEmgData(nullptr, timestamp, data().emg[i].data());
+    i = (i + 1) % kSamples;
+    timestamp += 5000;
+  }
+
+  int i = 0;
+  uint64_t timestamp = 0;
+};
+
+// A new pose followed by a few periodic calls.
+template <typename PoseArgument>
+struct PoseStream {
+  static const int kPeriodicPerPose = 4;
+  static const int kEvents = 1 + kPeriodicPerPose;
+
+  template <typename Feature>
+  void operator()(Feature& feature) {
+    feature.onPose(nullptr, timestamp, poses[i]);
+    for (int j = 0; j < kPeriodicPerPose; ++j) {
+      feature.onPeriodic(nullptr);
+    }
+    i = (i + 1) % poses.size();
+    timestamp += 100000;
+  }
+
+  std::vector<PoseArgument> poses;
+  int i = 0;
+  uint64_t timestamp = 0;
+};
+
+PoseStream<std::shared_ptr<core::Pose>> corePoseStream() {
+  PoseStream<std::shared_ptr<core::Pose>> stream;
+  for (core::Pose::Type type :
+       {core::Pose::rest, core::Pose::fist, core::Pose::rest,
+        core::Pose::waveIn, core::Pose::rest, core::Pose::waveOut,
+        core::Pose::rest, core::Pose::fingersSpread}) {
+    stream.poses.push_back(core::Pose::interned(type));
+  }
+  return stream;
+}
+
+PoseStream<myo::Pose> myoPoseStream() {
+  PoseStream<myo::Pose> stream;
+  for (myo::Pose::Type type :
+       {myo::Pose::rest, myo::Pose::fist, myo::Pose::rest, myo::Pose::waveIn,
+        myo::Pose::rest, myo::Pose::waveOut, myo::Pose::rest,
+        myo::Pose::fingersSpread}) {
+    stream.poses.push_back(myo::Pose(type));
+  }
+  return stream;
+}
+
+template <typename Feature, typename Stream>
+void run(const std::string& name, Feature& feature, Stream stream) {
+  benchmark::report(name, benchmark::measure(Stream::kEvents,
+                                             [&] { stream(feature); }));
+}
+
+// Constructs the feature as a child of a root feature and gives it a child
+// which receives every event.
+template <typename Feature, typename... Args>
+struct Isolated {
+  explicit Isolated(Args&&... args)
+      : feature(root_feature, std::forward<Args>(args)...) {
+    feature.addChildFeature(&sink);
+  }
+
+  features::RootFeature root_feature;
+  Feature feature;
+  core::DeviceListenerWrapper sink;
+};
+
+void benchmarkIsolatedFeatures() {
+  using namespace features;
+  using namespace features::filters;
+
+  {
+    RootFeature root_feature;
+    core::DeviceListenerWrapper sink;
+    root_feature.addChildFeature(&sink);
+    run("RootFeature imu", root_feature, ImuStream());
+    run("RootFeature emg", root_feature, EmgStream());
+    run("RootFeature poses", root_feature, myoPoseStream());
+  }
+  {
+    Isolated<Blocker, Blocker::EventFlags> blocker(Blocker::EmgData);
+    run("Blocker imu (passed)", blocker.feature, ImuStream());
+    run("Blocker emg (blocked)", blocker.feature, EmgStream());
+  }
+  {
+    Isolated<Debounce> debounce;
+    run("Debounce poses", debounce.feature, corePoseStream());
+  }
+  {
+    Isolated<MovingAverage, MovingAverage::DataFlags, int> moving_average(
+        MovingAverage::OrientationData | MovingAverage::AccelerometerData |
+            MovingAverage::GyroscopeData,
+        10);
+    run("MovingAverage(10) imu", moving_average.feature, ImuStream());
+  }
+  {
+    Isolated<BasicStaticMovingAverage<10, MovingAverage::OrientationData |
+                                              MovingAverage::AccelerometerData |
+                                              MovingAverage::GyroscopeData>>
+        static_moving_average;
+    run("StaticMovingAverage<10> imu", static_moving_average.feature,
+        ImuStream());
+  }
+  {
+    Isolated<ExponentialMovingAverage, ExponentialMovingAverage::DataFlags,
+             float> exponential_moving_average(
+        ExponentialMovingAverage::OrientationData |
+            ExponentialMovingAverage::AccelerometerData |
+            ExponentialMovingAverage::GyroscopeData,
+        0.2f);
+    run("ExponentialMovingAverage imu", exponential_moving_average.feature,
+        ImuStream());
+  }
+  {
+    Isolated<ExponentialMovingAverage, ExponentialMovingAverage::DataFlags,
+             float> exponential_moving_average(
+        ExponentialMovingAverage::OrientationData |
+            ExponentialMovingAverage::AccelerometerData |
+            ExponentialMovingAverage::GyroscopeData |
+            ExponentialMovingAverage::QuaternionOrientation,
+        0.2f);
+    run("ExponentialMovingAverage imu, quaternions",
+        exponential_moving_average.feature, ImuStream());
+  }
+  {
+    Isolated<OneEuroFilter, OneEuroFilter::DataFlags, float, float>
+        one_euro_filter(OneEuroFilter::OrientationData |
+                            OneEuroFilter::AccelerometerData |
+                            OneEuroFilter::GyroscopeData,
+                        1.f, 0.5f);
+    run("OneEuroFilter imu", one_euro_filter.feature, ImuStream());
+  }
+  for (int window_size : {11, 301}) {
+    const std::string window = std::to_string(window_size);
+    Isolated<MedianFilter, MedianFilter::DataFlags, int> median_filter(
+        MedianFilter::OrientationData | MedianFilter::AccelerometerData |
+            MedianFilter::GyroscopeData,
+        int(window_size));
+    run("MedianFilter(" + window + ") imu", median_filter.feature,
+        ImuStream());
+    Isolated<HampelFilter, HampelFilter::DataFlags, int> hampel_filter(
+        HampelFilter::OrientationData | HampelFilter::AccelerometerData |
+            HampelFilter::GyroscopeData,
+        int(window_size));
+    run("HampelFilter(" + window + ") imu", hampel_filter.feature,
+        ImuStream());
+  }
+  {
+    Isolated<EmgFilter, EmgFilter::Section> emg_filter(
+        EmgFilter::bandPass(20, 90));
+    run("EmgFilter emg", emg_filter.feature, EmgStream());
+  }
+  {
+    Isolated<EmgFeatureExtractor, std::size_t, std::size_t>
+        emg_feature_extractor(40, 10);
+    run("EmgFeatureExtractor(40, 10) emg", emg_feature_extractor.feature,
+        EmgStream());
+  }
+  {
+    Isolated<CorrectForOrientation, CorrectForOrientation::DataFlags>
+        correct_for_orientation(CorrectForOrientation::AccelerometerData |
+                                CorrectForOrientation::GyroscopeData);
+    run("CorrectForOrientation imu", correct_for_orientation.feature,
+        ImuStream());
+  }
+  {
+    Isolated<Orientation> orientation;
+    run("Orientation imu", orientation.feature, ImuStream());
+  }
+  {
+    RootFeature root_feature;
+    Orientation orientation(root_feature);
+    Isolated<OrientationPoses, Orientation&> orientation_poses(orientation);
+    // Half the poses are waves, which depend on the wrist's orientation. The
+    // time includes updating the orientation once per pose.
+    ImuStream imu;
+    PoseStream<std::shared_ptr<core::Pose>> poses = corePoseStream();
+    benchmark::report("OrientationPoses poses",
+                      benchmark::measure(poses.kEvents, [&] {
+                        imu(orientation);
+                        poses(orientation_poses.feature);
+                      }));
+  }
+  {
+    Isolated<gestures::PoseGestures> pose_gestures;
+    run("PoseGestures poses", pose_gestures.feature, corePoseStream());
+  }
+}
+
+// One simulated second of events: 200 EMG samples, 50 IMU samples, a new pose
+// and 20 periodic calls, as if from the loop in CompleteExample.
+template <typename Root>
+benchmark::Result benchmarkSecond(Root& root_feature) {
+  ImuStream imu;
+  EmgStream emg;
+  PoseStream<myo::Pose> poses = myoPoseStream();
+  const int events = 200 * EmgStream::kEvents + 50 * ImuStream::kEvents + 1 +
+                     20;
+  return benchmark::measure(events, [&] {
+    root_feature.onPose(nullptr, poses.timestamp, poses.poses[poses.i]);
+    poses.i = (poses.i + 1) % poses.poses.size();
+    for (int i = 0; i < 50; ++i) {
+      imu(root_feature);
+      for (int j = 0; j < 4; ++j) {
+        emg(root_feature);
+      }
+      if (i % 5 == 1 || i % 5 == 4) {
+        root_feature.onPeriodic(nullptr);
+      }
+    }
+  });
+}
+
+void benchmarkTrees() {
+  using namespace features;
+  using namespace features::filters;
+
+  {
+    // The tree from CompleteExample.
+    RootFeature root_feature;
+    Debounce debounce(root_feature);
+    MovingAverage moving_average(root_feature, MovingAverage::OrientationData,
+                                 10);
+    ExponentialMovingAverage exponential_moving_average(
+        moving_average, ExponentialMovingAverage::AccelerometerData |
+                            ExponentialMovingAverage::GyroscopeData,
+        0.2);
+    Orientation orientation(exponential_moving_average);
+    OrientationPoses orientation_poses(debounce, orientation);
+    gestures::PoseGestures pose_gestures(orientation_poses);
+    core::DeviceListenerWrapper sink;
+    pose_gestures.addChildFeature(&sink);
+    benchmark::report("CompleteExample tree", benchmarkSecond(root_feature));
+  }
+  {
+    // The same tree with the pose branch as a pipeline attached to the root.
+    RootFeature root_feature;
+    MovingAverage moving_average(root_feature, MovingAverage::OrientationData,
+                                 10);
+    ExponentialMovingAverage exponential_moving_average(
+        moving_average, ExponentialMovingAverage::AccelerometerData |
+                            ExponentialMovingAverage::GyroscopeData,
+        0.2);
+    Orientation orientation(exponential_moving_average);
+    core::Pipeline<BasicDebounce, BasicOrientationPoses,
+                   gestures::BasicPoseGestures>
+        pipeline(root_feature, std::make_tuple(10),
+                 std::forward_as_tuple(orientation), std::make_tuple());
+    core::DeviceListenerWrapper sink;
+    pipeline.leaf().addChildFeature(&sink);
+    benchmark::report("CompleteExample tree, pose pipeline",
+                      benchmarkSecond(root_feature));
+  }
+  {
+    // Every event reaches a child which wants everything.
+    RootFeature root_feature;
+    core::DeviceListenerWrapper sink;
+    root_feature.addChildFeature(&sink);
+    benchmark::report("RootFeature only", benchmarkSecond(root_feature));
+  }
+}
+
+// Accelerometer samples through a chain of filters, each of which handles a
+// batch in one call.
+void benchmarkBatches() {
+  using namespace features;
+  using namespace features::filters;
+  const int kBatchSize = 32;
+
+  RootFeature root_feature;
+  MovingAverage moving_average(root_feature, MovingAverage::AccelerometerData,
+                               10);
+  ExponentialMovingAverage exponential_moving_average(
+      moving_average, ExponentialMovingAverage::AccelerometerData, 0.2f);
+  CorrectForOrientation correct_for_orientation(
+      exponential_moving_average, CorrectForOrientation::AccelerometerData);
+  core::DeviceListenerWrapper sink;
+  correct_for_orientation.addChildFeature(&sink);
+
+  const SyntheticData& d = data();
+  int i = 0;
+  benchmark::report("Filter chain accel, one sample per call",
+                    benchmark::measure(kBatchSize, [&] {
+                      for (int j = 0; j < kBatchSize; ++j) {
+                        root_feature.onAccelerometerData(
+                            nullptr, d.imu_timestamps[i], d.accelerations[i]);
+                        i = (i + 1) % kSamples;
+                      }
+                    }));
+  benchmark::report("Filter chain accel, 32 samples per call",
+                    benchmark::measure(kBatchSize, [&] {
+                      root_feature.onAccelerometerDataBatch(
+                          nullptr, core::VectorBatch(&d.imu_timestamps[i],
+                                                     &d.accelerations[i],
+                                                     kBatchSize));
+                      i = (i + kBatchSize) % kSamples;
+                    }));
+}
+}
+
+int main() {
+  benchmarkIsolatedFeatures();
+  benchmarkTrees();
+  benchmarkBatches();
+  return 0;
+}
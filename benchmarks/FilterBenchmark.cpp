@@ -0,0 +1,203 @@
+/* Compares the scalar and SIMD paths of the IIR, biquad, FIR and EMG filters.
+ *
+ * VirtualExponentialMovingAverage is the exponential moving average as it used
+ * to be written, with one virtual Update call per component. It is kept only
+ * as a reference point for this benchmark. The banks filter many groups of
+ * four lanes at once, once with scalar lanes and once with SIMD lanes, and so
+ * do the biquad cascades, the convolutions and the EMG filter.
+ */
+
+#include <cmath>
+#include <myo/myo.hpp>
+#include <string>
+#include <vector>
+
+#include "../src/core/DeviceListenerWrapper.h"
+#include "../src/core/Float4.h"
+#include "../src/core/SampleBatch.h"
+#include "../src/features/RootFeature.h"
+#include "../src/core/Int16x8.h"
+#include "../src/features/filters/Biquad.h"
+#include "../src/features/filters/Convolution.h"
+#include "../src/features/filters/EmgFilter.h"
+#include "../src/features/filters/ExponentialMovingAverage.h"
+#include "../src/features/filters/InfiniteImpulseResponse.h"
+#include "../src/features/filters/StaticInfiniteImpulseResponse.h"
+
+#include "Benchmark.h"
+
+namespace {
+const int kSamples = 1024;
+
+class VirtualExponentialMovingAverage
+    : public features::filters::InfiniteImpulseResponse {
+ public:
+  VirtualExponentialMovingAverage(core::DeviceListenerWrapper& parent_feature,
+                                  DataFlags flags, float alpha)
+      : features::filters::InfiniteImpulseResponse(parent_feature, flags),
+        alpha_(alpha) {}
+
+ private:
+  virtual float Update(float new_value, float old_value) override {
+    return (alpha_ * new_value) + ((1 - alpha_) * old_value);
+  }
+
+  const float alpha_;
+};
+
+// With a batch size of 0 every sample is sent on its own.
+template <typename Filter>
+benchmark::Result benchmarkImu(int batch_size = 0) {
+  std::vector<myo::Quaternion<float>> rotations;
+  std::vector<myo::Vector3<float>> vectors;
+  std::vector<uint64_t> timestamps;
+  for (int i = 0; i < kSamples; ++i) {
+    float angle = 0.01f * i;
+    timestamps.push_back(20000 * i);
+    rotations.emplace_back(std::sin(angle), 0.f, 0.f, std::cos(angle));
+    vectors.emplace_back(std::sin(angle), std::cos(angle), 1.f);
+  }
+
+  features::RootFeature root_feature;
+  Filter filter(root_feature,
+                Filter::OrientationData | Filter::AccelerometerData |
+                    Filter::GyroscopeData,
+                0.2f);
+  core::DeviceListenerWrapper sink;
+  filter.addChildFeature(&sink);
+  int i = 0;
+  if (batch_size > 0) {
+    return benchmark::measure(3 * batch_size, [&] {
+      root_feature.onOrientationDataBatch(
+          nullptr,
+          core::OrientationBatch(&timestamps[i], &rotations[i], batch_size));
+      root_feature.onAccelerometerDataBatch(
+          nullptr, core::VectorBatch(&timestamps[i], &vectors[i], batch_size));
+      root_feature.onGyroscopeDataBatch(
+          nullptr, core::VectorBatch(&timestamps[i], &vectors[i], batch_size));
+      i = (i + batch_size) % kSamples;
+    });
+  }
+  return benchmark::measure(3, [&] {
+    root_feature.onOrientationData(nullptr, timestamps[i], rotations[i]);
+    root_feature.onAccelerometerData(nullptr, timestamps[i], vectors[i]);
+    root_feature.onGyroscopeData(nullptr, timestamps[i], vectors[i]);
+    i = (i + 1) % kSamples;
+  });
+}
+
+// Each event is one sample for every group, e.g. the IMU data of many Myos.
+template <typename Lanes>
+benchmark::Result benchmarkBank(std::size_t num_groups) {
+  using features::filters::ExponentialMovingAverageKernel;
+  std::vector<float> input(4 * num_groups * kSamples);
+  for (std::size_t i = 0; i < input.size(); ++i) {
+    input[i] = std::sin(0.01f * i);
+  }
+  std::vector<float> output(4 * num_groups);
+
+  features::filters::InfiniteImpulseResponseBank<
+      ExponentialMovingAverageKernel, Lanes>
+      bank(ExponentialMovingAverageKernel(0.2f), num_groups);
+  int i = 0;
+  return benchmark::measure(1, [&] {
+    bank.update(&input[4 * num_groups * i], output.data());
+    i = (i + 1) % kSamples;
+  });
+}
+
+// Each event is one sample of a quaternion stream.
+template <typename Lanes>
+benchmark::Result benchmarkConvolution(std::size_t num_taps) {
+  std::vector<Lanes> input;
+  for (int i = 0; i < kSamples; ++i) {
+    float angle = 0.01f * i;
+    input.emplace_back(std::sin(angle), 0.f, 0.f, std::cos(angle));
+  }
+  features::filters::ConvolutionChannel<Lanes> channel(
+      features::filters::taps::lowPass(5, 50, num_taps));
+  float output[4] = {};
+  int i = 0;
+  return benchmark::measure(1, [&] {
+    // Accumulated so that the filter is not optimized away.
+    (channel.update(input[i]) + Lanes::load(output)).store(output);
+    i = (i + 1) % kSamples;
+  });
+}
+
+// Each event is one sample of a quaternion stream through a fourth order
+// low-pass.
+template <typename Lanes>
+benchmark::Result benchmarkBiquad() {
+  std::vector<Lanes> input;
+  for (int i = 0; i < kSamples; ++i) {
+    float angle = 0.01f * i;
+    input.emplace_back(std::sin(angle), 0.f, 0.f, std::cos(angle));
+  }
+  features::filters::BiquadCascadeChannel<2, Lanes> channel(
+      features::filters::butterworth::lowPass<4>(5, 50));
+  float output[4] = {};
+  int i = 0;
+  return benchmark::measure(1, [&] {
+    // Accumulated so that the filter is not optimized away.
+    (channel.update(input[i]) + Lanes::load(output)).store(output);
+    i = (i + 1) % kSamples;
+  });
+}
+
+// Each event is one EMG sample, band-passed and enveloped.
+template <typename Lanes>
+benchmark::Result benchmarkEmgFilter() {
+  using features::filters::EmgFilter;
+  std::vector<core::EmgSample> input(kSamples);
+  for (int i = 0; i < kSamples; ++i) {
+    for (int channel = 0; channel < 8; ++channel) {
+      input[i][channel] = int8_t(100 * std::sin(0.7f * i + channel));
+    }
+  }
+  features::filters::EmgFilterChannel<Lanes> channel(
+      EmgFilter::bandPass(20, 90), 5, 4);
+  int8_t filtered[8];
+  int16_t envelope[8];
+  int i = 0;
+  return benchmark::measure(1, [&] {
+    channel.update(input[i].data(), filtered, envelope);
+    i = (i + 1) % kSamples;
+  });
+}
+}
+
+int main() {
+  using features::filters::ExponentialMovingAverage;
+  benchmark::report("VirtualExponentialMovingAverage imu",
+                    benchmarkImu<VirtualExponentialMovingAverage>());
+  benchmark::report("ExponentialMovingAverage imu",
+                    benchmarkImu<ExponentialMovingAverage>());
+  benchmark::report("VirtualExponentialMovingAverage imu batched",
+                    benchmarkImu<VirtualExponentialMovingAverage>(32));
+  benchmark::report("ExponentialMovingAverage imu batched",
+                    benchmarkImu<ExponentialMovingAverage>(32));
+  for (std::size_t num_groups : {1, 16, 256}) {
+    std::string groups = std::to_string(num_groups);
+    benchmark::report("Bank of " + groups + " groups, scalar",
+                      benchmarkBank<core::ScalarFloat4>(num_groups));
+    benchmark::report("Bank of " + groups + " groups, Float4",
+                      benchmarkBank<core::Float4>(num_groups));
+  }
+  for (std::size_t num_taps : {5, 31}) {
+    std::string taps = std::to_string(num_taps);
+    benchmark::report("Convolution of " + taps + " taps, scalar",
+                      benchmarkConvolution<core::ScalarFloat4>(num_taps));
+    benchmark::report("Convolution of " + taps + " taps, Float4",
+                      benchmarkConvolution<core::Float4>(num_taps));
+  }
+  benchmark::report("Butterworth low-pass of order 4, scalar",
+                    benchmarkBiquad<core::ScalarFloat4>());
+  benchmark::report("Butterworth low-pass of order 4, Float4",
+                    benchmarkBiquad<core::Float4>());
+  benchmark::report("EmgFilter, scalar",
+                    benchmarkEmgFilter<core::ScalarInt16x8>());
+  benchmark::report("EmgFilter, Int16x8",
+                    benchmarkEmgFilter<core::Int16x8>());
+  return 0;
+}
@@ -0,0 +1,125 @@
+/* Compares the per-event cost of PoseGestures with the string keyed timer map
+ * it used to keep. StringKeyedPoseGestures is a copy of that implementation,
+ * kept only as a reference point for this benchmark.
+ */
+
+#include <memory>
+#include <myo/myo.hpp>
+#include <string>
+#include <unordered_map>
+
+#include "../src/core/DeviceListenerWrapper.h"
+#include "../src/core/Pose.h"
+#include "../src/features/RootFeature.h"
+#include "../src/features/gestures/PoseGestures.h"
+#include "../lib/Basic-Timer/BasicTimer.h"
+
+#include "Benchmark.h"
+
+namespace {
+class StringKeyedPoseGestures : public core::DeviceListenerWrapper {
+ public:
+  typedef features::gestures::PoseGesturesTypes::Gesture Gesture;
+
+  StringKeyedPoseGestures(core::DeviceListenerWrapper& parent_feature,
+                          int click_max_hold_min = 1000,
+                          int double_click_timeout = 750)
+      : click_max_hold_min_(click_max_hold_min),
+        double_click_timeout_(double_click_timeout),
+        last_gesture_(new Gesture()) {
+    parent_feature.addChildFeature(this);
+  }
+
+  virtual void onPose(myo::Myo* myo, uint64_t timestamp,
+                      const std::shared_ptr<core::Pose>& pose) override {
+    BasicTimer now;
+    now.tick();
+
+    if (gesture_timers_.count(last_gesture_->toDescriptiveString()) > 0 &&
+        gesture_timers_[last_gesture_->toDescriptiveString()]
+                .millisecondsSinceTick() <= click_max_hold_min_) {
+      std::shared_ptr<core::Gesture> current_gesture;
+      if (gesture_timers_.count(
+              Gesture(last_gesture_->AssociatedPose(), Gesture::singleClick)
+                  .toDescriptiveString()) > 0 &&
+          millisecondsBetweenTicks(
+              gesture_timers_[Gesture(last_gesture_->AssociatedPose(),
+                                      Gesture::singleClick)
+                                  .toDescriptiveString()],
+              gesture_timers_[last_gesture_->toDescriptiveString()]) <=
+              double_click_timeout_) {
+        current_gesture.reset(
+            new Gesture(last_gesture_->AssociatedPose(), Gesture::doubleClick));
+      } else {
+        current_gesture.reset(
+            new Gesture(last_gesture_->AssociatedPose(), Gesture::singleClick));
+      }
+      gesture_timers_[current_gesture->toDescriptiveString()] = now;
+      core::DeviceListenerWrapper::onGesture(myo, timestamp, current_gesture);
+    }
+
+    last_gesture_.reset(new Gesture(pose, Gesture::none));
+    gesture_timers_[last_gesture_->toDescriptiveString()] = now;
+    core::DeviceListenerWrapper::onPose(myo, timestamp, pose);
+  }
+
+  virtual void onPeriodic(myo::Myo* myo) override {
+    if (*last_gesture_ != Gesture(Gesture::hold) &&
+        gesture_timers_.count(Gesture(last_gesture_->AssociatedPose(),
+                                      Gesture::none).toDescriptiveString()) >
+            0 &&
+        gesture_timers_[Gesture(last_gesture_->AssociatedPose(),
+                                Gesture::none).toDescriptiveString()]
+                .millisecondsSinceTick() > click_max_hold_min_) {
+      last_gesture_.reset(
+          new Gesture(last_gesture_->AssociatedPose(), Gesture::hold));
+      core::DeviceListenerWrapper::onGesture(myo, 0, last_gesture_);
+    }
+    core::DeviceListenerWrapper::onPeriodic(myo);
+  }
+
+ private:
+  const int click_max_hold_min_, double_click_timeout_;
+  std::unordered_map<std::string, BasicTimer> gesture_timers_;
+  std::shared_ptr<Gesture> last_gesture_;
+};
+
+// Alternates between two poses, with a few periodic ticks in between. Every
+// pose but the first completes a click or double click.
+template <typename PoseGesturesType>
+benchmark::Result benchmarkPoseGestures(core::Pose::Type first,
+                                        core::Pose::Type second) {
+  features::RootFeature root_feature;
+  PoseGesturesType pose_gestures(root_feature);
+  const std::shared_ptr<core::Pose>& first_pose = core::Pose::interned(first);
+  const std::shared_ptr<core::Pose>& second_pose = core::Pose::interned(second);
+  const int periodic_per_pose = 4;
+  uint64_t timestamp = 0;
+  return benchmark::measure(2 * (1 + periodic_per_pose), [&] {
+    pose_gestures.onPose(nullptr, timestamp++, first_pose);
+    for (int i = 0; i < periodic_per_pose; ++i) {
+      pose_gestures.onPeriodic(nullptr);
+    }
+    pose_gestures.onPose(nullptr, timestamp++, second_pose);
+    for (int i = 0; i < periodic_per_pose; ++i) {
+      pose_gestures.onPeriodic(nullptr);
+    }
+  });
+}
+}
+
+int main() {
+  benchmark::report("StringKeyedPoseGestures fist/rest",
+                    benchmarkPoseGestures<StringKeyedPoseGestures>(
+                        core::Pose::fist, core::Pose::rest));
+  benchmark::report("PoseGestures fist/rest",
+                    benchmarkPoseGestures<features::gestures::PoseGestures>(
+                        core::Pose::fist, core::Pose::rest));
+  benchmark::report("StringKeyedPoseGestures fingersSpread/rest",
+                    benchmarkPoseGestures<StringKeyedPoseGestures>(
+                        core::Pose::fingersSpread, core::Pose::rest));
+  benchmark::report("PoseGestures fingersSpread/rest",
+                    benchmarkPoseGestures<features::gestures::PoseGestures>(
+                        core::Pose::fingersSpread, core::Pose::rest));
+  return 0;
+}
@@ -0,0 +1,75 @@
+/* Replays a synthetic ten minute session, with the event rates of a real Myo,
+ * through a typical feature tree and reports how much faster than real time it
+ * ran.
+ */
+
+#include <cmath>
+#include <cstdio>
+#include <myo/myo.hpp>
+#include <vector>
+
+#include "../src/features/RootFeature.h"
+#include "../src/features/Orientation.h"
+#include "../src/features/OrientationPoses.h"
+#include "../src/features/filters/Debounce.h"
+#include "../src/features/filters/ExponentialMovingAverage.h"
+#include "../src/features/gestures/PoseGestures.h"
+#include "../src/replay/Record.h"
+#include "../src/replay/Replayer.h"
+
+namespace {
+// EMG arrives at 200Hz, IMU data at 50Hz and a new pose every two seconds.
+std::vector<replay::Record> syntheticSession(int seconds) {
+  const myo::Pose::Type poses[] = {myo::Pose::rest, myo::Pose::fist,
+                                   myo::Pose::rest, myo::Pose::waveIn,
+                                   myo::Pose::rest, myo::Pose::fingersSpread};
+  std::vector<replay::Record> records;
+  for (uint64_t t = 0; t < seconds * 1000000ull; t += 5000) {
+    int8_t emg[8];
+    for (int i = 0; i < 8; ++i) {
+      emg[i] = static_cast<int8_t>(100 * std::sin(t * 1e-5 + i));
+    }
+    records.push_back(replay::Record::emgData(0, t, emg));
+    if (t % 20000 == 0) {
+      float angle = t * 1e-6f;
+      records.push_back(replay::Record::orientationData(
+          0, t, myo::Quaternion<float>(0, 0, std::sin(angle / 2),
+                                       std::cos(angle / 2))));
+      records.push_back(replay::Record::accelerometerData(
+          0, t, myo::Vector3<float>(0, 0, 1)));
+      records.push_back(replay::Record::gyroscopeData(
+          0, t, myo::Vector3<float>(0, 0, 0)));
+    }
+    if (t % 2000000 == 0) {
+      records.push_back(
+          replay::Record::pose(0, t, poses[(t / 2000000) % 6]));
+    }
+  }
+  return records;
+}
+}
+
+int main() {
+  std::vector<replay::Record> records = syntheticSession(600);
+
+  features::RootFeature root_feature;
+  core::Clock& clock = root_feature.deviceClock();
+  typedef features::filters::ExponentialMovingAverage ExponentialMovingAverage;
+  ExponentialMovingAverage moving_average(
+      root_feature, ExponentialMovingAverage::OrientationData, 0.2);
+  features::Orientation orientation(moving_average);
+  features::filters::Debounce debounce(root_feature, 10, clock);
+  features::OrientationPoses orientation_poses(debounce, orientation);
+  features::gestures::PoseGestures pose_gestures(orientation_poses, 1000, 750,
+                                                 clock);
+
+  replay::Replayer<> replayer(root_feature);
+  replay::ReplayStats stats = replayer.play(records);
+  std::printf("%llu events, %llu periodic calls in %.3f s\n",
+              static_cast<unsigned long long>(stats.events),
+              static_cast<unsigned long long>(stats.periodic_calls),
+              stats.seconds);
+  std::printf("%.0f events/sec, %.0fx real time\n", stats.eventsPerSecond(),
+              stats.realTimeFactor());
+  return 0;
+}
@@ -4,6 +4,7 @@
 #include "../src/core/DeviceListenerWrapper.h"
 #include "../src/core/Pose.h"
 
+#include "../src/features/QueuedRootFeature.h"
 #include "../src/features/RootFeature.h"
 #include "../src/features/filters/Debounce.h"
 #include "../src/features/Orientation.h"
@@ -20,6 +21,12 @@ class ExampleFeature : public core::DeviceListenerWrapper {
     parent_feature.addChildFeature(this);
   }
 
+  // Only poses and gestures are passed down the tree to this feature.
+  virtual core::EventMask handledEvents() const override {
+    return core::EventBit(core::Event::Pose) |
+           core::EventBit(core::Event::Gesture);
+  }
+
   virtual void onPose(myo::Myo* myo, uint64_t timestamp,
                       const std::shared_ptr<core::Pose>& pose) override {
     if (*pose == core::Pose::doubleTap) {
@@ -60,13 +67,16 @@ int main() {
     features::gestures::PoseGestures pose_gestures(orientation_poses);
     ExampleFeature example_feature(pose_gestures, orientation);
 
-    hub.addListener(&root_feature);
+    // The feature tree runs on its own thread so that it never delays the
+    // hub.
+    features::QueuedRootFeature<> queued_root_feature(root_feature);
+    hub.addListener(&queued_root_feature);
 
     // Event loop.
     while (true) {
       myo->unlock(myo::Myo::unlockTimed);
       hub.run(1000 / 20);
-      root_feature.onPeriodic(myo);
+      queued_root_feature.onPeriodic(myo);
     }
   } catch (const std::exception& ex) {
     std::cerr << "Error: " << ex.what() << std::endl;
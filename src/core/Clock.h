@@ -0,0 +1,116 @@
+/* Clocks measure time for features which act on how long something lasted,
+ * such as Debounce and PoseGestures. Times are in microseconds, the same unit
+ * as the Myo's timestamps.
+ *
+ * WallClock is the default and measures real time. DeviceClock follows the
+ * timestamps of the events passed through the feature tree, which makes
+ * features behave identically no matter how fast a recording is played back.
+ * Every RootFeature keeps a DeviceClock up to date:
+ *
+ *   features::RootFeature root_feature;
+ *   features::filters::Debounce debounce(root_feature, 10,
+ *                                        root_feature.deviceClock());
+ *
+ * A DeviceClock can also map timestamps to the time on a host clock at which
+ * the events arrived, to measure latency from the Myo to a feature. The clocks
+ * of the Myo and the host are not synchronized, so the offset between them is
+ * estimated as the smallest difference seen between an event's arrival time
+ * and its timestamp. Latencies are therefore relative to the fastest event.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+namespace core {
+class Clock {
+ public:
+  virtual ~Clock() {}
+
+  // Microseconds since an arbitrary, fixed point in time.
+  virtual uint64_t now() const = 0;
+};
+
+class WallClock : public Clock {
+ public:
+  virtual uint64_t now() const override;
+
+  // WallClock has no state, so every feature may share this instance.
+  static WallClock& instance();
+};
+
+class DeviceClock : public Clock {
+ public:
+  DeviceClock();
+
+  // Returns the latest timestamp passed to advance.
+  virtual uint64_t now() const override;
+
+  // Moves the clock forward to timestamp. Timestamps earlier than the current
+  // time are ignored so the clock never runs backwards.
+  void advance(uint64_t timestamp);
+
+  // Starts estimating the offset to host_clock from the timestamps passed to
+  // advance. host_clock must outlive this clock.
+  void trackHostTime(const Clock& host_clock);
+  // The time on the host clock at which an event with the given timestamp
+  // arrived, or would have arrived on the fastest path. Only meaningful after
+  // trackHostTime and at least one call to advance.
+  uint64_t hostTime(uint64_t timestamp) const;
+
+ private:
+  uint64_t now_;
+  const Clock* host_clock_;
+  int64_t host_offset_;
+  bool has_host_offset_;
+};
+
+// Whole milliseconds between two times returned by a Clock.
+int64_t millisecondsBetween(uint64_t from, uint64_t to);
+
+uint64_t WallClock::now() const {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+WallClock& WallClock::instance() {
+  static WallClock wall_clock;
+  return wall_clock;
+}
+
+DeviceClock::DeviceClock()
+    : now_(0),
+      host_clock_(nullptr),
+      host_offset_(0),
+      has_host_offset_(false) {}
+
+uint64_t DeviceClock::now() const { return now_; }
+
+void DeviceClock::advance(uint64_t timestamp) {
+  if (timestamp > now_) {
+    now_ = timestamp;
+  }
+  if (host_clock_) {
+    int64_t offset = static_cast<int64_t>(host_clock_->now()) -
+                     static_cast<int64_t>(timestamp);
+    if (!has_host_offset_ || offset < host_offset_) {
+      host_offset_ = offset;
+      has_host_offset_ = true;
+    }
+  }
+}
+
+void DeviceClock::trackHostTime(const Clock& host_clock) {
+  host_clock_ = &host_clock;
+  has_host_offset_ = false;
+}
+
+uint64_t DeviceClock::hostTime(uint64_t timestamp) const {
+  return static_cast<int64_t>(timestamp) + host_offset_;
+}
+
+int64_t millisecondsBetween(uint64_t from, uint64_t to) {
+  return (static_cast<int64_t>(to) - static_cast<int64_t>(from)) / 1000;
+}
+}
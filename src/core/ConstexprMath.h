@@ -0,0 +1,66 @@
+/* Versions of the <cmath> functions which can be evaluated at compile time, so
+ * that e.g. filter coefficients can be designed in constexpr functions. They
+ * are accurate to about the precision of a double, but slower than <cmath> at
+ * run time.
+ */
+
+#pragma once
+
+namespace core {
+constexpr double kPi = 3.14159265358979323846;
+
+constexpr double constexprSin(double x);
+constexpr double constexprCos(double x);
+constexpr double constexprSqrt(double x);
+
+// Each of these is a single return statement, as C++11 requires of a
+// constexpr function, so loops are written as recursion.
+namespace detail {
+constexpr double sinSeries(double x, double term, double sum, int n);
+constexpr double sinSeriesAdd(double x, double term, double sum, int n) {
+  return sinSeries(x, term, sum + term, n + 1);
+}
+// Adds the terms of the Taylor series of sin(x) after term, the one before
+// the nth, to sum.
+constexpr double sinSeries(double x, double term, double sum, int n) {
+  return n == 30
+             ? sum
+             : sinSeriesAdd(x, term * (-x * x / ((2 * n) * (2 * n + 1))), sum,
+                            n);
+}
+
+// x must be in [-pi, pi].
+constexpr double sinOfReduced(double x) { return sinSeries(x, x, x, 1); }
+
+// Moves x, already within a turn of 0, to [-pi, pi].
+constexpr double wrapToPi(double x) {
+  return x > kPi ? x - 2 * kPi : (x < -kPi ? x + 2 * kPi : x);
+}
+
+constexpr double sqrtNewton(double x, double root, int step);
+constexpr double sqrtNewtonStep(double x, double root, double next,
+                                int step) {
+  return next == root ? root : sqrtNewton(x, next, step + 1);
+}
+// Newton's method from root, until it stops moving or for 100 steps.
+constexpr double sqrtNewton(double x, double root, int step) {
+  return step == 100 ? root
+                     : sqrtNewtonStep(x, root, (root + x / root) / 2, step);
+}
+}
+
+// By its Taylor series, after reducing x to [-pi, pi].
+constexpr double constexprSin(double x) {
+  return detail::sinOfReduced(
+      detail::wrapToPi(x - static_cast<long>(x / (2 * kPi)) * (2 * kPi)));
+}
+
+constexpr double constexprCos(double x) {
+  return constexprSin(x + kPi / 2);
+}
+
+// By Newton's method. x must not be negative.
+constexpr double constexprSqrt(double x) {
+  return x == 0 ? 0 : detail::sqrtNewton(x, x < 1 ? 1 : x, 0);
+}
+}
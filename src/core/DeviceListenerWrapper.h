@@ -1,15 +1,39 @@
 /* DeviceListenerWrapper wraps the myo::DeviceListener class in order to add the
  * virtual function onPeriodic(myo::Myo*) in order to allow the derived classes
  * to call Base::onPeriodic.
+ *
+ * Each event is only passed on to the child features whose subtree subscribes
+ * to it. See handledEvents() and forwardedEvents().
+ *
+ * Orientation, accelerometer, gyroscope and EMG samples may also arrive in
+ * batches, see SampleBatch.h. A feature which does not override the on*Batch
+ * methods receives each sample of a batch through the usual per-sample method.
+ *
+ * onEmgEnvelope and onEmgFeatures are not sent by the Myo but by features which
+ * process the EMG data, see features/filters/EmgFilter.h and
+ * features/EmgFeatureExtractor.h.
+ *
+ * If MYO_INTELLIGESTURE_PROFILE is defined, every call to a child feature is
+ * timed. See Profile.h.
  */
 
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <ostream>
 #include <set>
+#include <string>
+#include <typeinfo>
+#include <vector>
 #include <myo/myo.hpp>
 
+#include "EmgFeatures.h"
+#include "Event.h"
 #include "Pose.h"
 #include "Gesture.h"
+#include "Profile.h"
+#include "SampleBatch.h"
 
 namespace core {
 class DeviceListenerWrapper {
@@ -18,101 +42,317 @@ class DeviceListenerWrapper {
   std::set<child_feature_t> child_features_;
 
  public:
+  DeviceListenerWrapper()
+      : subscribed_events_(NoEvents), subscriptions_valid_(false) {}
+  DeviceListenerWrapper(const DeviceListenerWrapper&) = delete;
+  DeviceListenerWrapper& operator=(const DeviceListenerWrapper&) = delete;
+  virtual ~DeviceListenerWrapper() {
+    for (auto parent : std::vector<DeviceListenerWrapper*>(parent_features_)) {
+      parent->removeChildFeature(this);
+    }
+    for (auto feature : child_features_) {
+      feature->removeParentFeature(this);
+    }
+  }
+
   void addChildFeature(child_feature_t feature) {
-    child_features_.insert(feature);
+    if (child_features_.insert(feature).second) {
+      feature->parent_features_.push_back(this);
+      invalidateSubscriptions();
+    }
   }
   void removeChildFeature(child_feature_t feature) {
-    child_features_.erase(feature);
+    if (child_features_.erase(feature) > 0) {
+      feature->removeParentFeature(this);
+      invalidateSubscriptions();
+    }
+  }
+
+  // The events this feature needs for itself, regardless of its children.
+  // Features which do not override this are given every event.
+  virtual EventMask handledEvents() const { return AllEvents; }
+  // The events this feature passes on to its child features.
+  virtual EventMask forwardedEvents() const { return AllEvents; }
+  // The events needed by this feature and its subtree.
+  virtual EventMask subscribedEvents() {
+    updateSubscriptions();
+    return subscribed_events_;
   }
 
   virtual void onPair(myo::Myo* myo, uint64_t timestamp,
                       myo::FirmwareVersion firmware_version) {
-    for (auto feature : child_features_) {
+    for (auto feature : childFeaturesFor(Event::Pair)) {
+      MYO_INTELLIGESTURE_PROFILE_SCOPE(feature, Event::Pair);
       feature->onPair(myo, timestamp, firmware_version);
     }
   }
   virtual void onUnpair(myo::Myo* myo, uint64_t timestamp) {
-    for (auto feature : child_features_) {
+    for (auto feature : childFeaturesFor(Event::Unpair)) {
+      MYO_INTELLIGESTURE_PROFILE_SCOPE(feature, Event::Unpair);
       feature->onUnpair(myo, timestamp);
     }
   }
   virtual void onConnect(myo::Myo* myo, uint64_t timestamp,
                          myo::FirmwareVersion firmware_version) {
-    for (auto feature : child_features_) {
+    for (auto feature : childFeaturesFor(Event::Connect)) {
+      MYO_INTELLIGESTURE_PROFILE_SCOPE(feature, Event::Connect);
       feature->onConnect(myo, timestamp, firmware_version);
     }
   }
   virtual void onDisconnect(myo::Myo* myo, uint64_t timestamp) {
-    for (auto feature : child_features_) {
+    for (auto feature : childFeaturesFor(Event::Disconnect)) {
+      MYO_INTELLIGESTURE_PROFILE_SCOPE(feature, Event::Disconnect);
       feature->onDisconnect(myo, timestamp);
     }
   }
   virtual void onArmSync(myo::Myo* myo, uint64_t timestamp, myo::Arm arm,
                          myo::XDirection x_direction) {
-    for (auto feature : child_features_) {
+    for (auto feature : childFeaturesFor(Event::ArmSync)) {
+      MYO_INTELLIGESTURE_PROFILE_SCOPE(feature, Event::ArmSync);
       feature->onArmSync(myo, timestamp, arm, x_direction);
     }
   }
   virtual void onArmUnsync(myo::Myo* myo, uint64_t timestamp) {
-    for (auto feature : child_features_) {
+    for (auto feature : childFeaturesFor(Event::ArmUnsync)) {
+      MYO_INTELLIGESTURE_PROFILE_SCOPE(feature, Event::ArmUnsync);
       feature->onArmUnsync(myo, timestamp);
     }
   }
   virtual void onUnlock(myo::Myo* myo, uint64_t timestamp) {
-    for (auto feature : child_features_) {
+    for (auto feature : childFeaturesFor(Event::Unlock)) {
+      MYO_INTELLIGESTURE_PROFILE_SCOPE(feature, Event::Unlock);
       feature->onUnlock(myo, timestamp);
     }
   }
   virtual void onLock(myo::Myo* myo, uint64_t timestamp) {
-    for (auto feature : child_features_) {
+    for (auto feature : childFeaturesFor(Event::Lock)) {
+      MYO_INTELLIGESTURE_PROFILE_SCOPE(feature, Event::Lock);
       feature->onLock(myo, timestamp);
     }
   }
   virtual void onPose(myo::Myo* myo, uint64_t timestamp,
                       const std::shared_ptr<core::Pose>& pose) {
-    for (auto feature : child_features_) {
+    for (auto feature : childFeaturesFor(Event::Pose)) {
+      MYO_INTELLIGESTURE_PROFILE_SCOPE(feature, Event::Pose);
       feature->onPose(myo, timestamp, pose);
     }
   }
   virtual void onGesture(myo::Myo* myo, uint64_t timestamp,
                          const std::shared_ptr<core::Gesture>& gesture) {
-    for (auto feature : child_features_) {
+    for (auto feature : childFeaturesFor(Event::Gesture)) {
+      MYO_INTELLIGESTURE_PROFILE_SCOPE(feature, Event::Gesture);
       feature->onGesture(myo, timestamp, gesture);
     }
   }
   virtual void onOrientationData(myo::Myo* myo, uint64_t timestamp,
                                  const myo::Quaternion<float>& rotation) {
-    for (auto feature : child_features_) {
+    for (auto feature : childFeaturesFor(Event::OrientationData)) {
+      MYO_INTELLIGESTURE_PROFILE_SCOPE(feature, Event::OrientationData);
       feature->onOrientationData(myo, timestamp, rotation);
     }
   }
   virtual void onAccelerometerData(myo::Myo* myo, uint64_t timestamp,
                                    const myo::Vector3<float>& acceleration) {
-    for (auto feature : child_features_) {
+    for (auto feature : childFeaturesFor(Event::AccelerometerData)) {
+      MYO_INTELLIGESTURE_PROFILE_SCOPE(feature, Event::AccelerometerData);
       feature->onAccelerometerData(myo, timestamp, acceleration);
     }
   }
   virtual void onGyroscopeData(myo::Myo* myo, uint64_t timestamp,
                                const myo::Vector3<float>& gyro) {
-    for (auto feature : child_features_) {
+    for (auto feature : childFeaturesFor(Event::GyroscopeData)) {
+      MYO_INTELLIGESTURE_PROFILE_SCOPE(feature, Event::GyroscopeData);
       feature->onGyroscopeData(myo, timestamp, gyro);
     }
   }
   virtual void onRssi(myo::Myo* myo, uint64_t timestamp, int8_t rssi) {
-    for (auto feature : child_features_) {
+    for (auto feature : childFeaturesFor(Event::Rssi)) {
+      MYO_INTELLIGESTURE_PROFILE_SCOPE(feature, Event::Rssi);
       feature->onRssi(myo, timestamp, rssi);
     }
   }
   virtual void onEmgData(myo::Myo* myo, uint64_t timestamp,
                          const int8_t* emg) {
-    for (auto feature : child_features_) {
+    for (auto feature : childFeaturesFor(Event::EmgData)) {
+      MYO_INTELLIGESTURE_PROFILE_SCOPE(feature, Event::EmgData);
       feature->onEmgData(myo, timestamp, emg);
     }
   }
   virtual void onPeriodic(myo::Myo* myo) {
-    for (auto feature : child_features_) {
+    for (auto feature : childFeaturesFor(Event::Periodic)) {
+      MYO_INTELLIGESTURE_PROFILE_SCOPE(feature, Event::Periodic);
       feature->onPeriodic(myo);
     }
   }
+  // envelope holds one value per EMG channel, see kEmgEnvelopeScale.
+  virtual void onEmgEnvelope(myo::Myo* myo, uint64_t timestamp,
+                             const int16_t* envelope) {
+    for (auto feature : childFeaturesFor(Event::EmgEnvelope)) {
+      MYO_INTELLIGESTURE_PROFILE_SCOPE(feature, Event::EmgEnvelope);
+      feature->onEmgEnvelope(myo, timestamp, envelope);
+    }
+  }
+  virtual void onEmgFeatures(myo::Myo* myo, uint64_t timestamp,
+                             const EmgFeatures& features) {
+    for (auto feature : childFeaturesFor(Event::EmgFeatures)) {
+      MYO_INTELLIGESTURE_PROFILE_SCOPE(feature, Event::EmgFeatures);
+      feature->onEmgFeatures(myo, timestamp, features);
+    }
+  }
+
+  // Each sample of the batch is passed to the matching per-sample method. A
+  // feature which can handle a whole batch more cheaply overrides these and
+  // passes its output on with the matching forward*Batch method.
+  virtual void onOrientationDataBatch(myo::Myo* myo,
+                                      const OrientationBatch& batch) {
+    for (std::size_t i = 0; i < batch.size; ++i) {
+      onOrientationData(myo, batch.timestamps[i], batch.samples[i]);
+    }
+  }
+  virtual void onAccelerometerDataBatch(myo::Myo* myo,
+                                        const VectorBatch& batch) {
+    for (std::size_t i = 0; i < batch.size; ++i) {
+      onAccelerometerData(myo, batch.timestamps[i], batch.samples[i]);
+    }
+  }
+  virtual void onGyroscopeDataBatch(myo::Myo* myo, const VectorBatch& batch) {
+    for (std::size_t i = 0; i < batch.size; ++i) {
+      onGyroscopeData(myo, batch.timestamps[i], batch.samples[i]);
+    }
+  }
+  virtual void onEmgDataBatch(myo::Myo* myo, const EmgBatch& batch) {
+    for (std::size_t i = 0; i < batch.size; ++i) {
+      onEmgData(myo, batch.timestamps[i], batch.samples[i].data());
+    }
+  }
+
+#ifdef MYO_INTELLIGESTURE_PROFILE
+  FeatureProfile& profile() { return profile_; }
+  const FeatureProfile& profile() const { return profile_; }
+  // Writes one line per event type received by this feature and then the
+  // profiles of its children, indented by depth.
+  void writeProfile(std::ostream& out, int depth = 0) const {
+    std::string indent(2 * depth, ' ');
+    out << indent << featureName(typeid(*this)) << "\n";
+    for (int type = 0; type < Event::NumTypes; ++type) {
+      const EventProfile& event =
+          profile_.event(static_cast<Event::Type>(type));
+      if (event.calls == 0) {
+        continue;
+      }
+      out << indent << "  " << Event::name(static_cast<Event::Type>(type))
+          << " calls=" << event.calls << " inclusive_ns=" << event.inclusive_ns
+          << " exclusive_ns=" << event.exclusive_ns
+          << " p50_ns<=" << event.latency.percentile(0.5)
+          << " p99_ns<=" << event.latency.percentile(0.99)
+          << " max_ns<=" << event.latency.percentile(1) << "\n";
+    }
+    writeChildProfiles(out, depth + 1);
+  }
+#endif
+
+ protected:
+  // Must be called if the value of handledEvents() or forwardedEvents()
+  // changes after the feature has been added to the tree.
+  void invalidateSubscriptions() {
+    // If this feature is already invalid then so are all of its ancestors.
+    if (subscriptions_valid_) {
+      subscriptions_valid_ = false;
+      for (auto parent : parent_features_) {
+        parent->invalidateSubscriptions();
+      }
+    }
+  }
+
+  const std::vector<child_feature_t>& childFeaturesFor(Event::Type type) {
+    updateSubscriptions();
+    return event_child_features_[type];
+  }
+
+  // The events needed by child features which are called directly instead of
+  // through child_features_, see StaticDispatch.h. Called whenever the
+  // subscriptions are rebuilt.
+  virtual EventMask linkedChildEvents() { return NoEvents; }
+
+  // Subscriptions are rebuilt lazily on the next event so that every feature in
+  // the tree has been fully constructed when the virtual methods are called.
+  // This is checked for every event, so only the check is inlined.
+  void updateSubscriptions() {
+    if (!subscriptions_valid_) {
+      rebuildSubscriptions();
+    }
+  }
+
+  // Pass a batch on to each child feature in one call.
+  virtual void forwardOrientationDataBatch(myo::Myo* myo,
+                                           const OrientationBatch& batch) {
+    for (auto feature : childFeaturesFor(Event::OrientationData)) {
+      MYO_INTELLIGESTURE_PROFILE_SCOPE(feature, Event::OrientationData);
+      feature->onOrientationDataBatch(myo, batch);
+    }
+  }
+  virtual void forwardAccelerometerDataBatch(myo::Myo* myo,
+                                             const VectorBatch& batch) {
+    for (auto feature : childFeaturesFor(Event::AccelerometerData)) {
+      MYO_INTELLIGESTURE_PROFILE_SCOPE(feature, Event::AccelerometerData);
+      feature->onAccelerometerDataBatch(myo, batch);
+    }
+  }
+  virtual void forwardGyroscopeDataBatch(myo::Myo* myo,
+                                         const VectorBatch& batch) {
+    for (auto feature : childFeaturesFor(Event::GyroscopeData)) {
+      MYO_INTELLIGESTURE_PROFILE_SCOPE(feature, Event::GyroscopeData);
+      feature->onGyroscopeDataBatch(myo, batch);
+    }
+  }
+  virtual void forwardEmgDataBatch(myo::Myo* myo, const EmgBatch& batch) {
+    for (auto feature : childFeaturesFor(Event::EmgData)) {
+      MYO_INTELLIGESTURE_PROFILE_SCOPE(feature, Event::EmgData);
+      feature->onEmgDataBatch(myo, batch);
+    }
+  }
+
+#ifdef MYO_INTELLIGESTURE_PROFILE
+  virtual void writeChildProfiles(std::ostream& out, int depth) const {
+    for (auto feature : child_features_) {
+      feature->writeProfile(out, depth);
+    }
+  }
+#endif
+
+ private:
+  void removeParentFeature(DeviceListenerWrapper* parent) {
+    parent_features_.erase(std::remove(parent_features_.begin(),
+                                       parent_features_.end(), parent),
+                           parent_features_.end());
+  }
+
+  void rebuildSubscriptions() {
+    EventMask children_events = linkedChildEvents();
+    for (auto& event_child_features : event_child_features_) {
+      event_child_features.clear();
+    }
+    for (auto feature : child_features_) {
+      EventMask feature_events = feature->subscribedEvents();
+      children_events |= feature_events;
+      for (int type = 0; type < Event::NumTypes; ++type) {
+        if (feature_events & EventBit(static_cast<Event::Type>(type))) {
+          event_child_features_[type].push_back(feature);
+        }
+      }
+    }
+    subscribed_events_ =
+        handledEvents() | (forwardedEvents() & children_events);
+    subscriptions_valid_ = true;
+  }
+
+  std::vector<DeviceListenerWrapper*> parent_features_;
+  std::array<std::vector<child_feature_t>, Event::NumTypes>
+      event_child_features_;
+  EventMask subscribed_events_;
+  bool subscriptions_valid_;
+#ifdef MYO_INTELLIGESTURE_PROFILE
+  FeatureProfile profile_;
+#endif
 };
 }
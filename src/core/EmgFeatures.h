@@ -0,0 +1,26 @@
+/* EmgFeatures holds the classic time domain features of the EMG data over a
+ * window of samples, one value per channel, as passed to onEmgFeatures. See
+ * features/EmgFeatureExtractor.h for how they are computed.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+
+namespace core {
+struct EmgFeatures {
+  // The number of samples the features are over.
+  std::size_t window_size;
+  // The mean of the absolute values of the samples.
+  std::array<float, 8> mean_absolute_value;
+  // The square root of the mean of the squares of the samples.
+  std::array<float, 8> root_mean_square;
+  // The sum of the absolute differences between consecutive samples.
+  std::array<int, 8> waveform_length;
+  // The number of times that consecutive samples have opposite signs.
+  std::array<int, 8> zero_crossings;
+  // The number of times that the slope between samples changes sign.
+  std::array<int, 8> slope_sign_changes;
+};
+}
@@ -0,0 +1,54 @@
+/* Identifies each of the callbacks in DeviceListenerWrapper. An EventMask has
+ * one bit per Event::Type and is used by features to declare which events they
+ * and their child features need, so that events nobody needs are not passed
+ * down the feature tree.
+ */
+
+#pragma once
+
+#include <cstdint>
+
+namespace core {
+namespace Event {
+// The order matches the bits in features::Blocker::EventFlags.
+enum Type {
+  Pair,
+  Unpair,
+  Connect,
+  Disconnect,
+  ArmSync,
+  ArmUnsync,
+  Unlock,
+  Lock,
+  Pose,
+  Gesture,
+  OrientationData,
+  AccelerometerData,
+  GyroscopeData,
+  Rssi,
+  EmgData,
+  Periodic,
+  EmgEnvelope,
+  EmgFeatures,
+  NumTypes
+};
+
+const char* name(Type type);
+}
+
+typedef uint32_t EventMask;
+
+const EventMask NoEvents = 0;
+const EventMask AllEvents = (1u << Event::NumTypes) - 1;
+
+constexpr EventMask EventBit(Event::Type type) { return 1u << type; }
+
+const char* Event::name(Type type) {
+  static const char* const names[NumTypes] = {
+      "Pair", "Unpair", "Connect", "Disconnect", "ArmSync",
+      "ArmUnsync", "Unlock", "Lock", "Pose", "Gesture", "OrientationData",
+      "AccelerometerData", "GyroscopeData", "Rssi", "EmgData", "Periodic",
+      "EmgEnvelope", "EmgFeatures"};
+  return names[type];
+}
+}
@@ -0,0 +1,197 @@
+/* Float4 holds four floats which are added, multiplied and divided together,
+ * one lane at a time. Where SSE is available each operation is a single SSE
+ * instruction, otherwise it is four scalar operations. Both implementations are
+ * always defined, as SseFloat4 and ScalarFloat4, so that they can be compared;
+ * Float4 is the faster one. Define MYO_INTELLIGESTURE_NO_SIMD to always use the
+ * scalar implementation.
+ *
+ * A quaternion fills the four lanes in the order x, y, z, w, and a vector
+ * fills the first three lanes in the order x, y, z.
+ */
+
+#pragma once
+
+#include <myo/myo.hpp>
+
+#if !defined(MYO_INTELLIGESTURE_NO_SIMD) &&                     \
+    (defined(__SSE__) || defined(_M_X64) ||                     \
+     (defined(_M_IX86_FP) && _M_IX86_FP >= 1))
+#define MYO_INTELLIGESTURE_SSE
+#include <xmmintrin.h>
+#endif
+
+namespace core {
+class ScalarFloat4 {
+ public:
+  ScalarFloat4() = default;
+  // Every lane is set to value.
+  explicit ScalarFloat4(float value);
+  ScalarFloat4(float x, float y, float z, float w);
+  explicit ScalarFloat4(const myo::Quaternion<float>& quat);
+  // The last lane is set to 0.
+  explicit ScalarFloat4(const myo::Vector3<float>& vec);
+
+  // values must hold four floats.
+  static ScalarFloat4 load(const float* values);
+  void store(float* values) const;
+
+  myo::Quaternion<float> toQuaternion() const;
+  // The last lane is dropped.
+  myo::Vector3<float> toVector3() const;
+
+  ScalarFloat4 operator+(const ScalarFloat4& other) const;
+  ScalarFloat4 operator-(const ScalarFloat4& other) const;
+  ScalarFloat4 operator*(const ScalarFloat4& other) const;
+  ScalarFloat4 operator/(const ScalarFloat4& other) const;
+
+  // The sum of the products of the lanes, e.g. the cosine of half the angle
+  // between two unit quaternions.
+  float dot(const ScalarFloat4& other) const;
+
+ private:
+  float lanes_[4];
+};
+
+ScalarFloat4::ScalarFloat4(float value)
+    : lanes_{value, value, value, value} {}
+
+ScalarFloat4::ScalarFloat4(float x, float y, float z, float w)
+    : lanes_{x, y, z, w} {}
+
+ScalarFloat4::ScalarFloat4(const myo::Quaternion<float>& quat)
+    : lanes_{quat.x(), quat.y(), quat.z(), quat.w()} {}
+
+ScalarFloat4::ScalarFloat4(const myo::Vector3<float>& vec)
+    : lanes_{vec.x(), vec.y(), vec.z(), 0.f} {}
+
+ScalarFloat4 ScalarFloat4::load(const float* values) {
+  return ScalarFloat4(values[0], values[1], values[2], values[3]);
+}
+
+void ScalarFloat4::store(float* values) const {
+  for (int i = 0; i < 4; ++i) {
+    values[i] = lanes_[i];
+  }
+}
+
+myo::Quaternion<float> ScalarFloat4::toQuaternion() const {
+  return myo::Quaternion<float>(lanes_[0], lanes_[1], lanes_[2], lanes_[3]);
+}
+
+myo::Vector3<float> ScalarFloat4::toVector3() const {
+  return myo::Vector3<float>(lanes_[0], lanes_[1], lanes_[2]);
+}
+
+ScalarFloat4 ScalarFloat4::operator+(const ScalarFloat4& other) const {
+  return ScalarFloat4(lanes_[0] + other.lanes_[0], lanes_[1] + other.lanes_[1],
+                      lanes_[2] + other.lanes_[2], lanes_[3] + other.lanes_[3]);
+}
+
+ScalarFloat4 ScalarFloat4::operator-(const ScalarFloat4& other) const {
+  return ScalarFloat4(lanes_[0] - other.lanes_[0], lanes_[1] - other.lanes_[1],
+                      lanes_[2] - other.lanes_[2], lanes_[3] - other.lanes_[3]);
+}
+
+ScalarFloat4 ScalarFloat4::operator*(const ScalarFloat4& other) const {
+  return ScalarFloat4(lanes_[0] * other.lanes_[0], lanes_[1] * other.lanes_[1],
+                      lanes_[2] * other.lanes_[2], lanes_[3] * other.lanes_[3]);
+}
+
+ScalarFloat4 ScalarFloat4::operator/(const ScalarFloat4& other) const {
+  return ScalarFloat4(lanes_[0] / other.lanes_[0], lanes_[1] / other.lanes_[1],
+                      lanes_[2] / other.lanes_[2], lanes_[3] / other.lanes_[3]);
+}
+
+float ScalarFloat4::dot(const ScalarFloat4& other) const {
+  return lanes_[0] * other.lanes_[0] + lanes_[1] * other.lanes_[1] +
+         lanes_[2] * other.lanes_[2] + lanes_[3] * other.lanes_[3];
+}
+
+#ifdef MYO_INTELLIGESTURE_SSE
+class SseFloat4 {
+ public:
+  SseFloat4() = default;
+  explicit SseFloat4(float value);
+  SseFloat4(float x, float y, float z, float w);
+  explicit SseFloat4(const myo::Quaternion<float>& quat);
+  explicit SseFloat4(const myo::Vector3<float>& vec);
+
+  static SseFloat4 load(const float* values);
+  void store(float* values) const;
+
+  myo::Quaternion<float> toQuaternion() const;
+  myo::Vector3<float> toVector3() const;
+
+  SseFloat4 operator+(const SseFloat4& other) const;
+  SseFloat4 operator-(const SseFloat4& other) const;
+  SseFloat4 operator*(const SseFloat4& other) const;
+  SseFloat4 operator/(const SseFloat4& other) const;
+
+  float dot(const SseFloat4& other) const;
+
+ private:
+  explicit SseFloat4(__m128 lanes);
+
+  __m128 lanes_;
+};
+
+SseFloat4::SseFloat4(float value) : lanes_(_mm_set1_ps(value)) {}
+
+SseFloat4::SseFloat4(float x, float y, float z, float w)
+    : lanes_(_mm_setr_ps(x, y, z, w)) {}
+
+SseFloat4::SseFloat4(const myo::Quaternion<float>& quat)
+    : SseFloat4(quat.x(), quat.y(), quat.z(), quat.w()) {}
+
+SseFloat4::SseFloat4(const myo::Vector3<float>& vec)
+    : SseFloat4(vec.x(), vec.y(), vec.z(), 0.f) {}
+
+SseFloat4::SseFloat4(__m128 lanes) : lanes_(lanes) {}
+
+SseFloat4 SseFloat4::load(const float* values) {
+  return SseFloat4(_mm_loadu_ps(values));
+}
+
+void SseFloat4::store(float* values) const { _mm_storeu_ps(values, lanes_); }
+
+myo::Quaternion<float> SseFloat4::toQuaternion() const {
+  float values[4];
+  store(values);
+  return myo::Quaternion<float>(values[0], values[1], values[2], values[3]);
+}
+
+myo::Vector3<float> SseFloat4::toVector3() const {
+  float values[4];
+  store(values);
+  return myo::Vector3<float>(values[0], values[1], values[2]);
+}
+
+SseFloat4 SseFloat4::operator+(const SseFloat4& other) const {
+  return SseFloat4(_mm_add_ps(lanes_, other.lanes_));
+}
+
+SseFloat4 SseFloat4::operator-(const SseFloat4& other) const {
+  return SseFloat4(_mm_sub_ps(lanes_, other.lanes_));
+}
+
+SseFloat4 SseFloat4::operator*(const SseFloat4& other) const {
+  return SseFloat4(_mm_mul_ps(lanes_, other.lanes_));
+}
+
+SseFloat4 SseFloat4::operator/(const SseFloat4& other) const {
+  return SseFloat4(_mm_div_ps(lanes_, other.lanes_));
+}
+
+// Adds the products pairwise, then the two pairs.
+float SseFloat4::dot(const SseFloat4& other) const {
+  const __m128 products = _mm_mul_ps(lanes_, other.lanes_);
+  const __m128 pairs = _mm_add_ps(
+      products, _mm_shuffle_ps(products, products, _MM_SHUFFLE(2, 3, 0, 1)));
+  return _mm_cvtss_f32(_mm_add_ss(pairs, _mm_movehl_ps(pairs, pairs)));
+}
+
+typedef SseFloat4 Float4;
+#else
+typedef ScalarFloat4 Float4;
+#endif
+}
@@ -1,5 +1,8 @@
 #pragma once
 
+#include <atomic>
+#include <cstdint>
+#include <functional>
 #include <string>
 
 #include "Pose.h"
@@ -9,6 +12,9 @@ class Gesture {
  public:
   enum Type { unknown };
 
+  // Uniquely identifies a gesture, including gestures added by derived classes.
+  typedef uint16_t Id;
+
   Gesture(Type type = unknown);
   Gesture(const std::shared_ptr<Pose>& pose, Type type = unknown);
   virtual ~Gesture() {}
@@ -16,36 +22,56 @@ class Gesture {
   bool operator==(const Gesture& gesture) const;
   bool operator!=(const Gesture& gesture) const;
 
+  Id id() const;
+
   virtual std::string toString() const;
 
-  std::shared_ptr<Pose> AssociatedPose() const;
+  const std::shared_ptr<Pose>& AssociatedPose() const;
 
   std::string toDescriptiveString() const;
 
  protected:
+  // Derived classes which add new gestures reserve a block of ids for them,
+  // and call setId when constructed with one of those gestures.
+  static Id ReserveIds(Id count);
+  void setId(Id id);
+
   const std::shared_ptr<Pose> associated_pose_;
 
  private:
   const Type type_;
+  Id id_;
 };
 
 Gesture::Gesture(Type type)
-    : type_(type), associated_pose_(new Pose(Pose::rest)) {}
+    : type_(type), associated_pose_(Pose::interned(Pose::rest)), id_(type) {}
 
 Gesture::Gesture(const std::shared_ptr<Pose>& pose, Type type)
-    : type_(type), associated_pose_(pose) {}
+    : type_(type), associated_pose_(pose), id_(type) {}
 
+// Compare ids rather than types so the operator can be used polymorphically.
+// Like before, the associated pose is not part of the comparison.
 bool Gesture::operator==(const Gesture& gesture) const {
-  return this->toString() == gesture.toString();
+  return id_ == gesture.id_;
 }
 
 bool Gesture::operator!=(const Gesture& gesture) const {
-  return this->toString() != gesture.toString();
+  return id_ != gesture.id_;
+}
+
+Gesture::Id Gesture::id() const { return id_; }
+
+Gesture::Id Gesture::ReserveIds(Id count) {
+  // Ids [0, unknown] belong to Gesture::Type.
+  static std::atomic<Id> next_id(unknown + 1);
+  return next_id.fetch_add(count);
 }
 
+void Gesture::setId(Id id) { id_ = id; }
+
 std::string Gesture::toString() const { return "unknown"; }
 
-std::shared_ptr<Pose> Gesture::AssociatedPose() const {
+const std::shared_ptr<Pose>& Gesture::AssociatedPose() const {
   return associated_pose_;
 }
 
@@ -57,3 +83,12 @@ std::ostream& operator<<(std::ostream& os, const Gesture& gesture) {
   return os << gesture.toString();
 }
 }
+
+namespace std {
+template <>
+struct hash<core::Gesture> {
+  size_t operator()(const core::Gesture& gesture) const {
+    return gesture.id();
+  }
+};
+}
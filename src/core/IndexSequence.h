@@ -0,0 +1,21 @@
+/* IndexSequence stands in for std::index_sequence, which is C++14, as the
+ * library only needs C++11. MakeIndexSequence<N>::type is
+ * IndexSequence<0, 1, ..., N - 1>, which lets a pack expansion visit N
+ * indices, e.g. to build an array in a C++11 constexpr function.
+ */
+
+#pragma once
+
+#include <cstddef>
+
+namespace core {
+template <std::size_t... I>
+struct IndexSequence {};
+
+template <std::size_t N, std::size_t... I>
+struct MakeIndexSequence : MakeIndexSequence<N - 1, N - 1, I...> {};
+template <std::size_t... I>
+struct MakeIndexSequence<0, I...> {
+  typedef IndexSequence<I...> type;
+};
+}
@@ -0,0 +1,222 @@
+/* Int16x8 holds eight 16 bit integers which are added, subtracted, shifted and
+ * multiplied together, one lane at a time, for fixed point filters. Where SSE2
+ * is available each operation is one or a few SSE2 instructions, otherwise it
+ * is eight scalar operations. As with Float4 (see Float4.h), both
+ * implementations are always defined, as SseInt16x8 and ScalarInt16x8, and
+ * Int16x8 is the faster one. Define MYO_INTELLIGESTURE_NO_SIMD to always use
+ * the scalar implementation.
+ *
+ * The eight lanes fit one EMG sample, one lane per channel.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+
+#if !defined(MYO_INTELLIGESTURE_NO_SIMD) &&                     \
+    (defined(__SSE2__) || defined(_M_X64) ||                    \
+     (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define MYO_INTELLIGESTURE_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace core {
+class ScalarInt16x8 {
+ public:
+  ScalarInt16x8() = default;
+  // Every lane is set to value.
+  explicit ScalarInt16x8(int16_t value);
+
+  // values must hold eight integers.
+  static ScalarInt16x8 load(const int16_t* values);
+  static ScalarInt16x8 load(const int8_t* values);
+  void store(int16_t* values) const;
+  // Lanes outside of the range of int8_t are clamped to it.
+  void store(int8_t* values) const;
+
+  // Adding and subtracting clamp to the range of int16_t instead of wrapping.
+  ScalarInt16x8 operator+(const ScalarInt16x8& other) const;
+  ScalarInt16x8 operator-(const ScalarInt16x8& other) const;
+  // Arithmetic shifts. Bits shifted out of a lane are lost.
+  ScalarInt16x8 operator<<(int bits) const;
+  ScalarInt16x8 operator>>(int bits) const;
+  // Multiplies by other as fixed point numbers with 14 fractional bits, i.e.
+  // other holds values from -2 to 2, and truncates the result.
+  ScalarInt16x8 mulQ14(const ScalarInt16x8& other) const;
+  // The absolute value, with -32768 clamped to 32767.
+  ScalarInt16x8 abs() const;
+
+ private:
+  static int16_t clamp(int32_t value);
+
+  int16_t lanes_[8];
+};
+
+ScalarInt16x8::ScalarInt16x8(int16_t value) {
+  std::fill(lanes_, lanes_ + 8, value);
+}
+
+ScalarInt16x8 ScalarInt16x8::load(const int16_t* values) {
+  ScalarInt16x8 result;
+  std::copy(values, values + 8, result.lanes_);
+  return result;
+}
+
+ScalarInt16x8 ScalarInt16x8::load(const int8_t* values) {
+  ScalarInt16x8 result;
+  std::copy(values, values + 8, result.lanes_);
+  return result;
+}
+
+void ScalarInt16x8::store(int16_t* values) const {
+  std::copy(lanes_, lanes_ + 8, values);
+}
+
+void ScalarInt16x8::store(int8_t* values) const {
+  for (int i = 0; i < 8; ++i) {
+    values[i] = static_cast<int8_t>(
+        std::min<int16_t>(std::max<int16_t>(lanes_[i], -128), 127));
+  }
+}
+
+ScalarInt16x8 ScalarInt16x8::operator+(const ScalarInt16x8& other) const {
+  ScalarInt16x8 result;
+  for (int i = 0; i < 8; ++i) {
+    result.lanes_[i] = clamp(int32_t(lanes_[i]) + other.lanes_[i]);
+  }
+  return result;
+}
+
+ScalarInt16x8 ScalarInt16x8::operator-(const ScalarInt16x8& other) const {
+  ScalarInt16x8 result;
+  for (int i = 0; i < 8; ++i) {
+    result.lanes_[i] = clamp(int32_t(lanes_[i]) - other.lanes_[i]);
+  }
+  return result;
+}
+
+ScalarInt16x8 ScalarInt16x8::operator<<(int bits) const {
+  ScalarInt16x8 result;
+  for (int i = 0; i < 8; ++i) {
+    result.lanes_[i] = static_cast<int16_t>(uint16_t(lanes_[i]) << bits);
+  }
+  return result;
+}
+
+ScalarInt16x8 ScalarInt16x8::operator>>(int bits) const {
+  ScalarInt16x8 result;
+  for (int i = 0; i < 8; ++i) {
+    result.lanes_[i] = static_cast<int16_t>(lanes_[i] >> bits);
+  }
+  return result;
+}
+
+ScalarInt16x8 ScalarInt16x8::mulQ14(const ScalarInt16x8& other) const {
+  ScalarInt16x8 result;
+  for (int i = 0; i < 8; ++i) {
+    result.lanes_[i] =
+        static_cast<int16_t>((int32_t(lanes_[i]) * other.lanes_[i]) >> 14);
+  }
+  return result;
+}
+
+ScalarInt16x8 ScalarInt16x8::abs() const {
+  ScalarInt16x8 result;
+  for (int i = 0; i < 8; ++i) {
+    result.lanes_[i] = clamp(std::abs(int32_t(lanes_[i])));
+  }
+  return result;
+}
+
+int16_t ScalarInt16x8::clamp(int32_t value) {
+  return static_cast<int16_t>(
+      std::min<int32_t>(std::max<int32_t>(value, INT16_MIN), INT16_MAX));
+}
+
+#ifdef MYO_INTELLIGESTURE_SSE2
+class SseInt16x8 {
+ public:
+  SseInt16x8() = default;
+  explicit SseInt16x8(int16_t value);
+
+  static SseInt16x8 load(const int16_t* values);
+  static SseInt16x8 load(const int8_t* values);
+  void store(int16_t* values) const;
+  void store(int8_t* values) const;
+
+  SseInt16x8 operator+(const SseInt16x8& other) const;
+  SseInt16x8 operator-(const SseInt16x8& other) const;
+  SseInt16x8 operator<<(int bits) const;
+  SseInt16x8 operator>>(int bits) const;
+  SseInt16x8 mulQ14(const SseInt16x8& other) const;
+  SseInt16x8 abs() const;
+
+ private:
+  explicit SseInt16x8(__m128i lanes);
+
+  __m128i lanes_;
+};
+
+SseInt16x8::SseInt16x8(int16_t value) : lanes_(_mm_set1_epi16(value)) {}
+
+SseInt16x8::SseInt16x8(__m128i lanes) : lanes_(lanes) {}
+
+SseInt16x8 SseInt16x8::load(const int16_t* values) {
+  return SseInt16x8(
+      _mm_loadu_si128(reinterpret_cast<const __m128i*>(values)));
+}
+
+// The bytes are unpacked into the high half of each lane and shifted down to
+// sign extend them.
+SseInt16x8 SseInt16x8::load(const int8_t* values) {
+  __m128i bytes = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(values));
+  return SseInt16x8(
+      _mm_srai_epi16(_mm_unpacklo_epi8(_mm_setzero_si128(), bytes), 8));
+}
+
+void SseInt16x8::store(int16_t* values) const {
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(values), lanes_);
+}
+
+void SseInt16x8::store(int8_t* values) const {
+  _mm_storel_epi64(reinterpret_cast<__m128i*>(values),
+                   _mm_packs_epi16(lanes_, lanes_));
+}
+
+SseInt16x8 SseInt16x8::operator+(const SseInt16x8& other) const {
+  return SseInt16x8(_mm_adds_epi16(lanes_, other.lanes_));
+}
+
+SseInt16x8 SseInt16x8::operator-(const SseInt16x8& other) const {
+  return SseInt16x8(_mm_subs_epi16(lanes_, other.lanes_));
+}
+
+SseInt16x8 SseInt16x8::operator<<(int bits) const {
+  return SseInt16x8(_mm_sll_epi16(lanes_, _mm_cvtsi32_si128(bits)));
+}
+
+SseInt16x8 SseInt16x8::operator>>(int bits) const {
+  return SseInt16x8(_mm_sra_epi16(lanes_, _mm_cvtsi32_si128(bits)));
+}
+
+// The high and low halves of the 32 bit products are put back together
+// shifted down by 14 bits.
+SseInt16x8 SseInt16x8::mulQ14(const SseInt16x8& other) const {
+  __m128i high = _mm_mulhi_epi16(lanes_, other.lanes_);
+  __m128i low = _mm_mullo_epi16(lanes_, other.lanes_);
+  return SseInt16x8(
+      _mm_or_si128(_mm_slli_epi16(high, 2), _mm_srli_epi16(low, 14)));
+}
+
+SseInt16x8 SseInt16x8::abs() const {
+  return SseInt16x8(_mm_max_epi16(
+      lanes_, _mm_subs_epi16(_mm_setzero_si128(), lanes_)));
+}
+
+typedef SseInt16x8 Int16x8;
+#else
+typedef ScalarInt16x8 Int16x8;
+#endif
+}
@@ -0,0 +1,65 @@
+/* LatencyHistogram counts latencies in one bucket per power of two, so that it
+ * takes a fixed amount of memory and adding a latency never allocates, and
+ * estimates their percentiles. The unit is up to the user: the profiler adds
+ * nanoseconds, see Profile.h, and features::LatencyTracer microseconds.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+namespace core {
+class LatencyHistogram {
+ public:
+  // Bucket i counts latencies in [2^i, 2^(i+1)); bucket 0 also counts 0.
+  static const int kNumBuckets = 40;
+
+  LatencyHistogram();
+
+  void add(uint64_t latency);
+  void reset();
+
+  uint64_t count() const;
+  uint64_t bucket(int i) const;
+  // An upper bound on the given fraction (0 to 1) of the latencies, e.g.
+  // percentile(0.99) is at least the 99th percentile.
+  uint64_t percentile(double fraction) const;
+
+ private:
+  std::array<uint64_t, kNumBuckets> buckets_;
+  uint64_t count_;
+};
+
+LatencyHistogram::LatencyHistogram() : count_(0) { buckets_.fill(0); }
+
+void LatencyHistogram::add(uint64_t latency) {
+  int i = 0;
+  while (latency > 1 && i < kNumBuckets - 1) {
+    latency >>= 1;
+    ++i;
+  }
+  ++buckets_[i];
+  ++count_;
+}
+
+void LatencyHistogram::reset() {
+  buckets_.fill(0);
+  count_ = 0;
+}
+
+uint64_t LatencyHistogram::count() const { return count_; }
+
+uint64_t LatencyHistogram::bucket(int i) const { return buckets_[i]; }
+
+uint64_t LatencyHistogram::percentile(double fraction) const {
+  uint64_t seen = 0;
+  for (int i = 0; i < kNumBuckets; ++i) {
+    seen += buckets_[i];
+    if (seen > 0 && seen >= fraction * count_) {
+      return (uint64_t(1) << (i + 1)) - 1;
+    }
+  }
+  return 0;
+}
+}
@@ -0,0 +1,222 @@
+/* OrderStatisticTree is a sorted multiset of at most capacity values which
+ * finds the k-th smallest value, and the number of values smaller than a
+ * given one, in O(log n). Sliding window filters such as the median use it to
+ * keep their window sorted as samples come and go, instead of sorting the
+ * window for every sample.
+ *
+ * It is a treap: a binary search tree whose nodes also form a heap of random
+ * priorities, which keeps it balanced with high probability. Every node knows
+ * the size of its subtree. The nodes live in a pool allocated once, so that
+ * inserting and erasing never allocate. The priorities come from a fixed seed,
+ * so the tree is the same shape every time it is given the same values.
+ *
+ * Values must be ordered by operator<, e.g. floats other than NaN.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace core {
+template <typename T>
+class OrderStatisticTree {
+ public:
+  explicit OrderStatisticTree(std::size_t capacity);
+
+  // size() must be less than capacity().
+  void insert(const T& value);
+  // Removes one value equal to value. Returns false if there is none.
+  bool erase(const T& value);
+  void clear();
+
+  // The k-th smallest value, from 0. k must be less than size().
+  const T& select(std::size_t k) const;
+  // The number of values less than value.
+  std::size_t rank(const T& value) const;
+
+  std::size_t size() const;
+  std::size_t capacity() const;
+
+ private:
+  static const std::size_t kNone = static_cast<std::size_t>(-1);
+
+  struct Node {
+    T value;
+    uint32_t priority;
+    std::size_t left;
+    std::size_t right;
+    // The number of nodes in the subtree under and including this one.
+    std::size_t size;
+  };
+
+  std::size_t sizeOf(std::size_t node) const;
+  void updateSize(std::size_t node);
+  // Joins two trees whose values are all less than or equal in left than in
+  // right, and returns the root of the result.
+  std::size_t merge(std::size_t left, std::size_t right);
+  // Splits the tree under node into the values less than value and the rest.
+  void split(std::size_t node, const T& value, std::size_t& less,
+             std::size_t& rest);
+  bool erase(std::size_t& node, const T& value);
+  uint32_t nextPriority();
+
+  std::vector<Node> nodes_;
+  // The nodes which are not in the tree.
+  std::vector<std::size_t> free_;
+  std::size_t root_;
+  uint32_t random_state_;
+};
+
+template <typename T>
+OrderStatisticTree<T>::OrderStatisticTree(std::size_t capacity)
+    : nodes_(capacity), root_(kNone), random_state_(2463534242u) {
+  clear();
+}
+
+template <typename T>
+void OrderStatisticTree<T>::insert(const T& value) {
+  const std::size_t node = free_.back();
+  free_.pop_back();
+  nodes_[node].value = value;
+  nodes_[node].priority = nextPriority();
+  nodes_[node].left = nodes_[node].right = kNone;
+  nodes_[node].size = 1;
+  std::size_t less, rest;
+  split(root_, value, less, rest);
+  root_ = merge(merge(less, node), rest);
+}
+
+template <typename T>
+bool OrderStatisticTree<T>::erase(const T& value) {
+  return erase(root_, value);
+}
+
+template <typename T>
+void OrderStatisticTree<T>::clear() {
+  root_ = kNone;
+  free_.clear();
+  for (std::size_t node = nodes_.size(); node > 0; --node) {
+    free_.push_back(node - 1);
+  }
+}
+
+template <typename T>
+const T& OrderStatisticTree<T>::select(std::size_t k) const {
+  std::size_t node = root_;
+  while (true) {
+    const std::size_t left_size = sizeOf(nodes_[node].left);
+    if (k < left_size) {
+      node = nodes_[node].left;
+    } else if (k == left_size) {
+      return nodes_[node].value;
+    } else {
+      k -= left_size + 1;
+      node = nodes_[node].right;
+    }
+  }
+}
+
+template <typename T>
+std::size_t OrderStatisticTree<T>::rank(const T& value) const {
+  std::size_t less = 0;
+  std::size_t node = root_;
+  while (node != kNone) {
+    if (nodes_[node].value < value) {
+      less += sizeOf(nodes_[node].left) + 1;
+      node = nodes_[node].right;
+    } else {
+      node = nodes_[node].left;
+    }
+  }
+  return less;
+}
+
+template <typename T>
+std::size_t OrderStatisticTree<T>::size() const {
+  return sizeOf(root_);
+}
+
+template <typename T>
+std::size_t OrderStatisticTree<T>::capacity() const {
+  return nodes_.size();
+}
+
+template <typename T>
+std::size_t OrderStatisticTree<T>::sizeOf(std::size_t node) const {
+  return node == kNone ? 0 : nodes_[node].size;
+}
+
+template <typename T>
+void OrderStatisticTree<T>::updateSize(std::size_t node) {
+  nodes_[node].size =
+      sizeOf(nodes_[node].left) + sizeOf(nodes_[node].right) + 1;
+}
+
+template <typename T>
+std::size_t OrderStatisticTree<T>::merge(std::size_t left, std::size_t right) {
+  if (left == kNone) {
+    return right;
+  }
+  if (right == kNone) {
+    return left;
+  }
+  if (nodes_[left].priority > nodes_[right].priority) {
+    nodes_[left].right = merge(nodes_[left].right, right);
+    updateSize(left);
+    return left;
+  }
+  nodes_[right].left = merge(left, nodes_[right].left);
+  updateSize(right);
+  return right;
+}
+
+template <typename T>
+void OrderStatisticTree<T>::split(std::size_t node, const T& value,
+                                  std::size_t& less, std::size_t& rest) {
+  if (node == kNone) {
+    less = rest = kNone;
+    return;
+  }
+  if (nodes_[node].value < value) {
+    split(nodes_[node].right, value, nodes_[node].right, rest);
+    less = node;
+  } else {
+    split(nodes_[node].left, value, less, nodes_[node].left);
+    rest = node;
+  }
+  updateSize(node);
+}
+
+template <typename T>
+bool OrderStatisticTree<T>::erase(std::size_t& node, const T& value) {
+  if (node == kNone) {
+    return false;
+  }
+  if (value < nodes_[node].value) {
+    if (!erase(nodes_[node].left, value)) {
+      return false;
+    }
+  } else if (nodes_[node].value < value) {
+    if (!erase(nodes_[node].right, value)) {
+      return false;
+    }
+  } else {
+    free_.push_back(node);
+    node = merge(nodes_[node].left, nodes_[node].right);
+    return true;
+  }
+  updateSize(node);
+  return true;
+}
+
+// Marsaglia's xorshift32.
+template <typename T>
+uint32_t OrderStatisticTree<T>::nextPriority() {
+  random_state_ ^= random_state_ << 13;
+  random_state_ ^= random_state_ >> 17;
+  random_state_ ^= random_state_ << 5;
+  return random_state_;
+}
+}
@@ -0,0 +1,236 @@
+/* Pipeline builds a chain of features whose types are all known at compile
+ * time. Each feature is given a StaticDispatch base so that events travel down
+ * the chain through direct calls instead of virtual calls. The last feature in
+ * the chain keeps a DeviceListenerWrapper base so that a dynamic feature tree
+ * can still be attached to it.
+ *
+ * Every stage must be a feature template which takes its base class as its
+ * only template parameter, e.g. features::filters::BasicDebounce. The
+ * constructor takes one std::tuple of constructor arguments for each stage.
+ * The parent feature argument is filled in by the pipeline.
+ *
+ *   core::Pipeline<features::BasicRootFeature,
+ *                  features::filters::BasicDebounce,
+ *                  features::BasicOrientationPoses,
+ *                  features::gestures::BasicPoseGestures>
+ *       pipeline(std::make_tuple(), std::make_tuple(10),
+ *                std::forward_as_tuple(orientation), std::make_tuple());
+ *   ExampleFeature example(pipeline.leaf());
+ *   hub.addListener(&pipeline.root());
+ *
+ * Every stage is constructed by the pipeline's constructor, so the arguments of
+ * a stage, such as the Orientation feature above, must exist before the
+ * pipeline. If those arguments hang off the same root, build the root first and
+ * attach the pipeline to it instead of making the root a stage:
+ *
+ *   features::RootFeature root_feature;
+ *   features::Orientation orientation(root_feature);
+ *   core::Pipeline<features::filters::BasicDebounce,
+ *                  features::BasicOrientationPoses,
+ *                  features::gestures::BasicPoseGestures>
+ *       pipeline(root_feature, std::make_tuple(10),
+ *                std::forward_as_tuple(orientation), std::make_tuple());
+ *
+ * The root then calls the first stage through a virtual call, and the rest of
+ * the chain is called directly.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "DeviceListenerWrapper.h"
+#include "IndexSequence.h"
+#include "StaticDispatch.h"
+
+namespace core {
+namespace detail {
+template <typename T, typename Tuple>
+struct TuplePrepend;
+template <typename T, typename... Ts>
+struct TuplePrepend<T, std::tuple<Ts...>> {
+  typedef std::tuple<T, Ts...> type;
+};
+
+// Computes the concrete type of every stage, from first to last.
+template <template <typename> class... Stages>
+struct PipelineTypes;
+template <template <typename> class Last>
+struct PipelineTypes<Last> {
+  typedef std::tuple<Last<DeviceListenerWrapper>> type;
+};
+template <template <typename> class First, template <typename> class Second,
+          template <typename> class... Rest>
+struct PipelineTypes<First, Second, Rest...> {
+  typedef typename PipelineTypes<Second, Rest...>::type rest_type;
+  typedef First<StaticDispatch<typename std::tuple_element<0, rest_type>::type>>
+      first_type;
+  typedef typename TuplePrepend<first_type, rest_type>::type type;
+};
+
+// The indices of the elements of a std::tuple of arguments.
+template <typename Args>
+using ArgumentIndices = typename MakeIndexSequence<
+    std::tuple_size<typename std::decay<Args>::type>::value>::type;
+
+template <template <typename> class Stage>
+struct NoArguments {
+  typedef std::tuple<> type;
+};
+
+template <typename... StageTypes>
+class PipelineStorage;
+
+template <typename Stage>
+class PipelineStorage<Stage> {
+ public:
+  template <typename Parent, typename Args>
+  PipelineStorage(Parent* parent, Args&& args)
+      : PipelineStorage(parent, std::forward<Args>(args),
+                        ArgumentIndices<Args>()) {}
+
+  Stage stage_;
+
+ private:
+  template <typename Parent, typename Args, std::size_t... I>
+  PipelineStorage(Parent* parent, Args&& args, IndexSequence<I...>)
+      : stage_(*parent, std::get<I>(std::forward<Args>(args))...) {}
+};
+
+template <typename Stage, typename Next, typename... Rest>
+class PipelineStorage<Stage, Next, Rest...> {
+ public:
+  template <typename Args, typename... RestArgs>
+  PipelineStorage(std::nullptr_t, Args&& args, RestArgs&&... rest_args)
+      : PipelineStorage(nullptr, std::forward<Args>(args),
+                        ArgumentIndices<Args>(),
+                        std::forward<RestArgs>(rest_args)...) {}
+  template <typename Parent, typename Args, typename... RestArgs>
+  PipelineStorage(Parent* parent, Args&& args, RestArgs&&... rest_args)
+      : PipelineStorage(parent, std::forward<Args>(args),
+                        ArgumentIndices<Args>(),
+                        std::forward<RestArgs>(rest_args)...) {}
+
+  Stage stage_;
+  PipelineStorage<Next, Rest...> rest_;
+
+ private:
+  // The first stage is the root of the pipeline and has no parent feature.
+  template <typename Args, std::size_t... I, typename... RestArgs>
+  PipelineStorage(std::nullptr_t, Args&& args, IndexSequence<I...>,
+                  RestArgs&&... rest_args)
+      : stage_(std::get<I>(std::forward<Args>(args))...),
+        rest_(&stage_, std::forward<RestArgs>(rest_args)...) {
+    stage_.link(rest_.stage_);
+  }
+  template <typename Parent, typename Args, std::size_t... I,
+            typename... RestArgs>
+  PipelineStorage(Parent* parent, Args&& args, IndexSequence<I...>,
+                  RestArgs&&... rest_args)
+      : stage_(*parent, std::get<I>(std::forward<Args>(args))...),
+        rest_(&stage_, std::forward<RestArgs>(rest_args)...) {
+    stage_.link(rest_.stage_);
+  }
+};
+
+template <typename... Args>
+struct FirstIsFeature : std::false_type {};
+template <typename First, typename... Rest>
+struct FirstIsFeature<First, Rest...>
+    : std::is_base_of<DeviceListenerWrapper,
+                      typename std::decay<First>::type> {};
+
+template <typename Tuple>
+struct PipelineStorageFor;
+template <typename... StageTypes>
+struct PipelineStorageFor<std::tuple<StageTypes...>> {
+  typedef PipelineStorage<StageTypes...> type;
+};
+
+template <std::size_t N>
+struct PipelineGet {
+  template <typename Stage, typename Storage>
+  static Stage& get(Storage& storage) {
+    return PipelineGet<N - 1>::template get<Stage>(storage.rest_);
+  }
+};
+template <>
+struct PipelineGet<0> {
+  template <typename Stage, typename Storage>
+  static Stage& get(Storage& storage) {
+    return storage.stage_;
+  }
+};
+}
+
+template <template <typename> class... Stages>
+class Pipeline {
+ public:
+  typedef typename detail::PipelineTypes<Stages...>::type stage_types;
+  template <std::size_t N>
+  using Stage = typename std::tuple_element<N, stage_types>::type;
+  static constexpr std::size_t size = sizeof...(Stages);
+
+  static_assert(size >= 2, "A pipeline needs at least two stages.");
+
+  // Constructs every stage with no arguments other than its parent feature.
+  Pipeline();
+  // Takes one std::tuple of constructor arguments per stage.
+  template <typename... StageArgs,
+            typename = typename std::enable_if<
+                !detail::FirstIsFeature<StageArgs...>::value>::type>
+  explicit Pipeline(StageArgs&&... stage_args);
+  // Attaches the first stage to parent_feature, as its parent feature argument.
+  template <typename... StageArgs>
+  Pipeline(DeviceListenerWrapper& parent_feature, StageArgs&&... stage_args);
+
+  template <std::size_t N>
+  Stage<N>& stage();
+  Stage<0>& root();
+  Stage<size - 1>& leaf();
+
+ private:
+  typename detail::PipelineStorageFor<stage_types>::type stages_;
+};
+
+template <template <typename> class... Stages>
+Pipeline<Stages...>::Pipeline()
+    : Pipeline(typename detail::NoArguments<Stages>::type()...) {}
+
+template <template <typename> class... Stages>
+template <typename... StageArgs, typename>
+Pipeline<Stages...>::Pipeline(StageArgs&&... stage_args)
+    : stages_(nullptr, std::forward<StageArgs>(stage_args)...) {
+  static_assert(sizeof...(StageArgs) == size,
+                "Pass exactly one argument tuple per pipeline stage.");
+}
+
+template <template <typename> class... Stages>
+template <typename... StageArgs>
+Pipeline<Stages...>::Pipeline(DeviceListenerWrapper& parent_feature,
+                              StageArgs&&... stage_args)
+    : stages_(&parent_feature, std::forward<StageArgs>(stage_args)...) {
+  static_assert(sizeof...(StageArgs) == size,
+                "Pass exactly one argument tuple per pipeline stage.");
+}
+
+template <template <typename> class... Stages>
+template <std::size_t N>
+typename Pipeline<Stages...>::template Stage<N>& Pipeline<Stages...>::stage() {
+  return detail::PipelineGet<N>::template get<Stage<N>>(stages_);
+}
+
+template <template <typename> class... Stages>
+typename Pipeline<Stages...>::template Stage<0>& Pipeline<Stages...>::root() {
+  return stage<0>();
+}
+
+template <template <typename> class... Stages>
+typename Pipeline<Stages...>::template Stage<Pipeline<Stages...>::size - 1>&
+Pipeline<Stages...>::leaf() {
+  return stage<size - 1>();
+}
+}
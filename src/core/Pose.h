@@ -1,5 +1,10 @@
 #pragma once
 
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
 #include <string>
 #include <iostream>
 
@@ -8,6 +13,9 @@ class Pose {
  public:
   enum Type { rest, fist, waveIn, waveOut, fingersSpread, doubleTap, unknown };
 
+  // Uniquely identifies a pose, including poses added by derived classes.
+  typedef uint16_t Id;
+
   Pose(Type type = unknown);
   Pose(const myo::Pose& pose);
   virtual ~Pose() {}
@@ -15,13 +23,29 @@ class Pose {
   bool operator==(const Pose& pose) const;
   bool operator!=(const Pose& pose) const;
 
+  Id id() const;
+  // The core pose, or unknown for the poses added by derived classes.
+  Type type() const;
+
   virtual std::string toString() const;
 
+  // Returns a shared instance of the pose. Poses are immutable, so features
+  // should emit these instead of allocating a new pose for every event.
+  static const std::shared_ptr<Pose>& interned(Type type);
+  static const std::shared_ptr<Pose>& interned(const myo::Pose& pose);
+
+ protected:
+  // Derived classes which add new poses reserve a block of ids for them, and
+  // call setId when constructed with one of those poses.
+  static Id ReserveIds(Id count);
+  void setId(Id id);
+
  private:
   Type type_;
+  Id id_;
 };
 
-Pose::Pose(Type type) : type_(type) {}
+Pose::Pose(Type type) : type_(type), id_(type) {}
 
 Pose::Pose(const myo::Pose& pose) {
   switch (pose.type()) {
@@ -47,18 +71,41 @@ Pose::Pose(const myo::Pose& pose) {
       type_ = unknown;
       break;
   }
+  id_ = type_;
+}
+
+// Compare ids rather than types so the operator can be used polymorphically.
+bool Pose::operator==(const Pose& pose) const { return id_ == pose.id_; }
+
+bool Pose::operator!=(const Pose& pose) const { return id_ != pose.id_; }
+
+Pose::Id Pose::id() const { return id_; }
+
+Pose::Type Pose::type() const { return type_; }
+
+const std::shared_ptr<Pose>& Pose::interned(Type type) {
+  static const std::array<std::shared_ptr<Pose>, unknown + 1> poses = [] {
+    std::array<std::shared_ptr<Pose>, unknown + 1> poses;
+    for (int type = rest; type <= unknown; ++type) {
+      poses[type] = std::make_shared<Pose>(static_cast<Type>(type));
+    }
+    return poses;
+  }();
+  return poses[type];
 }
 
-// Use toString for comparisons so the operator can be used polymorphically.
-// Because of this toString MUST return a unique value.
-bool Pose::operator==(const Pose& pose) const {
-  return this->toString() == pose.toString();
+const std::shared_ptr<Pose>& Pose::interned(const myo::Pose& pose) {
+  return interned(Pose(pose).type_);
 }
 
-bool Pose::operator!=(const Pose& pose) const {
-  return this->toString() != pose.toString();
+Pose::Id Pose::ReserveIds(Id count) {
+  // Ids [0, unknown] belong to Pose::Type.
+  static std::atomic<Id> next_id(unknown + 1);
+  return next_id.fetch_add(count);
 }
 
+void Pose::setId(Id id) { id_ = id; }
+
 std::string Pose::toString() const {
   switch (type_) {
     case rest:
@@ -82,3 +129,10 @@ std::ostream& operator<<(std::ostream& os, const Pose& pose) {
   return os << pose.toString();
 }
 }
+
+namespace std {
+template <>
+struct hash<core::Pose> {
+  size_t operator()(const core::Pose& pose) const { return pose.id(); }
+};
+}
@@ -0,0 +1,140 @@
+/* Optional profiling of the feature tree. When MYO_INTELLIGESTURE_PROFILE is
+ * defined before any header of this library is included, every call which a
+ * feature receives from its parent is counted and timed, per event type:
+ *
+ *   - calls is the number of calls.
+ *   - inclusive_ns is the time spent in the feature and its subtree.
+ *   - exclusive_ns is the time spent in the feature itself, i.e. the inclusive
+ *     time minus the inclusive time of the calls it made to its children.
+ *   - latency is a histogram of the inclusive time of each call, with one
+ *     bucket per power of two nanoseconds.
+ *
+ * Read the numbers of a feature with feature.profile().event(Event::Pose), or
+ * write those of a whole tree with root_feature.writeProfile(std::cout).
+ *
+ * When MYO_INTELLIGESTURE_PROFILE is not defined, none of this is compiled and
+ * features have no profiling members, so the dispatch path costs nothing
+ * extra. The root feature is called by the hub rather than by a parent, so its
+ * own profile is always empty.
+ */
+
+#pragma once
+
+#ifdef MYO_INTELLIGESTURE_PROFILE
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <typeinfo>
+#ifdef __GNUG__
+#include <cxxabi.h>
+#endif
+
+#include "Event.h"
+#include "LatencyHistogram.h"
+
+namespace core {
+struct EventProfile {
+  EventProfile() : calls(0), inclusive_ns(0), exclusive_ns(0) {}
+
+  uint64_t calls;
+  uint64_t inclusive_ns;
+  uint64_t exclusive_ns;
+  LatencyHistogram latency;
+};
+
+class FeatureProfile {
+ public:
+  const EventProfile& event(Event::Type type) const;
+  void record(Event::Type type, uint64_t inclusive_ns, uint64_t exclusive_ns);
+  void reset();
+
+ private:
+  std::array<EventProfile, Event::NumTypes> events_;
+};
+
+// Times one call to a feature. Scopes nest on each thread so that a scope can
+// subtract the time of the calls made inside it from its exclusive time.
+class ProfileScope {
+ public:
+  ProfileScope(FeatureProfile& profile, Event::Type type);
+  ~ProfileScope();
+
+  ProfileScope(const ProfileScope&) = delete;
+  ProfileScope& operator=(const ProfileScope&) = delete;
+
+ private:
+  typedef std::chrono::steady_clock Clock;
+
+  static ProfileScope*& current();
+
+  FeatureProfile& profile_;
+  Event::Type type_;
+  ProfileScope* parent_;
+  uint64_t children_ns_;
+  Clock::time_point start_;
+};
+
+// The human readable name of a feature's type.
+std::string featureName(const std::type_info& type);
+
+const EventProfile& FeatureProfile::event(Event::Type type) const {
+  return events_[type];
+}
+
+void FeatureProfile::record(Event::Type type, uint64_t inclusive_ns,
+                            uint64_t exclusive_ns) {
+  EventProfile& event = events_[type];
+  ++event.calls;
+  event.inclusive_ns += inclusive_ns;
+  event.exclusive_ns += exclusive_ns;
+  event.latency.add(inclusive_ns);
+}
+
+void FeatureProfile::reset() { events_.fill(EventProfile()); }
+
+ProfileScope::ProfileScope(FeatureProfile& profile, Event::Type type)
+    : profile_(profile),
+      type_(type),
+      parent_(current()),
+      children_ns_(0),
+      start_(Clock::now()) {
+  current() = this;
+}
+
+ProfileScope::~ProfileScope() {
+  uint64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    Clock::now() - start_).count();
+  profile_.record(type_, ns, ns > children_ns_ ? ns - children_ns_ : 0);
+  current() = parent_;
+  if (parent_) {
+    parent_->children_ns_ += ns;
+  }
+}
+
+ProfileScope*& ProfileScope::current() {
+  static thread_local ProfileScope* scope = nullptr;
+  return scope;
+}
+
+std::string featureName(const std::type_info& type) {
+#ifdef __GNUG__
+  int status = 0;
+  std::unique_ptr<char, void (*)(void*)> name(
+      abi::__cxa_demangle(type.name(), nullptr, nullptr, &status), std::free);
+  if (status == 0) {
+    return name.get();
+  }
+#endif
+  return type.name();
+}
+}
+
+#define MYO_INTELLIGESTURE_PROFILE_SCOPE(feature, type) \
+  core::ProfileScope profile_scope((feature)->profile(), type)
+#else
+#define MYO_INTELLIGESTURE_PROFILE_SCOPE(feature, type)
+#endif
@@ -0,0 +1,52 @@
+/* SampleBatch is a view of consecutive samples of one kind from one Myo, along
+ * with their timestamps. Features which receive samples at a high rate can
+ * handle a whole batch in one call instead of one call per sample. See the
+ * on*Batch methods of DeviceListenerWrapper.
+ *
+ * A batch does not own its samples, which are only valid for the duration of
+ * the call that it was passed to.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <myo/myo.hpp>
+
+namespace core {
+// The 8 channels of one EMG sample, as passed to onEmgData.
+typedef std::array<int8_t, 8> EmgSample;
+// An EMG envelope, as passed to onEmgEnvelope, counts in 1/kEmgEnvelopeScale
+// of a unit of EMG.
+const int kEmgEnvelopeScale = 32;
+
+template <typename Sample>
+struct SampleBatch {
+  SampleBatch(const uint64_t* timestamps, const Sample* samples,
+              std::size_t size);
+
+  // A batch with the same timestamps as this one but other samples, e.g. the
+  // output of a filter.
+  SampleBatch withSamples(const Sample* other_samples) const;
+
+  const uint64_t* timestamps;
+  const Sample* samples;
+  std::size_t size;
+};
+
+typedef SampleBatch<myo::Quaternion<float>> OrientationBatch;
+typedef SampleBatch<myo::Vector3<float>> VectorBatch;
+typedef SampleBatch<EmgSample> EmgBatch;
+
+template <typename Sample>
+SampleBatch<Sample>::SampleBatch(const uint64_t* timestamps,
+                                 const Sample* samples, std::size_t size)
+    : timestamps(timestamps), samples(samples), size(size) {}
+
+template <typename Sample>
+SampleBatch<Sample> SampleBatch<Sample>::withSamples(
+    const Sample* other_samples) const {
+  return SampleBatch(timestamps, other_samples, size);
+}
+}
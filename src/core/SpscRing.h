@@ -0,0 +1,117 @@
+/* SpscRing is a bounded, lock-free queue for exactly one producer thread and
+ * one consumer thread. tryPush may only be called by the producer and tryPop
+ * by the consumer; size and empty may be called by either, but are only exact
+ * when the other thread is not running.
+ *
+ * Each thread keeps a cached copy of the other thread's index and only reads
+ * the shared one when the cached copy says the ring is full or empty, so that
+ * the two threads rarely touch the same cache line.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+namespace core {
+template <typename T>
+class SpscRing {
+ public:
+  // The capacity is rounded up to a power of two.
+  explicit SpscRing(std::size_t capacity);
+
+  SpscRing(const SpscRing&) = delete;
+  SpscRing& operator=(const SpscRing&) = delete;
+
+  // Returns false, without copying item, if the ring is full.
+  bool tryPush(const T& item);
+  // Returns false, leaving item unchanged, if the ring is empty.
+  bool tryPop(T& item);
+
+  std::size_t size() const;
+  bool empty() const;
+  std::size_t capacity() const;
+
+ private:
+  static const std::size_t kCacheLine = 64;
+
+  static std::size_t roundUpToPowerOfTwo(std::size_t n);
+
+  std::vector<T> items_;
+  const std::size_t mask_;
+
+  // The indices only ever increase; they are masked to index items_.
+  char padding0_[kCacheLine];
+  // Written by the consumer.
+  std::atomic<std::size_t> head_;
+  std::size_t cached_tail_;
+  char padding1_[kCacheLine];
+  // Written by the producer.
+  std::atomic<std::size_t> tail_;
+  std::size_t cached_head_;
+  char padding2_[kCacheLine];
+};
+
+template <typename T>
+SpscRing<T>::SpscRing(std::size_t capacity)
+    : items_(roundUpToPowerOfTwo(capacity)),
+      mask_(items_.size() - 1),
+      head_(0),
+      cached_tail_(0),
+      tail_(0),
+      cached_head_(0) {}
+
+template <typename T>
+bool SpscRing<T>::tryPush(const T& item) {
+  const std::size_t tail = tail_.load(std::memory_order_relaxed);
+  if (tail - cached_head_ == items_.size()) {
+    cached_head_ = head_.load(std::memory_order_acquire);
+    if (tail - cached_head_ == items_.size()) {
+      return false;
+    }
+  }
+  items_[tail & mask_] = item;
+  tail_.store(tail + 1, std::memory_order_release);
+  return true;
+}
+
+template <typename T>
+bool SpscRing<T>::tryPop(T& item) {
+  const std::size_t head = head_.load(std::memory_order_relaxed);
+  if (head == cached_tail_) {
+    cached_tail_ = tail_.load(std::memory_order_acquire);
+    if (head == cached_tail_) {
+      return false;
+    }
+  }
+  item = items_[head & mask_];
+  head_.store(head + 1, std::memory_order_release);
+  return true;
+}
+
+template <typename T>
+std::size_t SpscRing<T>::size() const {
+  const std::size_t head = head_.load(std::memory_order_acquire);
+  return tail_.load(std::memory_order_acquire) - head;
+}
+
+template <typename T>
+bool SpscRing<T>::empty() const {
+  return size() == 0;
+}
+
+template <typename T>
+std::size_t SpscRing<T>::capacity() const {
+  return items_.size();
+}
+
+template <typename T>
+std::size_t SpscRing<T>::roundUpToPowerOfTwo(std::size_t n) {
+  std::size_t power = 1;
+  while (power < n) {
+    power <<= 1;
+  }
+  return power;
+}
+}
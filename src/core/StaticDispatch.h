@@ -0,0 +1,343 @@
+/* StaticDispatch is a drop-in replacement for DeviceListenerWrapper as the base
+ * class of a feature whose child feature's type is known at compile time. The
+ * events that child subscribes to are forwarded to it with a direct
+ * (non-virtual) call, which lets the compiler inline an entire chain of
+ * features. Any other features added with addChildFeature are still called
+ * through the usual dynamic path. See Pipeline.h for how chains of
+ * StaticDispatch features are built.
+ */
+
+#pragma once
+
+#include <myo/myo.hpp>
+
+#include "DeviceListenerWrapper.h"
+
+namespace core {
+template <typename Next>
+class StaticDispatch : public DeviceListenerWrapper {
+ public:
+  StaticDispatch();
+
+  // Sets the statically dispatched child. The child is removed from the
+  // dynamic children so that it does not receive every event twice.
+  void link(Next& next);
+
+  virtual void onPair(myo::Myo* myo, uint64_t timestamp,
+                      myo::FirmwareVersion firmware_version) override;
+  virtual void onUnpair(myo::Myo* myo, uint64_t timestamp) override;
+  virtual void onConnect(myo::Myo* myo, uint64_t timestamp,
+                         myo::FirmwareVersion firmware_version) override;
+  virtual void onDisconnect(myo::Myo* myo, uint64_t timestamp) override;
+  virtual void onArmSync(myo::Myo* myo, uint64_t timestamp, myo::Arm arm,
+                         myo::XDirection x_direction) override;
+  virtual void onArmUnsync(myo::Myo* myo, uint64_t timestamp) override;
+  virtual void onUnlock(myo::Myo* myo, uint64_t timestamp) override;
+  virtual void onLock(myo::Myo* myo, uint64_t timestamp) override;
+  virtual void onPose(myo::Myo* myo, uint64_t timestamp,
+                      const std::shared_ptr<core::Pose>& pose) override;
+  virtual void onGesture(
+      myo::Myo* myo, uint64_t timestamp,
+      const std::shared_ptr<core::Gesture>& gesture) override;
+  virtual void onOrientationData(
+      myo::Myo* myo, uint64_t timestamp,
+      const myo::Quaternion<float>& rotation) override;
+  virtual void onAccelerometerData(
+      myo::Myo* myo, uint64_t timestamp,
+      const myo::Vector3<float>& acceleration) override;
+  virtual void onGyroscopeData(myo::Myo* myo, uint64_t timestamp,
+                               const myo::Vector3<float>& gyro) override;
+  virtual void onRssi(myo::Myo* myo, uint64_t timestamp, int8_t rssi) override;
+  virtual void onEmgData(myo::Myo* myo, uint64_t timestamp,
+                         const int8_t* emg) override;
+  virtual void onPeriodic(myo::Myo* myo) override;
+  virtual void onEmgEnvelope(myo::Myo* myo, uint64_t timestamp,
+                             const int16_t* envelope) override;
+  virtual void onEmgFeatures(myo::Myo* myo, uint64_t timestamp,
+                             const EmgFeatures& features) override;
+
+ protected:
+  virtual void forwardOrientationDataBatch(
+      myo::Myo* myo, const OrientationBatch& batch) override;
+  virtual void forwardAccelerometerDataBatch(
+      myo::Myo* myo, const VectorBatch& batch) override;
+  virtual void forwardGyroscopeDataBatch(myo::Myo* myo,
+                                         const VectorBatch& batch) override;
+  virtual void forwardEmgDataBatch(myo::Myo* myo,
+                                   const EmgBatch& batch) override;
+  virtual EventMask linkedChildEvents() override;
+#ifdef MYO_INTELLIGESTURE_PROFILE
+  virtual void writeChildProfiles(std::ostream& out,
+                                  int depth) const override;
+#endif
+
+ private:
+  bool nextSubscribesTo(Event::Type type);
+
+  Next* next_;
+  // The events next_ subscribes to, cached whenever the subscriptions of this
+  // feature are rebuilt.
+  EventMask next_events_;
+};
+
+template <typename Next>
+StaticDispatch<Next>::StaticDispatch()
+    : next_(nullptr), next_events_(NoEvents) {}
+
+template <typename Next>
+void StaticDispatch<Next>::link(Next& next) {
+  next_ = &next;
+  // Erase the child directly rather than with removeChildFeature so that it
+  // keeps this feature as a parent and still invalidates its subscriptions.
+  child_features_.erase(&next);
+  invalidateSubscriptions();
+}
+
+// next_ keeps this feature as a parent, so its subscriptions changing
+// invalidates those of this feature and they are rebuilt, calling this, before
+// the next event.
+template <typename Next>
+EventMask StaticDispatch<Next>::linkedChildEvents() {
+  next_events_ = next_ ? next_->subscribedEvents() : NoEvents;
+  return next_events_;
+}
+
+template <typename Next>
+bool StaticDispatch<Next>::nextSubscribesTo(Event::Type type) {
+  updateSubscriptions();
+  return (next_events_ & EventBit(type)) != 0;
+}
+
+#ifdef MYO_INTELLIGESTURE_PROFILE
+template <typename Next>
+void StaticDispatch<Next>::writeChildProfiles(std::ostream& out,
+                                              int depth) const {
+  if (next_) {
+    next_->writeProfile(out, depth);
+  }
+  DeviceListenerWrapper::writeChildProfiles(out, depth);
+}
+#endif
+
+// The qualified Next::on* calls below bypass the vtable. This is only correct
+// because the pipeline guarantees that next_ points to an object whose dynamic
+// type is exactly Next. Like the dynamic children, next_ is only given the
+// events it subscribes to.
+
+template <typename Next>
+void StaticDispatch<Next>::onPair(myo::Myo* myo, uint64_t timestamp,
+                                  myo::FirmwareVersion firmware_version) {
+  if (nextSubscribesTo(Event::Pair)) {
+    MYO_INTELLIGESTURE_PROFILE_SCOPE(next_, Event::Pair);
+    next_->Next::onPair(myo, timestamp, firmware_version);
+  }
+  DeviceListenerWrapper::onPair(myo, timestamp, firmware_version);
+}
+
+template <typename Next>
+void StaticDispatch<Next>::onUnpair(myo::Myo* myo, uint64_t timestamp) {
+  if (nextSubscribesTo(Event::Unpair)) {
+    MYO_INTELLIGESTURE_PROFILE_SCOPE(next_, Event::Unpair);
+    next_->Next::onUnpair(myo, timestamp);
+  }
+  DeviceListenerWrapper::onUnpair(myo, timestamp);
+}
+
+template <typename Next>
+void StaticDispatch<Next>::onConnect(myo::Myo* myo, uint64_t timestamp,
+                                     myo::FirmwareVersion firmware_version) {
+  if (nextSubscribesTo(Event::Connect)) {
+    MYO_INTELLIGESTURE_PROFILE_SCOPE(next_, Event::Connect);
+    next_->Next::onConnect(myo, timestamp, firmware_version);
+  }
+  DeviceListenerWrapper::onConnect(myo, timestamp, firmware_version);
+}
+
+template <typename Next>
+void StaticDispatch<Next>::onDisconnect(myo::Myo* myo, uint64_t timestamp) {
+  if (nextSubscribesTo(Event::Disconnect)) {
+    MYO_INTELLIGESTURE_PROFILE_SCOPE(next_, Event::Disconnect);
+    next_->Next::onDisconnect(myo, timestamp);
+  }
+  DeviceListenerWrapper::onDisconnect(myo, timestamp);
+}
+
+template <typename Next>
+void StaticDispatch<Next>::onArmSync(myo::Myo* myo, uint64_t timestamp,
+                                     myo::Arm arm,
+                                     myo::XDirection x_direction) {
+  if (nextSubscribesTo(Event::ArmSync)) {
+    MYO_INTELLIGESTURE_PROFILE_SCOPE(next_, Event::ArmSync);
+    next_->Next::onArmSync(myo, timestamp, arm, x_direction);
+  }
+  DeviceListenerWrapper::onArmSync(myo, timestamp, arm, x_direction);
+}
+
+template <typename Next>
+void StaticDispatch<Next>::onArmUnsync(myo::Myo* myo, uint64_t timestamp) {
+  if (nextSubscribesTo(Event::ArmUnsync)) {
+    MYO_INTELLIGESTURE_PROFILE_SCOPE(next_, Event::ArmUnsync);
+    next_->Next::onArmUnsync(myo, timestamp);
+  }
+  DeviceListenerWrapper::onArmUnsync(myo, timestamp);
+}
+
+template <typename Next>
+void StaticDispatch<Next>::onUnlock(myo::Myo* myo, uint64_t timestamp) {
+  if (nextSubscribesTo(Event::Unlock)) {
+    MYO_INTELLIGESTURE_PROFILE_SCOPE(next_, Event::Unlock);
+    next_->Next::onUnlock(myo, timestamp);
+  }
+  DeviceListenerWrapper::onUnlock(myo, timestamp);
+}
+
+template <typename Next>
+void StaticDispatch<Next>::onLock(myo::Myo* myo, uint64_t timestamp) {
+  if (nextSubscribesTo(Event::Lock)) {
+    MYO_INTELLIGESTURE_PROFILE_SCOPE(next_, Event::Lock);
+    next_->Next::onLock(myo, timestamp);
+  }
+  DeviceListenerWrapper::onLock(myo, timestamp);
+}
+
+template <typename Next>
+void StaticDispatch<Next>::onPose(myo::Myo* myo, uint64_t timestamp,
+                                  const std::shared_ptr<core::Pose>& pose) {
+  if (nextSubscribesTo(Event::Pose)) {
+    MYO_INTELLIGESTURE_PROFILE_SCOPE(next_, Event::Pose);
+    next_->Next::onPose(myo, timestamp, pose);
+  }
+  DeviceListenerWrapper::onPose(myo, timestamp, pose);
+}
+
+template <typename Next>
+void StaticDispatch<Next>::onGesture(
+    myo::Myo* myo, uint64_t timestamp,
+    const std::shared_ptr<core::Gesture>& gesture) {
+  if (nextSubscribesTo(Event::Gesture)) {
+    MYO_INTELLIGESTURE_PROFILE_SCOPE(next_, Event::Gesture);
+    next_->Next::onGesture(myo, timestamp, gesture);
+  }
+  DeviceListenerWrapper::onGesture(myo, timestamp, gesture);
+}
+
+template <typename Next>
+void StaticDispatch<Next>::onOrientationData(
+    myo::Myo* myo, uint64_t timestamp, const myo::Quaternion<float>& rotation) {
+  if (nextSubscribesTo(Event::OrientationData)) {
+    MYO_INTELLIGESTURE_PROFILE_SCOPE(next_, Event::OrientationData);
+    next_->Next::onOrientationData(myo, timestamp, rotation);
+  }
+  DeviceListenerWrapper::onOrientationData(myo, timestamp, rotation);
+}
+
+template <typename Next>
+void StaticDispatch<Next>::onAccelerometerData(
+    myo::Myo* myo, uint64_t timestamp,
+    const myo::Vector3<float>& acceleration) {
+  if (nextSubscribesTo(Event::AccelerometerData)) {
+    MYO_INTELLIGESTURE_PROFILE_SCOPE(next_, Event::AccelerometerData);
+    next_->Next::onAccelerometerData(myo, timestamp, acceleration);
+  }
+  DeviceListenerWrapper::onAccelerometerData(myo, timestamp, acceleration);
+}
+
+template <typename Next>
+void StaticDispatch<Next>::onGyroscopeData(myo::Myo* myo, uint64_t timestamp,
+                                           const myo::Vector3<float>& gyro) {
+  if (nextSubscribesTo(Event::GyroscopeData)) {
+    MYO_INTELLIGESTURE_PROFILE_SCOPE(next_, Event::GyroscopeData);
+    next_->Next::onGyroscopeData(myo, timestamp, gyro);
+  }
+  DeviceListenerWrapper::onGyroscopeData(myo, timestamp, gyro);
+}
+
+template <typename Next>
+void StaticDispatch<Next>::onRssi(myo::Myo* myo, uint64_t timestamp,
+                                  int8_t rssi) {
+  if (nextSubscribesTo(Event::Rssi)) {
+    MYO_INTELLIGESTURE_PROFILE_SCOPE(next_, Event::Rssi);
+    next_->Next::onRssi(myo, timestamp, rssi);
+  }
+  DeviceListenerWrapper::onRssi(myo, timestamp, rssi);
+}
+
+template <typename Next>
+void StaticDispatch<Next>::onEmgData(myo::Myo* myo, uint64_t timestamp,
+                                     const int8_t* emg) {
+  if (nextSubscribesTo(Event::EmgData)) {
+    MYO_INTELLIGESTURE_PROFILE_SCOPE(next_, Event::EmgData);
+    next_->Next::onEmgData(myo, timestamp, emg);
+  }
+  DeviceListenerWrapper::onEmgData(myo, timestamp, emg);
+}
+
+template <typename Next>
+void StaticDispatch<Next>::onPeriodic(myo::Myo* myo) {
+  if (nextSubscribesTo(Event::Periodic)) {
+    MYO_INTELLIGESTURE_PROFILE_SCOPE(next_, Event::Periodic);
+    next_->Next::onPeriodic(myo);
+  }
+  DeviceListenerWrapper::onPeriodic(myo);
+}
+
+template <typename Next>
+void StaticDispatch<Next>::onEmgEnvelope(myo::Myo* myo, uint64_t timestamp,
+                                         const int16_t* envelope) {
+  if (nextSubscribesTo(Event::EmgEnvelope)) {
+    MYO_INTELLIGESTURE_PROFILE_SCOPE(next_, Event::EmgEnvelope);
+    next_->Next::onEmgEnvelope(myo, timestamp, envelope);
+  }
+  DeviceListenerWrapper::onEmgEnvelope(myo, timestamp, envelope);
+}
+
+template <typename Next>
+void StaticDispatch<Next>::onEmgFeatures(myo::Myo* myo, uint64_t timestamp,
+                                         const EmgFeatures& features) {
+  if (nextSubscribesTo(Event::EmgFeatures)) {
+    MYO_INTELLIGESTURE_PROFILE_SCOPE(next_, Event::EmgFeatures);
+    next_->Next::onEmgFeatures(myo, timestamp, features);
+  }
+  DeviceListenerWrapper::onEmgFeatures(myo, timestamp, features);
+}
+
+template <typename Next>
+void StaticDispatch<Next>::forwardOrientationDataBatch(
+    myo::Myo* myo, const OrientationBatch& batch) {
+  if (nextSubscribesTo(Event::OrientationData)) {
+    MYO_INTELLIGESTURE_PROFILE_SCOPE(next_, Event::OrientationData);
+    next_->Next::onOrientationDataBatch(myo, batch);
+  }
+  DeviceListenerWrapper::forwardOrientationDataBatch(myo, batch);
+}
+
+template <typename Next>
+void StaticDispatch<Next>::forwardAccelerometerDataBatch(
+    myo::Myo* myo, const VectorBatch& batch) {
+  if (nextSubscribesTo(Event::AccelerometerData)) {
+    MYO_INTELLIGESTURE_PROFILE_SCOPE(next_, Event::AccelerometerData);
+    next_->Next::onAccelerometerDataBatch(myo, batch);
+  }
+  DeviceListenerWrapper::forwardAccelerometerDataBatch(myo, batch);
+}
+
+template <typename Next>
+void StaticDispatch<Next>::forwardGyroscopeDataBatch(
+    myo::Myo* myo, const VectorBatch& batch) {
+  if (nextSubscribesTo(Event::GyroscopeData)) {
+    MYO_INTELLIGESTURE_PROFILE_SCOPE(next_, Event::GyroscopeData);
+    next_->Next::onGyroscopeDataBatch(myo, batch);
+  }
+  DeviceListenerWrapper::forwardGyroscopeDataBatch(myo, batch);
+}
+
+template <typename Next>
+void StaticDispatch<Next>::forwardEmgDataBatch(myo::Myo* myo,
+                                               const EmgBatch& batch) {
+  if (nextSubscribesTo(Event::EmgData)) {
+    MYO_INTELLIGESTURE_PROFILE_SCOPE(next_, Event::EmgData);
+    next_->Next::onEmgDataBatch(myo, batch);
+  }
+  DeviceListenerWrapper::forwardEmgDataBatch(myo, batch);
+}
+}
@@ -0,0 +1,161 @@
+/* ThreadPool runs tasks on a fixed set of worker threads. Each worker has its
+ * own queue of tasks. A task submitted by a worker goes to the back of that
+ * worker's queue, where the worker takes it next while it is still in cache;
+ * any other task goes to the workers' queues in turn. A worker whose queue is
+ * empty steals the oldest task of another worker's queue before it sleeps.
+ *
+ * The destructor runs every task which was already submitted.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace core {
+class ThreadPool {
+ public:
+  typedef std::function<void()> Task;
+
+  // num_threads of 0 means one per core.
+  explicit ThreadPool(unsigned num_threads = 0);
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  // May be called from any thread, including from a task.
+  void submit(Task task);
+
+  std::size_t size() const;
+
+ private:
+  struct Worker {
+    std::mutex mutex;
+    std::deque<Task> tasks;
+  };
+
+  // The index of the worker of this pool which is running on this thread, or
+  // -1 if there is none.
+  int currentWorker() const;
+  void run(unsigned index);
+  bool tryTake(unsigned index, Task& task);
+
+  static thread_local const ThreadPool* current_pool_;
+  static thread_local int current_index_;
+
+  std::vector<std::unique_ptr<Worker>> workers_;
+  std::vector<std::thread> threads_;
+  std::atomic<unsigned> next_worker_;
+  // Tasks submitted but not yet taken by a worker.
+  std::atomic<std::size_t> queued_;
+
+  std::mutex mutex_;
+  std::condition_variable task_available_;
+  std::atomic<unsigned> sleeping_;
+  bool stopping_;
+};
+
+thread_local const ThreadPool* ThreadPool::current_pool_ = nullptr;
+thread_local int ThreadPool::current_index_ = -1;
+
+ThreadPool::ThreadPool(unsigned num_threads)
+    : next_worker_(0), queued_(0), sleeping_(0), stopping_(false) {
+  if (num_threads == 0) {
+    num_threads = std::max(1u, std::thread::hardware_concurrency());
+  }
+  for (unsigned i = 0; i < num_threads; ++i) {
+    workers_.emplace_back(new Worker());
+  }
+  for (unsigned i = 0; i < num_threads; ++i) {
+    threads_.emplace_back(&ThreadPool::run, this, i);
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  task_available_.notify_all();
+  for (std::thread& thread : threads_) {
+    thread.join();
+  }
+}
+
+void ThreadPool::submit(Task task) {
+  int index = currentWorker();
+  if (index < 0) {
+    index = next_worker_.fetch_add(1, std::memory_order_relaxed) %
+            workers_.size();
+  }
+  // Counted before it is queued so that the count never drops below zero.
+  queued_.fetch_add(1);
+  {
+    Worker& worker = *workers_[index];
+    std::lock_guard<std::mutex> lock(worker.mutex);
+    worker.tasks.push_back(std::move(task));
+  }
+  // Pairs with the increment of sleeping_ in run.
+  if (sleeping_.load() > 0) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    task_available_.notify_one();
+  }
+}
+
+std::size_t ThreadPool::size() const { return workers_.size(); }
+
+int ThreadPool::currentWorker() const {
+  return current_pool_ == this ? current_index_ : -1;
+}
+
+void ThreadPool::run(unsigned index) {
+  current_pool_ = this;
+  current_index_ = index;
+  Task task;
+  while (true) {
+    if (tryTake(index, task)) {
+      task();
+      task = nullptr;
+      continue;
+    }
+    std::unique_lock<std::mutex> lock(mutex_);
+    sleeping_.fetch_add(1);
+    task_available_.wait(lock,
+                         [this] { return queued_.load() > 0 || stopping_; });
+    sleeping_.fetch_sub(1);
+    if (stopping_ && queued_.load() == 0) {
+      return;
+    }
+  }
+}
+
+bool ThreadPool::tryTake(unsigned index, Task& task) {
+  // The newest task of this worker's queue, then the oldest of the others'.
+  for (std::size_t i = 0; i < workers_.size(); ++i) {
+    Worker& worker = *workers_[(index + i) % workers_.size()];
+    std::lock_guard<std::mutex> lock(worker.mutex);
+    if (worker.tasks.empty()) {
+      continue;
+    }
+    if (i == 0) {
+      task = std::move(worker.tasks.back());
+      worker.tasks.pop_back();
+    } else {
+      task = std::move(worker.tasks.front());
+      worker.tasks.pop_front();
+    }
+    queued_.fetch_sub(1);
+    return true;
+  }
+  return false;
+}
+}
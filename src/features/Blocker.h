@@ -9,7 +9,9 @@
 #include "../core/DeviceListenerWrapper.h"
 
 namespace features {
-class Blocker : public core::DeviceListenerWrapper {
+// The flags do not depend on BasicBlocker's base class, so they live in a
+// separate class to be shared by every instantiation.
+class BlockerTypes {
  public:
   enum EventFlags {
     Pair              = 1 << 0,
@@ -27,10 +29,19 @@ class Blocker : public core::DeviceListenerWrapper {
     GyroscopeData     = 1 << 12,
     Rssi              = 1 << 13,
     EmgData           = 1 << 14,
-    Periodic          = 1 << 15
+    Periodic          = 1 << 15,
+    EmgEnvelope       = 1 << 16,
+    EmgFeatures       = 1 << 17
   };
+};
+
+template <typename Base = core::DeviceListenerWrapper>
+class BasicBlocker : public Base, public BlockerTypes {
+ public:
+  BasicBlocker(core::DeviceListenerWrapper& parent_feature, EventFlags flags);
 
-  Blocker(core::DeviceListenerWrapper& parent_feature, EventFlags flags);
+  virtual core::EventMask handledEvents() const override;
+  virtual core::EventMask forwardedEvents() const override;
 
   virtual void onPair(myo::Myo* myo, uint64_t timestamp,
                       myo::FirmwareVersion firmware_version) override;
@@ -59,123 +70,179 @@ class Blocker : public core::DeviceListenerWrapper {
   virtual void onEmgData(myo::Myo* myo, uint64_t timestamp,
                          const int8_t* emg) override;
   virtual void onPeriodic(myo::Myo* myo) override;
+  virtual void onEmgEnvelope(myo::Myo* myo, uint64_t timestamp,
+                             const int16_t* envelope) override;
+  virtual void onEmgFeatures(myo::Myo* myo, uint64_t timestamp,
+                             const core::EmgFeatures& features) override;
 
  private:
   const EventFlags flags_;
 };
 
-Blocker::EventFlags operator|(Blocker::EventFlags lhs,
-                              Blocker::EventFlags rhs) {
-  return static_cast<Blocker::EventFlags>(static_cast<int>(lhs) |
-                                          static_cast<int>(rhs));
+typedef BasicBlocker<> Blocker;
+
+BlockerTypes::EventFlags operator|(BlockerTypes::EventFlags lhs,
+                                   BlockerTypes::EventFlags rhs) {
+  return static_cast<BlockerTypes::EventFlags>(static_cast<int>(lhs) |
+                                               static_cast<int>(rhs));
 }
 
-Blocker::Blocker(core::DeviceListenerWrapper& parent_feature, EventFlags flags)
+template <typename Base>
+BasicBlocker<Base>::BasicBlocker(core::DeviceListenerWrapper& parent_feature,
+                                 EventFlags flags)
     : flags_(flags) {
   parent_feature.addChildFeature(this);
 }
 
-void Blocker::onPair(myo::Myo* myo, uint64_t timestamp,
-            myo::FirmwareVersion firmware_version) {
+template <typename Base>
+core::EventMask BasicBlocker<Base>::handledEvents() const {
+  return core::NoEvents;
+}
+
+// Blocked events are pruned from the subscriptions of the whole subtree, so
+// the parent feature doesn't call this feature for them at all.
+template <typename Base>
+core::EventMask BasicBlocker<Base>::forwardedEvents() const {
+  return core::AllEvents & ~static_cast<core::EventMask>(flags_);
+}
+
+template <typename Base>
+void BasicBlocker<Base>::onPair(myo::Myo* myo, uint64_t timestamp,
+                                myo::FirmwareVersion firmware_version) {
   if (!(flags_ & Pair)) {
-    core::DeviceListenerWrapper::onPair(myo, timestamp, firmware_version);
+    Base::onPair(myo, timestamp, firmware_version);
   }
 }
 
-void Blocker::onUnpair(myo::Myo* myo, uint64_t timestamp) {
+template <typename Base>
+void BasicBlocker<Base>::onUnpair(myo::Myo* myo, uint64_t timestamp) {
   if (!(flags_ & Unpair)) {
-    core::DeviceListenerWrapper::onUnpair(myo, timestamp);
+    Base::onUnpair(myo, timestamp);
   }
 }
 
-void Blocker::onConnect(myo::Myo* myo, uint64_t timestamp,
-               myo::FirmwareVersion firmware_version) {
+template <typename Base>
+void BasicBlocker<Base>::onConnect(myo::Myo* myo, uint64_t timestamp,
+                                   myo::FirmwareVersion firmware_version) {
   if (!(flags_ & Connect)) {
-    core::DeviceListenerWrapper::onConnect(myo, timestamp, firmware_version);
+    Base::onConnect(myo, timestamp, firmware_version);
   }
 }
 
-void Blocker::onDisconnect(myo::Myo* myo, uint64_t timestamp) {
+template <typename Base>
+void BasicBlocker<Base>::onDisconnect(myo::Myo* myo, uint64_t timestamp) {
   if (!(flags_ & Disconnect)) {
-    core::DeviceListenerWrapper::onDisconnect(myo, timestamp);
+    Base::onDisconnect(myo, timestamp);
   }
 }
 
-void Blocker::onArmSync(myo::Myo* myo, uint64_t timestamp, myo::Arm arm,
-               myo::XDirection x_direction) {
+template <typename Base>
+void BasicBlocker<Base>::onArmSync(myo::Myo* myo, uint64_t timestamp,
+                                   myo::Arm arm, myo::XDirection x_direction) {
   if (!(flags_ & ArmSync)) {
-    core::DeviceListenerWrapper::onArmSync(myo, timestamp, arm, x_direction);
+    Base::onArmSync(myo, timestamp, arm, x_direction);
   }
 }
 
-void Blocker::onArmUnsync(myo::Myo* myo, uint64_t timestamp) {
+template <typename Base>
+void BasicBlocker<Base>::onArmUnsync(myo::Myo* myo, uint64_t timestamp) {
   if (!(flags_ & ArmUnsync)) {
-    core::DeviceListenerWrapper::onArmUnsync(myo, timestamp);
+    Base::onArmUnsync(myo, timestamp);
   }
 }
 
-void Blocker::onUnlock(myo::Myo* myo, uint64_t timestamp) {
+template <typename Base>
+void BasicBlocker<Base>::onUnlock(myo::Myo* myo, uint64_t timestamp) {
   if (!(flags_ & Unlock)) {
-    core::DeviceListenerWrapper::onUnlock(myo, timestamp);
+    Base::onUnlock(myo, timestamp);
   }
 }
 
-void Blocker::onLock(myo::Myo* myo, uint64_t timestamp) {
+template <typename Base>
+void BasicBlocker<Base>::onLock(myo::Myo* myo, uint64_t timestamp) {
   if (!(flags_ & Lock)) {
-    core::DeviceListenerWrapper::onLock(myo, timestamp);
+    Base::onLock(myo, timestamp);
   }
 }
 
-void Blocker::onPose(myo::Myo* myo, uint64_t timestamp,
-            const std::shared_ptr<core::Pose>& pose) {
+template <typename Base>
+void BasicBlocker<Base>::onPose(myo::Myo* myo, uint64_t timestamp,
+                                const std::shared_ptr<core::Pose>& pose) {
   if (!(flags_ & Pose)) {
-    core::DeviceListenerWrapper::onPose(myo, timestamp, pose);
+    Base::onPose(myo, timestamp, pose);
   }
 }
 
-void Blocker::onGesture(myo::Myo* myo, uint64_t timestamp,
-               const std::shared_ptr<core::Gesture>& gesture) {
+template <typename Base>
+void BasicBlocker<Base>::onGesture(
+    myo::Myo* myo, uint64_t timestamp,
+    const std::shared_ptr<core::Gesture>& gesture) {
   if (!(flags_ & Gesture)) {
-    core::DeviceListenerWrapper::onGesture(myo, timestamp, gesture);
+    Base::onGesture(myo, timestamp, gesture);
   }
 }
 
-void Blocker::onOrientationData(myo::Myo* myo, uint64_t timestamp,
-                       const myo::Quaternion<float>& rotation) {
+template <typename Base>
+void BasicBlocker<Base>::onOrientationData(
+    myo::Myo* myo, uint64_t timestamp,
+    const myo::Quaternion<float>& rotation) {
   if (!(flags_ & OrientationData)) {
-    core::DeviceListenerWrapper::onOrientationData(myo, timestamp, rotation);
+    Base::onOrientationData(myo, timestamp, rotation);
   }
 }
 
-void Blocker::onAccelerometerData(myo::Myo* myo, uint64_t timestamp,
-                         const myo::Vector3<float>& accel) {
+template <typename Base>
+void BasicBlocker<Base>::onAccelerometerData(myo::Myo* myo, uint64_t timestamp,
+                                             const myo::Vector3<float>& accel) {
   if (!(flags_ & AccelerometerData)) {
-    core::DeviceListenerWrapper::onAccelerometerData(myo, timestamp, accel);
+    Base::onAccelerometerData(myo, timestamp, accel);
   }
 }
 
-void Blocker::onGyroscopeData(myo::Myo* myo, uint64_t timestamp,
-                     const myo::Vector3<float>& gyro) {
+template <typename Base>
+void BasicBlocker<Base>::onGyroscopeData(myo::Myo* myo, uint64_t timestamp,
+                                         const myo::Vector3<float>& gyro) {
   if (!(flags_ & GyroscopeData)) {
-    core::DeviceListenerWrapper::onGyroscopeData(myo, timestamp, gyro);
+    Base::onGyroscopeData(myo, timestamp, gyro);
   }
 }
 
-void Blocker::onRssi(myo::Myo* myo, uint64_t timestamp, int8_t rssi) {
+template <typename Base>
+void BasicBlocker<Base>::onRssi(myo::Myo* myo, uint64_t timestamp,
+                                int8_t rssi) {
   if (!(flags_ & Rssi)) {
-    core::DeviceListenerWrapper::onRssi(myo, timestamp, rssi);
+    Base::onRssi(myo, timestamp, rssi);
   }
 }
 
-void Blocker::onEmgData(myo::Myo* myo, uint64_t timestamp, const int8_t* emg) {
+template <typename Base>
+void BasicBlocker<Base>::onEmgData(myo::Myo* myo, uint64_t timestamp,
+                                   const int8_t* emg) {
   if (!(flags_ & EmgData)) {
-    core::DeviceListenerWrapper::onEmgData(myo, timestamp, emg);
+    Base::onEmgData(myo, timestamp, emg);
   }
 }
 
-void Blocker::onPeriodic(myo::Myo* myo) {
+template <typename Base>
+void BasicBlocker<Base>::onPeriodic(myo::Myo* myo) {
   if (!(flags_ & Periodic)) {
-    core::DeviceListenerWrapper::onPeriodic(myo);
+    Base::onPeriodic(myo);
+  }
+}
+
+template <typename Base>
+void BasicBlocker<Base>::onEmgEnvelope(myo::Myo* myo, uint64_t timestamp,
+                                       const int16_t* envelope) {
+  if (!(flags_ & EmgEnvelope)) {
+    Base::onEmgEnvelope(myo, timestamp, envelope);
+  }
+}
+
+template <typename Base>
+void BasicBlocker<Base>::onEmgFeatures(myo::Myo* myo, uint64_t timestamp,
+                                       const core::EmgFeatures& features) {
+  if (!(flags_ & EmgFeatures)) {
+    Base::onEmgFeatures(myo, timestamp, features);
   }
 }
 }
@@ -5,20 +5,31 @@
 
 #pragma once
 
+#include <cstddef>
 #include <myo/myo.hpp>
+#include <vector>
 
 #include "../core/DeviceListenerWrapper.h"
 
 namespace features {
-class CorrectForOrientation : public core::DeviceListenerWrapper {
+// The flags do not depend on BasicCorrectForOrientation's base class, so they
+// live in a separate class to be shared by every instantiation.
+class CorrectForOrientationTypes {
  public:
   enum DataFlags {
     AccelerometerData = 1 << 0,
     GyroscopeData     = 1 << 1
   };
+};
+
+template <typename Base = core::DeviceListenerWrapper>
+class BasicCorrectForOrientation : public Base,
+                                   public CorrectForOrientationTypes {
+ public:
+  explicit BasicCorrectForOrientation(
+      core::DeviceListenerWrapper& parent_feature, DataFlags flags);
 
-  explicit CorrectForOrientation(core::DeviceListenerWrapper& parent_feature,
-                                 DataFlags flags);
+  virtual core::EventMask handledEvents() const override;
 
   virtual void onOrientationData(myo::Myo* myo, uint64_t timestamp,
                                  const myo::Quaternion<float>& quat) override;
@@ -26,48 +37,110 @@ class CorrectForOrientation : public core::DeviceListenerWrapper {
                                    const myo::Vector3<float>& accel) override;
   virtual void onGyroscopeData(myo::Myo* myo, uint64_t timestamp,
                                const myo::Vector3<float>& gyro) override;
+  virtual void onOrientationDataBatch(
+      myo::Myo* myo, const core::OrientationBatch& batch) override;
+  virtual void onAccelerometerDataBatch(
+      myo::Myo* myo, const core::VectorBatch& batch) override;
+  virtual void onGyroscopeDataBatch(myo::Myo* myo,
+                                    const core::VectorBatch& batch) override;
 
  private:
+  // Rotates every sample of the batch by last_quat_ into rotated_batch_.
+  const myo::Vector3<float>* rotateBatch(const core::VectorBatch& batch);
+
   const DataFlags flags_;
   myo::Quaternion<float> last_quat_;
+  std::vector<myo::Vector3<float>> rotated_batch_;
 };
 
-CorrectForOrientation::DataFlags operator|(
-    CorrectForOrientation::DataFlags lhs,
-    CorrectForOrientation::DataFlags rhs) {
-  return static_cast<CorrectForOrientation::DataFlags>(static_cast<int>(lhs) |
-                                                       static_cast<int>(rhs));
+typedef BasicCorrectForOrientation<> CorrectForOrientation;
+
+CorrectForOrientationTypes::DataFlags operator|(
+    CorrectForOrientationTypes::DataFlags lhs,
+    CorrectForOrientationTypes::DataFlags rhs) {
+  return static_cast<CorrectForOrientationTypes::DataFlags>(
+      static_cast<int>(lhs) | static_cast<int>(rhs));
 }
 
-CorrectForOrientation::CorrectForOrientation(
+template <typename Base>
+BasicCorrectForOrientation<Base>::BasicCorrectForOrientation(
     core::DeviceListenerWrapper& parent_feature, DataFlags flags)
     : flags_(flags), last_quat_(0, 0, 0, 1) {
   parent_feature.addChildFeature(this);
 }
 
-void CorrectForOrientation::onOrientationData(
+template <typename Base>
+core::EventMask BasicCorrectForOrientation<Base>::handledEvents() const {
+  return core::EventBit(core::Event::OrientationData);
+}
+
+template <typename Base>
+void BasicCorrectForOrientation<Base>::onOrientationData(
     myo::Myo* myo, uint64_t timestamp, const myo::Quaternion<float>& quat) {
   last_quat_ = quat;
-  core::DeviceListenerWrapper::onOrientationData(myo, timestamp, quat);
+  Base::onOrientationData(myo, timestamp, quat);
 }
 
-void CorrectForOrientation::onAccelerometerData(
+template <typename Base>
+void BasicCorrectForOrientation<Base>::onAccelerometerData(
     myo::Myo* myo, uint64_t timestamp, const myo::Vector3<float>& accel) {
   if (flags_ & AccelerometerData) {
     auto rotated = rotate(last_quat_, accel);
-    core::DeviceListenerWrapper::onAccelerometerData(myo, timestamp, rotated);
+    Base::onAccelerometerData(myo, timestamp, rotated);
   } else {
-    core::DeviceListenerWrapper::onAccelerometerData(myo, timestamp, accel);
+    Base::onAccelerometerData(myo, timestamp, accel);
   }
 }
 
-void CorrectForOrientation::onGyroscopeData(myo::Myo* myo, uint64_t timestamp,
-                                            const myo::Vector3<float>& gyro) {
+template <typename Base>
+void BasicCorrectForOrientation<Base>::onGyroscopeData(
+    myo::Myo* myo, uint64_t timestamp, const myo::Vector3<float>& gyro) {
   if (flags_ & GyroscopeData) {
     auto rotated = rotate(last_quat_, gyro);
-    core::DeviceListenerWrapper::onGyroscopeData(myo, timestamp, rotated);
+    Base::onGyroscopeData(myo, timestamp, rotated);
   } else {
-    core::DeviceListenerWrapper::onGyroscopeData(myo, timestamp, gyro);
+    Base::onGyroscopeData(myo, timestamp, gyro);
+  }
+}
+
+template <typename Base>
+void BasicCorrectForOrientation<Base>::onOrientationDataBatch(
+    myo::Myo* myo, const core::OrientationBatch& batch) {
+  if (batch.size > 0) {
+    last_quat_ = batch.samples[batch.size - 1];
+  }
+  Base::forwardOrientationDataBatch(myo, batch);
+}
+
+template <typename Base>
+void BasicCorrectForOrientation<Base>::onAccelerometerDataBatch(
+    myo::Myo* myo, const core::VectorBatch& batch) {
+  if (flags_ & AccelerometerData) {
+    Base::forwardAccelerometerDataBatch(myo,
+                                        batch.withSamples(rotateBatch(batch)));
+  } else {
+    Base::forwardAccelerometerDataBatch(myo, batch);
+  }
+}
+
+template <typename Base>
+void BasicCorrectForOrientation<Base>::onGyroscopeDataBatch(
+    myo::Myo* myo, const core::VectorBatch& batch) {
+  if (flags_ & GyroscopeData) {
+    Base::forwardGyroscopeDataBatch(myo,
+                                    batch.withSamples(rotateBatch(batch)));
+  } else {
+    Base::forwardGyroscopeDataBatch(myo, batch);
+  }
+}
+
+template <typename Base>
+const myo::Vector3<float>* BasicCorrectForOrientation<Base>::rotateBatch(
+    const core::VectorBatch& batch) {
+  rotated_batch_.clear();
+  for (std::size_t i = 0; i < batch.size; ++i) {
+    rotated_batch_.push_back(myo::rotate(last_quat_, batch.samples[i]));
   }
+  return rotated_batch_.data();
 }
 }
@@ -0,0 +1,187 @@
+/* Computes the classic time domain features of the EMG data over a sliding
+ * window of samples, for classifiers of muscle activity. Once the window is
+ * full, and then every hop samples, the features of the last window_size
+ * samples are passed on to child features with onEmgFeatures (see
+ * core/EmgFeatures.h). The EMG data is passed on unchanged.
+ *
+ * The features are kept up to date in constant time per sample: every sample
+ * adds its own terms to running sums, and subtracts the terms of the sample
+ * which leaves the window. The waveform length, zero crossings and slope sign
+ * changes of a sample are counted against the samples before it, even if those
+ * have left the window. Differences smaller than threshold are not counted as
+ * zero crossings or slope sign changes, so that noise around 0 is ignored.
+ *
+ * Usually the EMG data is filtered first, e.g. with filters::EmgFilter.
+ */
+
+#pragma once
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <myo/myo.hpp>
+#include <vector>
+
+#include "../core/DeviceListenerWrapper.h"
+#include "../core/EmgFeatures.h"
+#include "../core/SampleBatch.h"
+
+namespace features {
+template <typename Base = core::DeviceListenerWrapper>
+class BasicEmgFeatureExtractor : public Base {
+ public:
+  // window_size and hop must be at least 1.
+  BasicEmgFeatureExtractor(core::DeviceListenerWrapper& parent_feature,
+                           std::size_t window_size, std::size_t hop,
+                           int threshold = 0);
+
+  virtual core::EventMask handledEvents() const override;
+  virtual core::EventMask subscribedEvents() override;
+
+  virtual void onEmgData(myo::Myo* myo, uint64_t timestamp,
+                         const int8_t* emg) override;
+
+ private:
+  // One sample's terms of the running sums.
+  struct Terms {
+    core::EmgSample emg;
+    std::array<uint8_t, 8> difference;
+    // One bit per channel.
+    uint8_t zero_crossings;
+    uint8_t slope_sign_changes;
+  };
+
+  void addSample(const int8_t* emg);
+  void updateFeatures();
+
+  const int threshold_;
+  const std::size_t hop_;
+  // The terms of the samples in the window, oldest first from position_.
+  std::vector<Terms> window_;
+  std::size_t position_;
+  std::size_t num_samples_;
+  // Starts at hop_, so that the features are sent as soon as the window is
+  // full even if hop_ is longer than the window.
+  std::size_t samples_since_features_;
+  // The two samples before the newest, for the differences and slopes.
+  core::EmgSample previous_;
+  core::EmgSample before_previous_;
+
+  std::array<int32_t, 8> sum_absolute_;
+  std::array<int32_t, 8> sum_squares_;
+  core::EmgFeatures features_;
+};
+
+typedef BasicEmgFeatureExtractor<> EmgFeatureExtractor;
+
+template <typename Base>
+BasicEmgFeatureExtractor<Base>::BasicEmgFeatureExtractor(
+    core::DeviceListenerWrapper& parent_feature, std::size_t window_size,
+    std::size_t hop, int threshold)
+    : threshold_(threshold),
+      hop_(hop),
+      window_(window_size, Terms()),
+      position_(0),
+      num_samples_(0),
+      samples_since_features_(hop),
+      previous_(),
+      before_previous_(),
+      sum_absolute_(),
+      sum_squares_(),
+      features_() {
+  features_.window_size = window_size;
+  parent_feature.addChildFeature(this);
+}
+
+template <typename Base>
+core::EventMask BasicEmgFeatureExtractor<Base>::handledEvents() const {
+  return core::NoEvents;
+}
+
+// The features are made from the EMG data, so a child which only wants the
+// features still needs the EMG data to be sent to this feature.
+template <typename Base>
+core::EventMask BasicEmgFeatureExtractor<Base>::subscribedEvents() {
+  core::EventMask events = Base::subscribedEvents();
+  if (events & core::EventBit(core::Event::EmgFeatures)) {
+    events |= core::EventBit(core::Event::EmgData);
+  }
+  return events;
+}
+
+template <typename Base>
+void BasicEmgFeatureExtractor<Base>::onEmgData(myo::Myo* myo,
+                                               uint64_t timestamp,
+                                               const int8_t* emg) {
+  addSample(emg);
+  Base::onEmgData(myo, timestamp, emg);
+  if (num_samples_ >= window_.size() && samples_since_features_ >= hop_) {
+    samples_since_features_ = 0;
+    updateFeatures();
+    Base::onEmgFeatures(myo, timestamp, features_);
+  }
+}
+
+// Every term of the new sample is computed and swapped for the oldest
+// sample's in a single pass over the channels.
+template <typename Base>
+void BasicEmgFeatureExtractor<Base>::addSample(const int8_t* emg) {
+  Terms& terms = window_[position_];
+  const bool full = num_samples_ >= window_.size();
+  const bool has_previous = num_samples_ > 0;
+  const bool has_slope = num_samples_ > 1;
+  uint8_t zero_crossings = 0, slope_sign_changes = 0;
+  for (int i = 0; i < 8; ++i) {
+    const int x = emg[i];
+    if (full) {
+      const int old_x = terms.emg[i];
+      sum_absolute_[i] -= std::abs(old_x);
+      sum_squares_[i] -= old_x * old_x;
+      features_.waveform_length[i] -= terms.difference[i];
+      features_.zero_crossings[i] -= (terms.zero_crossings >> i) & 1;
+      features_.slope_sign_changes[i] -= (terms.slope_sign_changes >> i) & 1;
+    }
+    const int previous = previous_[i];
+    const int difference = has_previous ? x - previous : 0;
+    const bool crosses_zero =
+        has_previous && ((previous > 0 && x < 0) || (previous < 0 && x > 0)) &&
+        std::abs(difference) >= threshold_;
+    // The slope changes sign at the previous sample.
+    const int previous_difference = previous - before_previous_[i];
+    const bool changes_slope =
+        has_slope && previous_difference * -difference > 0 &&
+        (std::abs(previous_difference) >= threshold_ ||
+         std::abs(difference) >= threshold_);
+
+    terms.emg[i] = emg[i];
+    terms.difference[i] = static_cast<uint8_t>(std::abs(difference));
+    zero_crossings |= crosses_zero << i;
+    slope_sign_changes |= changes_slope << i;
+    sum_absolute_[i] += std::abs(x);
+    sum_squares_[i] += x * x;
+    features_.waveform_length[i] += terms.difference[i];
+    features_.zero_crossings[i] += crosses_zero;
+    features_.slope_sign_changes[i] += changes_slope;
+
+    before_previous_[i] = previous_[i];
+    previous_[i] = emg[i];
+  }
+  terms.zero_crossings = zero_crossings;
+  terms.slope_sign_changes = slope_sign_changes;
+
+  position_ = position_ + 1 == window_.size() ? 0 : position_ + 1;
+  ++num_samples_;
+  ++samples_since_features_;
+}
+
+template <typename Base>
+void BasicEmgFeatureExtractor<Base>::updateFeatures() {
+  const float size = static_cast<float>(window_.size());
+  for (int i = 0; i < 8; ++i) {
+    features_.mean_absolute_value[i] = sum_absolute_[i] / size;
+    features_.root_mean_square[i] = std::sqrt(sum_squares_[i] / size);
+  }
+}
+}
@@ -0,0 +1,224 @@
+/* LatencyTracer measures the end-to-end latency of the poses and gestures it
+ * receives: the time from when the Myo event which caused each of them arrived
+ * at the root feature until it reached the tracer. Features pass the timestamp
+ * of the causing event on with every pose and gesture they emit, so a tracer
+ * placed at a leaf of the tree includes the time spent in every feature above
+ * it, and the time that features such as Debounce deliberately wait.
+ *
+ *   features::LatencyTracer tracer(pose_gestures, root_feature.deviceClock());
+ *   // ...
+ *   tracer.writeReport(std::cout);
+ *
+ * Arrival times are estimated by the device clock, see Clock.h. The latencies
+ * of each type of pose or gesture are counted in a core::LatencyHistogram, so
+ * recording one does not allocate and the percentiles are upper bounds, within
+ * a factor of two. Gestures are told apart by their pose as well, e.g.
+ * "hold: fist". Events are passed on to child features unchanged.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <myo/myo.hpp>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "../core/Clock.h"
+#include "../core/DeviceListenerWrapper.h"
+#include "../core/Gesture.h"
+#include "../core/LatencyHistogram.h"
+#include "../core/Pose.h"
+
+namespace features {
+class LatencyTracerTypes {
+ public:
+  // Latencies of one type of pose or gesture, in microseconds. The percentiles
+  // are upper bounds and max_us is exact.
+  struct LatencySummary {
+    std::string name;
+    uint64_t count;
+    uint64_t p50_us;
+    uint64_t p99_us;
+    uint64_t max_us;
+  };
+};
+
+template <typename Base = core::DeviceListenerWrapper>
+class BasicLatencyTracer : public Base, public LatencyTracerTypes {
+ public:
+  // device_clock must be the device clock of the root feature of the tree and
+  // host_clock the clock on which latency is measured.
+  BasicLatencyTracer(core::DeviceListenerWrapper& parent_feature,
+                     core::DeviceClock& device_clock,
+                     const core::Clock& host_clock =
+                         core::WallClock::instance());
+
+  virtual core::EventMask handledEvents() const override;
+
+  virtual void onPose(myo::Myo* myo, uint64_t timestamp,
+                      const std::shared_ptr<core::Pose>& pose) override;
+  virtual void onGesture(
+      myo::Myo* myo, uint64_t timestamp,
+      const std::shared_ptr<core::Gesture>& gesture) override;
+
+  // One summary per type of pose or gesture received, ordered by name.
+  std::vector<LatencySummary> poseLatencies() const;
+  std::vector<LatencySummary> gestureLatencies() const;
+  void writeReport(std::ostream& out) const;
+  void reset();
+
+ private:
+  struct Series {
+    Series() : max_us(0) {}
+
+    std::string name;
+    core::LatencyHistogram latencies_us;
+    uint64_t max_us;
+  };
+  typedef std::map<uint32_t, Series> SeriesMap;
+
+  // Adds the latency of an event with the given timestamp, which arrived
+  // now. Item is the pose or gesture, whose name is only built once.
+  template <typename Item>
+  void record(SeriesMap& series_map, const Item& item, uint64_t timestamp);
+  static uint32_t seriesKey(const core::Pose& pose);
+  static uint32_t seriesKey(const core::Gesture& gesture);
+  static std::string seriesName(const core::Pose& pose);
+  static std::string seriesName(const core::Gesture& gesture);
+  static std::vector<LatencySummary> summarize(const SeriesMap& series_map);
+
+  const core::DeviceClock& device_clock_;
+  const core::Clock& host_clock_;
+  // Keyed by pose id, and by gesture and pose id.
+  SeriesMap poses_, gestures_;
+};
+
+typedef BasicLatencyTracer<> LatencyTracer;
+
+template <typename Base>
+BasicLatencyTracer<Base>::BasicLatencyTracer(
+    core::DeviceListenerWrapper& parent_feature,
+    core::DeviceClock& device_clock, const core::Clock& host_clock)
+    : device_clock_(device_clock), host_clock_(host_clock) {
+  device_clock.trackHostTime(host_clock);
+  parent_feature.addChildFeature(this);
+}
+
+template <typename Base>
+core::EventMask BasicLatencyTracer<Base>::handledEvents() const {
+  return core::EventBit(core::Event::Pose) |
+         core::EventBit(core::Event::Gesture);
+}
+
+template <typename Base>
+void BasicLatencyTracer<Base>::onPose(
+    myo::Myo* myo, uint64_t timestamp,
+    const std::shared_ptr<core::Pose>& pose) {
+  record(poses_, *pose, timestamp);
+  Base::onPose(myo, timestamp, pose);
+}
+
+template <typename Base>
+void BasicLatencyTracer<Base>::onGesture(
+    myo::Myo* myo, uint64_t timestamp,
+    const std::shared_ptr<core::Gesture>& gesture) {
+  record(gestures_, *gesture, timestamp);
+  Base::onGesture(myo, timestamp, gesture);
+}
+
+template <typename Base>
+std::vector<LatencyTracerTypes::LatencySummary>
+BasicLatencyTracer<Base>::poseLatencies() const {
+  return summarize(poses_);
+}
+
+template <typename Base>
+std::vector<LatencyTracerTypes::LatencySummary>
+BasicLatencyTracer<Base>::gestureLatencies() const {
+  return summarize(gestures_);
+}
+
+template <typename Base>
+void BasicLatencyTracer<Base>::writeReport(std::ostream& out) const {
+  auto write = [&out](const char* kind,
+                      const std::vector<LatencySummary>& summaries) {
+    for (const LatencySummary& summary : summaries) {
+      out << kind << " " << summary.name << " count=" << summary.count
+          << " p50_us=" << summary.p50_us << " p99_us=" << summary.p99_us
+          << " max_us=" << summary.max_us << "\n";
+    }
+  };
+  write("pose", poseLatencies());
+  write("gesture", gestureLatencies());
+}
+
+template <typename Base>
+void BasicLatencyTracer<Base>::reset() {
+  poses_.clear();
+  gestures_.clear();
+}
+
+template <typename Base>
+template <typename Item>
+void BasicLatencyTracer<Base>::record(SeriesMap& series_map, const Item& item,
+                                      uint64_t timestamp) {
+  Series& series = series_map[seriesKey(item)];
+  if (series.name.empty()) {
+    series.name = seriesName(item);
+  }
+  uint64_t now = host_clock_.now();
+  uint64_t arrival = device_clock_.hostTime(timestamp);
+  uint64_t latency_us = now > arrival ? now - arrival : 0;
+  series.latencies_us.add(latency_us);
+  series.max_us = std::max(series.max_us, latency_us);
+}
+
+template <typename Base>
+uint32_t BasicLatencyTracer<Base>::seriesKey(const core::Pose& pose) {
+  return pose.id();
+}
+
+// The id of a gesture, e.g. hold, does not say which pose was held.
+template <typename Base>
+uint32_t BasicLatencyTracer<Base>::seriesKey(const core::Gesture& gesture) {
+  const std::shared_ptr<core::Pose>& pose = gesture.AssociatedPose();
+  return (uint32_t(gesture.id()) << 16) | (pose ? pose->id() : 0);
+}
+
+template <typename Base>
+std::string BasicLatencyTracer<Base>::seriesName(const core::Pose& pose) {
+  return pose.toString();
+}
+
+template <typename Base>
+std::string BasicLatencyTracer<Base>::seriesName(
+    const core::Gesture& gesture) {
+  return gesture.AssociatedPose() ? gesture.toDescriptiveString()
+                                  : gesture.toString();
+}
+
+template <typename Base>
+std::vector<LatencyTracerTypes::LatencySummary>
+BasicLatencyTracer<Base>::summarize(const SeriesMap& series_map) {
+  std::vector<LatencySummary> summaries;
+  for (const auto& id_series : series_map) {
+    const Series& series = id_series.second;
+    // The upper bound of a bucket may be above the largest latency in it.
+    auto percentile = [&series](double fraction) {
+      return std::min(series.latencies_us.percentile(fraction), series.max_us);
+    };
+    summaries.push_back(LatencySummary{series.name, series.latencies_us.count(),
+                                       percentile(0.5), percentile(0.99),
+                                       series.max_us});
+  }
+  std::sort(summaries.begin(), summaries.end(),
+            [](const LatencySummary& lhs, const LatencySummary& rhs) {
+              return lhs.name < rhs.name;
+            });
+  return summaries;
+}
+}
@@ -1,9 +1,15 @@
 /* Provides an easy interface for determining the basic orientation of the
  * user's arm and wrist.
+ *
+ * The roll and pitch of the calibrated position are calculated once, when it
+ * is calibrated. Each angle relative to it is calculated at most once per
+ * orientation sample, the first time a getter needs it, so that features such
+ * as OrientationPoses can call the getters for every event.
  */
 
 #pragma once
 
+#include <boost/optional.hpp>
 #include <myo/myo.hpp>
 
 #include "../core/DeviceListenerWrapper.h"
@@ -17,6 +23,8 @@ class Orientation : public core::DeviceListenerWrapper {
 
   Orientation(core::DeviceListenerWrapper& parent_feature);
 
+  virtual core::EventMask handledEvents() const override;
+
   virtual void onOrientationData(
       myo::Myo* myo, uint64_t timestamp,
       const myo::Quaternion<float>& rotation) override;
@@ -34,7 +42,11 @@ class Orientation : public core::DeviceListenerWrapper {
   Wrist getWristOrientation() const;
 
  private:
-  myo::Quaternion<float> rotation_, mid_;
+  myo::Quaternion<float> rotation_;
+  float mid_roll_, mid_pitch_;
+  // Relative to the calibrated position, or none if there has been a sample or
+  // a calibration since they were last calculated.
+  mutable boost::optional<float> relative_roll_, relative_pitch_;
   Arm arm_orientation_a, arm_orientation_b;
   Wrist wrist_orientation_a, wrist_orientation_b;
 
@@ -51,7 +63,10 @@ const float Orientation::maxWristAngle = 0.3;
 
 Orientation::Orientation(core::DeviceListenerWrapper& parent_feature)
     : rotation_(),
-      mid_(),
+      mid_roll_(core::OrientationUtility::QuaternionToRoll(rotation_)),
+      mid_pitch_(core::OrientationUtility::QuaternionToPitch(rotation_)),
+      relative_roll_(),
+      relative_pitch_(),
       arm_orientation_a(Arm::forearmUp),
       arm_orientation_b(Arm::forearmDown),
       wrist_orientation_a(Wrist::palmDown),
@@ -59,9 +74,16 @@ Orientation::Orientation(core::DeviceListenerWrapper& parent_feature)
   parent_feature.addChildFeature(this);
 }
 
+core::EventMask Orientation::handledEvents() const {
+  return core::EventBit(core::Event::OrientationData) |
+         core::EventBit(core::Event::ArmSync);
+}
+
 void Orientation::onOrientationData(myo::Myo* myo, uint64_t timestamp,
                                     const myo::Quaternion<float>& rotation) {
   rotation_ = rotation;
+  relative_roll_ = boost::none;
+  relative_pitch_ = boost::none;
   core::DeviceListenerWrapper::onOrientationData(myo, timestamp, rotation);
 }
 
@@ -77,23 +99,33 @@ void Orientation::onArmSync(myo::Myo* myo, uint64_t timestamp, myo::Arm arm,
   core::DeviceListenerWrapper::onArmSync(myo, timestamp, arm, x_direction);
 }
 
-void Orientation::calibrateOrientation() { mid_ = rotation_; }
+void Orientation::calibrateOrientation() {
+  mid_roll_ = core::OrientationUtility::QuaternionToRoll(rotation_);
+  mid_pitch_ = core::OrientationUtility::QuaternionToPitch(rotation_);
+  relative_roll_ = boost::none;
+  relative_pitch_ = boost::none;
+}
 
 float Orientation::getRelativeArmAngle() const {
-  return core::OrientationUtility::RelativeOrientation(
-      mid_, rotation_, core::OrientationUtility::QuaternionToPitch);
+  if (!relative_pitch_) {
+    relative_pitch_ = core::OrientationUtility::RelativeOrientation(
+        mid_pitch_, core::OrientationUtility::QuaternionToPitch(rotation_));
+  }
+  return relative_pitch_.get();
 }
 
 // TODO: add a multiplier because your forearm only rotates a fraction of the
 // angle your wrist rotates.
 float Orientation::getRelativeWristAngle() const {
-  return core::OrientationUtility::RelativeOrientation(
-      mid_, rotation_, core::OrientationUtility::QuaternionToRoll);
+  if (!relative_roll_) {
+    relative_roll_ = core::OrientationUtility::RelativeOrientation(
+        mid_roll_, core::OrientationUtility::QuaternionToRoll(rotation_));
+  }
+  return relative_roll_.get();
 }
 
 Orientation::Arm Orientation::getArmOrientation() const {
-  float pitch_diff = core::OrientationUtility::RelativeOrientation(
-      mid_, rotation_, core::OrientationUtility::QuaternionToPitch);
+  float pitch_diff = getRelativeArmAngle();
   if (pitch_diff < minArmAngle) {
     return arm_orientation_a;
   } else if (pitch_diff > maxArmAngle) {
@@ -104,8 +136,7 @@ Orientation::Arm Orientation::getArmOrientation() const {
 }
 
 Orientation::Wrist Orientation::getWristOrientation() const {
-  float roll_diff = core::OrientationUtility::RelativeOrientation(
-      mid_, rotation_, core::OrientationUtility::QuaternionToRoll);
+  float roll_diff = getRelativeWristAngle();
   if (roll_diff < minWristAngle) {
     return wrist_orientation_a;
   } else if (roll_diff > maxWristAngle) {
@@ -6,6 +6,8 @@
 
 #pragma once
 
+#include <array>
+#include <memory>
 #include <myo/myo.hpp>
 #include <string>
 
@@ -14,7 +16,9 @@
 #include "Orientation.h"
 
 namespace features {
-class OrientationPoses : public core::DeviceListenerWrapper {
+// The pose type does not depend on BasicOrientationPoses's base class, so it
+// lives in a separate class to be shared by every instantiation.
+class OrientationPosesTypes {
  public:
   class Pose : public core::Pose {
    public:
@@ -26,12 +30,24 @@ class OrientationPoses : public core::DeviceListenerWrapper {
 
     virtual std::string toString() const override;
 
+    // Returns a shared instance of the pose, see core::Pose::interned.
+    static const std::shared_ptr<core::Pose>& interned(Type type);
+
    private:
+    // The first of the ids reserved for waveUp and waveDown.
+    static Id FirstId();
+
     const Type type_;
   };
+};
+
+template <typename Base = core::DeviceListenerWrapper>
+class BasicOrientationPoses : public Base, public OrientationPosesTypes {
+ public:
+  BasicOrientationPoses(core::DeviceListenerWrapper& parent_feature,
+                        Orientation& orientation);
 
-  OrientationPoses(core::DeviceListenerWrapper& parent_feature,
-                   Orientation& orientation);
+  virtual core::EventMask handledEvents() const override;
 
   virtual void onPose(myo::Myo* myo, uint64_t timestamp,
                       const std::shared_ptr<core::Pose>& pose) override;
@@ -40,15 +56,21 @@ class OrientationPoses : public core::DeviceListenerWrapper {
   Orientation& orientation_;
 };
 
-OrientationPoses::Pose::Pose(Type type) : core::Pose(), type_(type) {}
+typedef BasicOrientationPoses<> OrientationPoses;
+
+OrientationPosesTypes::Pose::Pose(Type type) : core::Pose(), type_(type) {
+  if (type_ != unknown) {
+    setId(FirstId() + type_);
+  }
+}
 
-OrientationPoses::Pose::Pose(core::Pose::Type type)
+OrientationPosesTypes::Pose::Pose(core::Pose::Type type)
     : core::Pose(type), type_(unknown) {}
 
-OrientationPoses::Pose::Pose(const core::Pose& pose)
+OrientationPosesTypes::Pose::Pose(const core::Pose& pose)
     : core::Pose(pose), type_(unknown) {}
 
-std::string OrientationPoses::Pose::toString() const {
+std::string OrientationPosesTypes::Pose::toString() const {
   switch (type_) {
     case waveUp:
       return "waveUp";
@@ -59,57 +81,72 @@ std::string OrientationPoses::Pose::toString() const {
   }
 }
 
-bool operator==(const OrientationPoses::Pose& lhs,
-                OrientationPoses::Pose::Type rhs) {
-  return lhs == OrientationPoses::Pose(rhs);
+OrientationPosesTypes::Pose::Id OrientationPosesTypes::Pose::FirstId() {
+  static const Id first_id = ReserveIds(unknown);
+  return first_id;
 }
 
-bool operator!=(const OrientationPoses::Pose& lhs,
-                OrientationPoses::Pose::Type rhs) {
-  return lhs != OrientationPoses::Pose(rhs);
+const std::shared_ptr<core::Pose>& OrientationPosesTypes::Pose::interned(
+    Type type) {
+  static const std::array<std::shared_ptr<core::Pose>, unknown + 1> poses = {
+      {std::make_shared<Pose>(waveUp), std::make_shared<Pose>(waveDown),
+       std::make_shared<Pose>(unknown)}};
+  return poses[type];
 }
 
-OrientationPoses::OrientationPoses(core::DeviceListenerWrapper& parent_feature,
-                                   Orientation& orientation)
+bool operator==(const OrientationPosesTypes::Pose& lhs,
+                OrientationPosesTypes::Pose::Type rhs) {
+  return lhs == OrientationPosesTypes::Pose(rhs);
+}
+
+bool operator!=(const OrientationPosesTypes::Pose& lhs,
+                OrientationPosesTypes::Pose::Type rhs) {
+  return lhs != OrientationPosesTypes::Pose(rhs);
+}
+
+template <typename Base>
+BasicOrientationPoses<Base>::BasicOrientationPoses(
+    core::DeviceListenerWrapper& parent_feature, Orientation& orientation)
     : orientation_(orientation) {
   parent_feature.addChildFeature(this);
 }
 
-void OrientationPoses::onPose(myo::Myo* myo, uint64_t timestamp,
-                              const std::shared_ptr<core::Pose>& pose) {
+template <typename Base>
+core::EventMask BasicOrientationPoses<Base>::handledEvents() const {
+  return core::NoEvents;
+}
+
+template <typename Base>
+void BasicOrientationPoses<Base>::onPose(
+    myo::Myo* myo, uint64_t timestamp,
+    const std::shared_ptr<core::Pose>& pose) {
   Orientation::Wrist wrist_orientation = orientation_.getWristOrientation();
   if (*pose == core::Pose::waveIn) {
-    std::shared_ptr<core::Pose> new_pose;
     switch (wrist_orientation) {
       case Orientation::Wrist::palmDown:
-        new_pose.reset(new Pose(Pose::waveDown));
+        Base::onPose(myo, timestamp, Pose::interned(Pose::waveDown));
         break;
       case Orientation::Wrist::palmUp:
-        new_pose.reset(new Pose(Pose::waveUp));
+        Base::onPose(myo, timestamp, Pose::interned(Pose::waveUp));
         break;
       default:
-        core::DeviceListenerWrapper::onPose(myo, 0, pose);
-        // Return so that no other poses are emitted.
-        return;
+        Base::onPose(myo, timestamp, pose);
+        break;
     }
-    core::DeviceListenerWrapper::onPose(myo, 0, new_pose);
   } else if (*pose == core::Pose::waveOut) {
-    std::shared_ptr<core::Pose> new_pose;
     switch (wrist_orientation) {
       case Orientation::Wrist::palmDown:
-        new_pose.reset(new Pose(Pose::waveUp));
+        Base::onPose(myo, timestamp, Pose::interned(Pose::waveUp));
         break;
       case Orientation::Wrist::palmUp:
-        new_pose.reset(new Pose(Pose::waveDown));
+        Base::onPose(myo, timestamp, Pose::interned(Pose::waveDown));
         break;
       default:
-        core::DeviceListenerWrapper::onPose(myo, 0, pose);
-        // Return so that no other poses are emitted.
-        return;
+        Base::onPose(myo, timestamp, pose);
+        break;
     }
-    core::DeviceListenerWrapper::onPose(myo, 0, new_pose);
   } else {
-    core::DeviceListenerWrapper::onPose(myo, 0, pose);
+    Base::onPose(myo, timestamp, pose);
   }
 }
 }
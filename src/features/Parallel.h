@@ -0,0 +1,522 @@
+/* Parallel passes events on to its child features on a core::ThreadPool, so
+ * that sibling subtrees run at the same time instead of one after the other.
+ * Each child feature receives its events in order and one at a time, but
+ * different children may run concurrently on different threads. onX returns
+ * as soon as the event is queued for every child.
+ *
+ *   core::ThreadPool pool;
+ *   features::Parallel parallel(root_feature, pool);
+ *   features::filters::Debounce debounce(parallel);
+ *   features::filters::MovingAverage moving_average(parallel, ...);
+ *
+ * Only use Parallel for subtrees which share no state with each other or with
+ * the rest of the tree, which includes the root feature's device clock. Child
+ * features which do share state, e.g. OrientationPoses reading an Orientation
+ * in another subtree, must be declared with shareState so that they are run on
+ * the same thread.
+ *
+ * A batch is copied once and passed on whole, as one task for each child.
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <myo/myo.hpp>
+#include <vector>
+
+#include "../core/DeviceListenerWrapper.h"
+#include "../core/Gesture.h"
+#include "../core/Pose.h"
+#include "../core/SampleBatch.h"
+#include "../core/ThreadPool.h"
+#include "../replay/Record.h"
+
+namespace features {
+class Parallel : public core::DeviceListenerWrapper {
+ public:
+  // pool must outlive this feature.
+  Parallel(core::DeviceListenerWrapper& parent_feature, core::ThreadPool& pool);
+  // Calls wait().
+  virtual ~Parallel();
+
+  // Runs the child features a and b, and any others which share state with
+  // them, one at a time. Call this before any event is sent.
+  void shareState(child_feature_t a, child_feature_t b);
+  // Blocks until every event sent so far has been passed on.
+  void wait();
+
+  virtual void onPair(myo::Myo* myo, uint64_t timestamp,
+                      myo::FirmwareVersion firmware_version) override;
+  virtual void onUnpair(myo::Myo* myo, uint64_t timestamp) override;
+  virtual void onConnect(myo::Myo* myo, uint64_t timestamp,
+                         myo::FirmwareVersion firmware_version) override;
+  virtual void onDisconnect(myo::Myo* myo, uint64_t timestamp) override;
+  virtual void onArmSync(myo::Myo* myo, uint64_t timestamp, myo::Arm arm,
+                         myo::XDirection x_direction) override;
+  virtual void onArmUnsync(myo::Myo* myo, uint64_t timestamp) override;
+  virtual void onUnlock(myo::Myo* myo, uint64_t timestamp) override;
+  virtual void onLock(myo::Myo* myo, uint64_t timestamp) override;
+  virtual void onPose(myo::Myo* myo, uint64_t timestamp,
+                      const std::shared_ptr<core::Pose>& pose) override;
+  virtual void onGesture(
+      myo::Myo* myo, uint64_t timestamp,
+      const std::shared_ptr<core::Gesture>& gesture) override;
+  virtual void onOrientationData(
+      myo::Myo* myo, uint64_t timestamp,
+      const myo::Quaternion<float>& rotation) override;
+  virtual void onAccelerometerData(
+      myo::Myo* myo, uint64_t timestamp,
+      const myo::Vector3<float>& acceleration) override;
+  virtual void onGyroscopeData(myo::Myo* myo, uint64_t timestamp,
+                               const myo::Vector3<float>& gyro) override;
+  virtual void onRssi(myo::Myo* myo, uint64_t timestamp, int8_t rssi) override;
+  virtual void onEmgData(myo::Myo* myo, uint64_t timestamp,
+                         const int8_t* emg) override;
+  virtual void onPeriodic(myo::Myo* myo) override;
+  virtual void onEmgEnvelope(myo::Myo* myo, uint64_t timestamp,
+                             const int16_t* envelope) override;
+  virtual void onEmgFeatures(myo::Myo* myo, uint64_t timestamp,
+                             const core::EmgFeatures& features) override;
+  virtual void onOrientationDataBatch(
+      myo::Myo* myo, const core::OrientationBatch& batch) override;
+  virtual void onAccelerometerDataBatch(
+      myo::Myo* myo, const core::VectorBatch& batch) override;
+  virtual void onGyroscopeDataBatch(myo::Myo* myo,
+                                    const core::VectorBatch& batch) override;
+  virtual void onEmgDataBatch(myo::Myo* myo,
+                              const core::EmgBatch& batch) override;
+
+ protected:
+  // Resolves the strand of every child which subscribes to each event.
+  virtual core::EventMask linkedChildEvents() override;
+
+ private:
+  // A batch which owns its samples, shared by every child's task.
+  template <typename Sample>
+  struct BatchCopy {
+    explicit BatchCopy(const core::SampleBatch<Sample>& batch)
+        : timestamps(batch.timestamps, batch.timestamps + batch.size),
+          samples(batch.samples, batch.samples + batch.size) {}
+    core::SampleBatch<Sample> batch() const {
+      return core::SampleBatch<Sample>(timestamps.data(), samples.data(),
+                                       samples.size());
+    }
+
+    std::vector<uint64_t> timestamps;
+    std::vector<Sample> samples;
+  };
+
+  // One event for one child feature. The event's arguments are kept in a
+  // record, apart from poses and gestures which are shared and EMG features
+  // and batches which do not fit in a record. A task with a batch is for the
+  // whole batch instead of the sample in the record.
+  struct Task {
+    child_feature_t feature;
+    myo::Myo* myo;
+    replay::Record record;
+    std::shared_ptr<core::Pose> pose;
+    std::shared_ptr<core::Gesture> gesture;
+    std::shared_ptr<const core::EmgFeatures> emg_features;
+    std::shared_ptr<const BatchCopy<myo::Quaternion<float>>> orientation_batch;
+    std::shared_ptr<const BatchCopy<myo::Vector3<float>>> vector_batch;
+    std::shared_ptr<const BatchCopy<core::EmgSample>> emg_batch;
+  };
+
+  // Runs the tasks posted to it in order, on at most one thread at a time.
+  struct Strand {
+    Strand() : scheduled(false) {}
+
+    std::mutex mutex;
+    // Posted but not yet running. The tasks are swapped into running so that
+    // both keep their capacity and posting does not allocate.
+    std::vector<Task> pending, running;
+    // Whether a task which drains the strand is in the pool.
+    bool scheduled;
+  };
+
+  // A child feature which subscribes to an event, and its strand.
+  struct ChildStrand {
+    child_feature_t feature;
+    Strand* strand;
+  };
+
+  // A record for poses, gestures, EMG features and batches, whose arguments
+  // are kept in the task.
+  static replay::Record eventRecord(core::Event::Type type,
+                                    uint64_t timestamp);
+  static void run(const Task& task);
+
+  // Posts the event to every child which subscribes to it.
+  void post(const replay::Record& record, myo::Myo* myo,
+            const std::shared_ptr<core::Pose>& pose = nullptr,
+            const std::shared_ptr<core::Gesture>& gesture = nullptr,
+            const std::shared_ptr<const core::EmgFeatures>& emg_features =
+                nullptr);
+  // Posts a copy of task to every child which subscribes to its event.
+  void post(Task task);
+  Strand& strandFor(child_feature_t feature);
+  void drain(Strand& strand);
+
+  core::ThreadPool& pool_;
+  std::map<child_feature_t, std::shared_ptr<Strand>> strands_;
+  // The children which subscribe to each event, with their strands. Rebuilt
+  // along with the subscriptions, so posting an event looks nothing up.
+  std::array<std::vector<ChildStrand>, core::Event::NumTypes>
+      event_child_strands_;
+
+  // Tasks posted but not yet run.
+  std::atomic<std::size_t> pending_tasks_;
+  std::mutex idle_mutex_;
+  std::condition_variable idle_;
+};
+
+Parallel::Parallel(core::DeviceListenerWrapper& parent_feature,
+                   core::ThreadPool& pool)
+    : pool_(pool), pending_tasks_(0) {
+  parent_feature.addChildFeature(this);
+}
+
+Parallel::~Parallel() { wait(); }
+
+void Parallel::shareState(child_feature_t a, child_feature_t b) {
+  std::shared_ptr<Strand> a_strand = strands_[a];
+  std::shared_ptr<Strand> b_strand = strands_[b];
+  if (!a_strand) {
+    a_strand = b_strand ? b_strand : std::make_shared<Strand>();
+  }
+  // Move every feature on b's strand, including b, to a's strand.
+  for (auto& feature_strand : strands_) {
+    if (feature_strand.first == b ||
+        (b_strand && feature_strand.second == b_strand)) {
+      feature_strand.second = a_strand;
+    }
+  }
+  strands_[a] = a_strand;
+  // The strands are resolved again before the next event.
+  invalidateSubscriptions();
+}
+
+void Parallel::wait() {
+  std::unique_lock<std::mutex> lock(idle_mutex_);
+  idle_.wait(lock, [this] { return pending_tasks_.load() == 0; });
+}
+
+void Parallel::onPair(myo::Myo* myo, uint64_t timestamp,
+                      myo::FirmwareVersion firmware_version) {
+  post(replay::Record::pair(0, timestamp, firmware_version), myo);
+}
+
+void Parallel::onUnpair(myo::Myo* myo, uint64_t timestamp) {
+  post(replay::Record::unpair(0, timestamp), myo);
+}
+
+void Parallel::onConnect(myo::Myo* myo, uint64_t timestamp,
+                         myo::FirmwareVersion firmware_version) {
+  post(replay::Record::connect(0, timestamp, firmware_version), myo);
+}
+
+void Parallel::onDisconnect(myo::Myo* myo, uint64_t timestamp) {
+  post(replay::Record::disconnect(0, timestamp), myo);
+}
+
+void Parallel::onArmSync(myo::Myo* myo, uint64_t timestamp, myo::Arm arm,
+                         myo::XDirection x_direction) {
+  post(replay::Record::armSync(0, timestamp, arm, x_direction), myo);
+}
+
+void Parallel::onArmUnsync(myo::Myo* myo, uint64_t timestamp) {
+  post(replay::Record::armUnsync(0, timestamp), myo);
+}
+
+void Parallel::onUnlock(myo::Myo* myo, uint64_t timestamp) {
+  post(replay::Record::unlock(0, timestamp), myo);
+}
+
+void Parallel::onLock(myo::Myo* myo, uint64_t timestamp) {
+  post(replay::Record::lock(0, timestamp), myo);
+}
+
+void Parallel::onPose(myo::Myo* myo, uint64_t timestamp,
+                      const std::shared_ptr<core::Pose>& pose) {
+  post(eventRecord(core::Event::Pose, timestamp), myo, pose);
+}
+
+void Parallel::onGesture(myo::Myo* myo, uint64_t timestamp,
+                         const std::shared_ptr<core::Gesture>& gesture) {
+  post(eventRecord(core::Event::Gesture, timestamp), myo, nullptr, gesture);
+}
+
+void Parallel::onOrientationData(myo::Myo* myo, uint64_t timestamp,
+                                 const myo::Quaternion<float>& rotation) {
+  post(replay::Record::orientationData(0, timestamp, rotation), myo);
+}
+
+void Parallel::onAccelerometerData(myo::Myo* myo, uint64_t timestamp,
+                                   const myo::Vector3<float>& acceleration) {
+  post(replay::Record::accelerometerData(0, timestamp, acceleration), myo);
+}
+
+void Parallel::onGyroscopeData(myo::Myo* myo, uint64_t timestamp,
+                               const myo::Vector3<float>& gyro) {
+  post(replay::Record::gyroscopeData(0, timestamp, gyro), myo);
+}
+
+void Parallel::onRssi(myo::Myo* myo, uint64_t timestamp, int8_t rssi) {
+  post(replay::Record::rssi(0, timestamp, rssi), myo);
+}
+
+void Parallel::onEmgData(myo::Myo* myo, uint64_t timestamp,
+                         const int8_t* emg) {
+  post(replay::Record::emgData(0, timestamp, emg), myo);
+}
+
+void Parallel::onPeriodic(myo::Myo* myo) {
+  post(replay::Record::periodic(0), myo);
+}
+
+void Parallel::onEmgEnvelope(myo::Myo* myo, uint64_t timestamp,
+                             const int16_t* envelope) {
+  post(replay::Record::emgEnvelope(0, timestamp, envelope), myo);
+}
+
+// The features are copied once and shared by every child's task.
+void Parallel::onEmgFeatures(myo::Myo* myo, uint64_t timestamp,
+                             const core::EmgFeatures& features) {
+  post(eventRecord(core::Event::EmgFeatures, timestamp), myo, nullptr,
+       nullptr, std::make_shared<const core::EmgFeatures>(features));
+}
+
+void Parallel::onOrientationDataBatch(myo::Myo* myo,
+                                      const core::OrientationBatch& batch) {
+  Task task = Task();
+  task.myo = myo;
+  task.record = eventRecord(core::Event::OrientationData, 0);
+  task.orientation_batch =
+      std::make_shared<const BatchCopy<myo::Quaternion<float>>>(batch);
+  post(task);
+}
+
+void Parallel::onAccelerometerDataBatch(myo::Myo* myo,
+                                        const core::VectorBatch& batch) {
+  Task task = Task();
+  task.myo = myo;
+  task.record = eventRecord(core::Event::AccelerometerData, 0);
+  task.vector_batch =
+      std::make_shared<const BatchCopy<myo::Vector3<float>>>(batch);
+  post(task);
+}
+
+void Parallel::onGyroscopeDataBatch(myo::Myo* myo,
+                                    const core::VectorBatch& batch) {
+  Task task = Task();
+  task.myo = myo;
+  task.record = eventRecord(core::Event::GyroscopeData, 0);
+  task.vector_batch =
+      std::make_shared<const BatchCopy<myo::Vector3<float>>>(batch);
+  post(task);
+}
+
+void Parallel::onEmgDataBatch(myo::Myo* myo, const core::EmgBatch& batch) {
+  Task task = Task();
+  task.myo = myo;
+  task.record = eventRecord(core::Event::EmgData, 0);
+  task.emg_batch = std::make_shared<const BatchCopy<core::EmgSample>>(batch);
+  post(task);
+}
+
+core::EventMask Parallel::linkedChildEvents() {
+  for (auto& child_strands : event_child_strands_) {
+    child_strands.clear();
+  }
+  // The same children in the same order as childFeaturesFor.
+  for (auto feature : child_features_) {
+    core::EventMask feature_events = feature->subscribedEvents();
+    Strand* strand = &strandFor(feature);
+    for (int type = 0; type < core::Event::NumTypes; ++type) {
+      if (feature_events &
+          core::EventBit(static_cast<core::Event::Type>(type))) {
+        event_child_strands_[type].push_back(ChildStrand{feature, strand});
+      }
+    }
+  }
+  // The children are already in child_features_.
+  return core::NoEvents;
+}
+
+replay::Record Parallel::eventRecord(core::Event::Type type,
+                                    uint64_t timestamp) {
+  replay::Record record = replay::Record();
+  record.type = type;
+  record.timestamp = timestamp;
+  return record;
+}
+
+void Parallel::run(const Task& task) {
+  const replay::Record& record = task.record;
+  const uint64_t timestamp = record.timestamp;
+  MYO_INTELLIGESTURE_PROFILE_SCOPE(task.feature, record.eventType());
+  switch (record.eventType()) {
+    case core::Event::Pair:
+      task.feature->onPair(task.myo, timestamp, record.data.firmware_version);
+      break;
+    case core::Event::Unpair:
+      task.feature->onUnpair(task.myo, timestamp);
+      break;
+    case core::Event::Connect:
+      task.feature->onConnect(task.myo, timestamp,
+                              record.data.firmware_version);
+      break;
+    case core::Event::Disconnect:
+      task.feature->onDisconnect(task.myo, timestamp);
+      break;
+    case core::Event::ArmSync:
+      task.feature->onArmSync(task.myo, timestamp, record.data.arm_sync.arm,
+                              record.data.arm_sync.x_direction);
+      break;
+    case core::Event::ArmUnsync:
+      task.feature->onArmUnsync(task.myo, timestamp);
+      break;
+    case core::Event::Unlock:
+      task.feature->onUnlock(task.myo, timestamp);
+      break;
+    case core::Event::Lock:
+      task.feature->onLock(task.myo, timestamp);
+      break;
+    case core::Event::Pose:
+      task.feature->onPose(task.myo, timestamp, task.pose);
+      break;
+    case core::Event::Gesture:
+      task.feature->onGesture(task.myo, timestamp, task.gesture);
+      break;
+    case core::Event::OrientationData:
+      if (task.orientation_batch) {
+        task.feature->onOrientationDataBatch(task.myo,
+                                             task.orientation_batch->batch());
+        break;
+      }
+      task.feature->onOrientationData(
+          task.myo, timestamp,
+          myo::Quaternion<float>(
+              record.data.quaternion[0], record.data.quaternion[1],
+              record.data.quaternion[2], record.data.quaternion[3]));
+      break;
+    case core::Event::AccelerometerData:
+      if (task.vector_batch) {
+        task.feature->onAccelerometerDataBatch(task.myo,
+                                               task.vector_batch->batch());
+        break;
+      }
+      task.feature->onAccelerometerData(
+          task.myo, timestamp,
+          myo::Vector3<float>(record.data.vector[0], record.data.vector[1],
+                              record.data.vector[2]));
+      break;
+    case core::Event::GyroscopeData:
+      if (task.vector_batch) {
+        task.feature->onGyroscopeDataBatch(task.myo,
+                                           task.vector_batch->batch());
+        break;
+      }
+      task.feature->onGyroscopeData(
+          task.myo, timestamp,
+          myo::Vector3<float>(record.data.vector[0], record.data.vector[1],
+                              record.data.vector[2]));
+      break;
+    case core::Event::Rssi:
+      task.feature->onRssi(task.myo, timestamp, record.data.rssi_value);
+      break;
+    case core::Event::EmgData:
+      if (task.emg_batch) {
+        task.feature->onEmgDataBatch(task.myo, task.emg_batch->batch());
+        break;
+      }
+      task.feature->onEmgData(task.myo, timestamp, record.data.emg);
+      break;
+    case core::Event::Periodic:
+      task.feature->onPeriodic(task.myo);
+      break;
+    case core::Event::EmgEnvelope:
+      task.feature->onEmgEnvelope(task.myo, timestamp,
+                                  record.data.emg_envelope);
+      break;
+    case core::Event::EmgFeatures:
+      task.feature->onEmgFeatures(task.myo, timestamp, *task.emg_features);
+      break;
+    default:
+      break;
+  }
+}
+
+void Parallel::post(const replay::Record& record, myo::Myo* myo,
+                    const std::shared_ptr<core::Pose>& pose,
+                    const std::shared_ptr<core::Gesture>& gesture,
+                    const std::shared_ptr<const core::EmgFeatures>&
+                        emg_features) {
+  Task task = Task();
+  task.myo = myo;
+  task.record = record;
+  task.pose = pose;
+  task.gesture = gesture;
+  task.emg_features = emg_features;
+  post(task);
+}
+
+void Parallel::post(Task task) {
+  updateSubscriptions();
+  for (const ChildStrand& child :
+       event_child_strands_[task.record.eventType()]) {
+    Strand& strand = *child.strand;
+    task.feature = child.feature;
+    pending_tasks_.fetch_add(1);
+    bool schedule;
+    {
+      std::lock_guard<std::mutex> lock(strand.mutex);
+      strand.pending.push_back(task);
+      schedule = !strand.scheduled;
+      strand.scheduled = true;
+    }
+    if (schedule) {
+      pool_.submit([this, &strand] { drain(strand); });
+    }
+  }
+}
+
+Parallel::Strand& Parallel::strandFor(child_feature_t feature) {
+  std::shared_ptr<Strand>& strand = strands_[feature];
+  if (!strand) {
+    strand = std::make_shared<Strand>();
+  }
+  return *strand;
+}
+
+void Parallel::drain(Strand& strand) {
+  std::size_t ran = 0;
+  while (true) {
+    {
+      std::lock_guard<std::mutex> lock(strand.mutex);
+      strand.running.clear();
+      if (strand.pending.empty()) {
+        strand.scheduled = false;
+        break;
+      }
+      strand.pending.swap(strand.running);
+    }
+    for (const Task& task : strand.running) {
+      run(task);
+    }
+    ran += strand.running.size();
+  }
+  // Once the count reaches zero, wait() may return and this feature may be
+  // destroyed, so the count is only changed while wait() is locked out.
+  std::lock_guard<std::mutex> lock(idle_mutex_);
+  if (pending_tasks_.fetch_sub(ran) == ran) {
+    idle_.notify_all();
+  }
+}
+}
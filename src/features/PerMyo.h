@@ -0,0 +1,256 @@
+/* PerMyo gives every Myo on a hub its own copy of a feature tree, running on
+ * its own worker thread. Features keep one set of state, so two Myos which
+ * share a tree would corrupt each other's state; with PerMyo each Myo's events
+ * only ever reach its own tree. Throughput scales with the number of Myos, up
+ * to the number of cores.
+ *
+ * A tree is any class with a root() method which returns its root feature,
+ * e.g. a core::Pipeline or:
+ *
+ *   struct Tree {
+ *     Tree() : debounce(root_feature), pose_gestures(debounce) {}
+ *     features::RootFeature& root() { return root_feature; }
+ *
+ *     features::RootFeature root_feature;
+ *     features::filters::Debounce debounce;
+ *     features::gestures::PoseGestures pose_gestures;
+ *   };
+ *
+ *   features::PerMyo<Tree> per_myo(
+ *       [](myo::Myo* myo) { return std::make_unique<Tree>(); });
+ *   hub.addListener(&per_myo);
+ *   while (true) {
+ *     hub.run(1000 / 20);
+ *     per_myo.onPeriodic();
+ *   }
+ *
+ * Each tree is created on the hub thread when the first event from its Myo
+ * arrives and is then fed through a QueuedRootFeature. The rules of
+ * QueuedRootFeature apply: every event, onPeriodic and stop() must come from
+ * the same thread.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <myo/myo.hpp>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "QueuedRootFeature.h"
+
+namespace features {
+template <typename Tree>
+class PerMyo : public myo::DeviceListener {
+ public:
+  typedef typename std::remove_reference<decltype(
+      std::declval<Tree&>().root())>::type RootFeature;
+  typedef QueuedRootFeature<RootFeature> Queue;
+  typedef std::function<std::unique_ptr<Tree>(myo::Myo*)> TreeFactory;
+
+  // make_tree is called once for each Myo. capacity and overflow_policy are
+  // those of each Myo's queue.
+  explicit PerMyo(TreeFactory make_tree, std::size_t capacity = 4096,
+                  typename Queue::OverflowPolicy overflow_policy =
+                      Queue::OverflowPolicy::dropSamples);
+  // Calls stop().
+  virtual ~PerMyo();
+
+  PerMyo(const PerMyo&) = delete;
+  PerMyo& operator=(const PerMyo&) = delete;
+
+  // Passes on every queued event and stops the worker threads.
+  void stop();
+
+  // The Myos seen so far, in the order they were first seen. The trees must
+  // not be used while their worker thread is running.
+  std::size_t size() const;
+  myo::Myo* myoAt(std::size_t i) const;
+  Tree& tree(std::size_t i);
+  Queue& queue(std::size_t i);
+
+  virtual void onPair(myo::Myo* myo, uint64_t timestamp,
+                      myo::FirmwareVersion firmware_version) override;
+  virtual void onUnpair(myo::Myo* myo, uint64_t timestamp) override;
+  virtual void onConnect(myo::Myo* myo, uint64_t timestamp,
+                         myo::FirmwareVersion firmware_version) override;
+  virtual void onDisconnect(myo::Myo* myo, uint64_t timestamp) override;
+  virtual void onArmSync(myo::Myo* myo, uint64_t timestamp, myo::Arm arm,
+                         myo::XDirection x_direction) override;
+  virtual void onArmUnsync(myo::Myo* myo, uint64_t timestamp) override;
+  virtual void onUnlock(myo::Myo* myo, uint64_t timestamp) override;
+  virtual void onLock(myo::Myo* myo, uint64_t timestamp) override;
+  virtual void onPose(myo::Myo* myo, uint64_t timestamp,
+                      myo::Pose pose) override;
+  virtual void onOrientationData(
+      myo::Myo* myo, uint64_t timestamp,
+      const myo::Quaternion<float>& rotation) override;
+  virtual void onAccelerometerData(
+      myo::Myo* myo, uint64_t timestamp,
+      const myo::Vector3<float>& acceleration) override;
+  virtual void onGyroscopeData(myo::Myo* myo, uint64_t timestamp,
+                               const myo::Vector3<float>& gyro) override;
+  virtual void onRssi(myo::Myo* myo, uint64_t timestamp, int8_t rssi) override;
+  virtual void onEmgData(myo::Myo* myo, uint64_t timestamp,
+                         const int8_t* emg) override;
+  // Calls onPeriodic of every Myo's tree with that Myo.
+  void onPeriodic();
+
+ private:
+  struct Shard {
+    myo::Myo* myo;
+    std::unique_ptr<Tree> tree;
+    std::unique_ptr<Queue> queue;
+  };
+
+  Queue& queueFor(myo::Myo* myo);
+
+  TreeFactory make_tree_;
+  const std::size_t capacity_;
+  const typename Queue::OverflowPolicy overflow_policy_;
+  std::vector<Shard> shards_;
+};
+
+template <typename Tree>
+PerMyo<Tree>::PerMyo(TreeFactory make_tree, std::size_t capacity,
+                     typename Queue::OverflowPolicy overflow_policy)
+    : make_tree_(std::move(make_tree)),
+      capacity_(capacity),
+      overflow_policy_(overflow_policy) {}
+
+template <typename Tree>
+PerMyo<Tree>::~PerMyo() {
+  stop();
+}
+
+template <typename Tree>
+void PerMyo<Tree>::stop() {
+  for (Shard& shard : shards_) {
+    shard.queue->stop();
+  }
+}
+
+template <typename Tree>
+std::size_t PerMyo<Tree>::size() const {
+  return shards_.size();
+}
+
+template <typename Tree>
+myo::Myo* PerMyo<Tree>::myoAt(std::size_t i) const {
+  return shards_[i].myo;
+}
+
+template <typename Tree>
+Tree& PerMyo<Tree>::tree(std::size_t i) {
+  return *shards_[i].tree;
+}
+
+template <typename Tree>
+typename PerMyo<Tree>::Queue& PerMyo<Tree>::queue(std::size_t i) {
+  return *shards_[i].queue;
+}
+
+template <typename Tree>
+void PerMyo<Tree>::onPair(myo::Myo* myo, uint64_t timestamp,
+                          myo::FirmwareVersion firmware_version) {
+  queueFor(myo).onPair(myo, timestamp, firmware_version);
+}
+
+template <typename Tree>
+void PerMyo<Tree>::onUnpair(myo::Myo* myo, uint64_t timestamp) {
+  queueFor(myo).onUnpair(myo, timestamp);
+}
+
+template <typename Tree>
+void PerMyo<Tree>::onConnect(myo::Myo* myo, uint64_t timestamp,
+                             myo::FirmwareVersion firmware_version) {
+  queueFor(myo).onConnect(myo, timestamp, firmware_version);
+}
+
+template <typename Tree>
+void PerMyo<Tree>::onDisconnect(myo::Myo* myo, uint64_t timestamp) {
+  queueFor(myo).onDisconnect(myo, timestamp);
+}
+
+template <typename Tree>
+void PerMyo<Tree>::onArmSync(myo::Myo* myo, uint64_t timestamp, myo::Arm arm,
+                             myo::XDirection x_direction) {
+  queueFor(myo).onArmSync(myo, timestamp, arm, x_direction);
+}
+
+template <typename Tree>
+void PerMyo<Tree>::onArmUnsync(myo::Myo* myo, uint64_t timestamp) {
+  queueFor(myo).onArmUnsync(myo, timestamp);
+}
+
+template <typename Tree>
+void PerMyo<Tree>::onUnlock(myo::Myo* myo, uint64_t timestamp) {
+  queueFor(myo).onUnlock(myo, timestamp);
+}
+
+template <typename Tree>
+void PerMyo<Tree>::onLock(myo::Myo* myo, uint64_t timestamp) {
+  queueFor(myo).onLock(myo, timestamp);
+}
+
+template <typename Tree>
+void PerMyo<Tree>::onPose(myo::Myo* myo, uint64_t timestamp, myo::Pose pose) {
+  queueFor(myo).onPose(myo, timestamp, pose);
+}
+
+template <typename Tree>
+void PerMyo<Tree>::onOrientationData(myo::Myo* myo, uint64_t timestamp,
+                                     const myo::Quaternion<float>& rotation) {
+  queueFor(myo).onOrientationData(myo, timestamp, rotation);
+}
+
+template <typename Tree>
+void PerMyo<Tree>::onAccelerometerData(
+    myo::Myo* myo, uint64_t timestamp,
+    const myo::Vector3<float>& acceleration) {
+  queueFor(myo).onAccelerometerData(myo, timestamp, acceleration);
+}
+
+template <typename Tree>
+void PerMyo<Tree>::onGyroscopeData(myo::Myo* myo, uint64_t timestamp,
+                                   const myo::Vector3<float>& gyro) {
+  queueFor(myo).onGyroscopeData(myo, timestamp, gyro);
+}
+
+template <typename Tree>
+void PerMyo<Tree>::onRssi(myo::Myo* myo, uint64_t timestamp, int8_t rssi) {
+  queueFor(myo).onRssi(myo, timestamp, rssi);
+}
+
+template <typename Tree>
+void PerMyo<Tree>::onEmgData(myo::Myo* myo, uint64_t timestamp,
+                             const int8_t* emg) {
+  queueFor(myo).onEmgData(myo, timestamp, emg);
+}
+
+template <typename Tree>
+void PerMyo<Tree>::onPeriodic() {
+  for (Shard& shard : shards_) {
+    shard.queue->onPeriodic(shard.myo);
+  }
+}
+
+template <typename Tree>
+typename PerMyo<Tree>::Queue& PerMyo<Tree>::queueFor(myo::Myo* myo) {
+  // Linear search, since there are rarely more than a few Myos.
+  for (Shard& shard : shards_) {
+    if (shard.myo == myo) {
+      return *shard.queue;
+    }
+  }
+  Shard shard;
+  shard.myo = myo;
+  shard.tree = make_tree_(myo);
+  shard.queue.reset(new Queue(shard.tree->root(), capacity_, overflow_policy_));
+  shards_.push_back(std::move(shard));
+  return *shards_.back().queue;
+}
+}
@@ -0,0 +1,565 @@
+/* QueuedRootFeature decouples the thread which runs the hub from the feature
+ * tree. It is added to the hub instead of the root feature. Every event is
+ * copied into a compact replay::Record and pushed into a lock-free ring, and a
+ * worker thread owned by the QueuedRootFeature passes the records on to the
+ * root feature. A slow feature therefore no longer delays hub.run.
+ *
+ * The orientation, accelerometer, gyroscope and EMG samples waiting in the ring
+ * are passed on in batches, see SampleBatch.h. By default a batch holds
+ * consecutive samples of one type from one Myo, so the tree sees every event
+ * in the order in which it arrived, as if it were fed directly. The Myo
+ * interleaves its orientation, accelerometer and gyroscope samples, so these
+ * then come one at a time, and only the EMG samples form longer batches.
+ *
+ * With BatchPolicy::perStream, each stream of samples, i.e. each type of
+ * sample from each Myo, is collected on its own instead. The streams are
+ * passed on, orientation first, before any other event, when one of them
+ * holds kMaxBatchSize samples, and when the ring is empty. Samples keep their
+ * order within a stream and relative to the other events, but not relative to
+ * the samples of other streams. Only use it for trees in which no feature
+ * combines streams: e.g. CorrectForOrientation would rotate a whole batch of
+ * accelerometer samples by the newest orientation.
+ *
+ *   features::RootFeature root_feature;
+ *   // Build the feature tree as usual.
+ *   features::QueuedRootFeature<> queued_root_feature(root_feature);
+ *   hub.addListener(&queued_root_feature);
+ *   while (true) {
+ *     hub.run(1000 / 20);
+ *     queued_root_feature.onPeriodic(myo);
+ *   }
+ *
+ * All events, including onPeriodic, must be sent from the same thread, which
+ * must also be the one to call stop() or destroy the QueuedRootFeature. The
+ * feature tree runs on the worker thread from construction until then. At most
+ * 256 Myos are told apart.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <myo/myo.hpp>
+#include <thread>
+#include <vector>
+
+#include "../core/SampleBatch.h"
+#include "../core/SpscRing.h"
+#include "../replay/Record.h"
+#include "RootFeature.h"
+
+namespace features {
+class QueuedRootFeatureTypes {
+ public:
+  // What to do with an event when the ring is full.
+  enum class OverflowPolicy {
+    // Drop the event.
+    dropNewest,
+    // Drop IMU, EMG and RSSI samples, but wait for space for every other
+    // event so that no pose or state change is lost.
+    dropSamples,
+    // Wait for space for every event.
+    block
+  };
+
+  // Which samples waiting in the ring are passed on as one batch.
+  enum class BatchPolicy {
+    // Consecutive samples of the same type from the same Myo.
+    arrivalOrder,
+    // All samples of the same type from the same Myo, up to the next event
+    // which is not a sample.
+    perStream
+  };
+
+  struct QueueStats {
+    // Events pushed into the ring, including periodic calls.
+    uint64_t pushed;
+    // Events passed on to the root feature.
+    uint64_t dispatched;
+    // Events dropped because the ring was full.
+    uint64_t dropped;
+    // Events for which the hub thread waited because the ring was full.
+    uint64_t blocked;
+    // The most events seen in the ring by the worker thread.
+    std::size_t high_water_mark;
+  };
+};
+
+template <typename RootFeature = features::RootFeature>
+class QueuedRootFeature : public myo::DeviceListener,
+                          public QueuedRootFeatureTypes {
+ public:
+  // Starts the worker thread. root_feature must outlive this object.
+  QueuedRootFeature(
+      RootFeature& root_feature, std::size_t capacity = 4096,
+      OverflowPolicy overflow_policy = OverflowPolicy::dropSamples,
+      BatchPolicy batch_policy = BatchPolicy::arrivalOrder);
+  // Calls stop().
+  virtual ~QueuedRootFeature();
+
+  QueuedRootFeature(const QueuedRootFeature&) = delete;
+  QueuedRootFeature& operator=(const QueuedRootFeature&) = delete;
+
+  // Waits for the worker thread to pass on every queued event and stops it.
+  // Events sent after this are dropped.
+  void stop();
+
+  QueueStats stats() const;
+
+  virtual void onPair(myo::Myo* myo, uint64_t timestamp,
+                      myo::FirmwareVersion firmware_version) override;
+  virtual void onUnpair(myo::Myo* myo, uint64_t timestamp) override;
+  virtual void onConnect(myo::Myo* myo, uint64_t timestamp,
+                         myo::FirmwareVersion firmware_version) override;
+  virtual void onDisconnect(myo::Myo* myo, uint64_t timestamp) override;
+  virtual void onArmSync(myo::Myo* myo, uint64_t timestamp, myo::Arm arm,
+                         myo::XDirection x_direction) override;
+  virtual void onArmUnsync(myo::Myo* myo, uint64_t timestamp) override;
+  virtual void onUnlock(myo::Myo* myo, uint64_t timestamp) override;
+  virtual void onLock(myo::Myo* myo, uint64_t timestamp) override;
+  virtual void onPose(myo::Myo* myo, uint64_t timestamp,
+                      myo::Pose pose) override;
+  virtual void onOrientationData(
+      myo::Myo* myo, uint64_t timestamp,
+      const myo::Quaternion<float>& rotation) override;
+  virtual void onAccelerometerData(
+      myo::Myo* myo, uint64_t timestamp,
+      const myo::Vector3<float>& acceleration) override;
+  virtual void onGyroscopeData(myo::Myo* myo, uint64_t timestamp,
+                               const myo::Vector3<float>& gyro) override;
+  virtual void onRssi(myo::Myo* myo, uint64_t timestamp, int8_t rssi) override;
+  virtual void onEmgData(myo::Myo* myo, uint64_t timestamp,
+                         const int8_t* emg) override;
+  void onPeriodic(myo::Myo* myo);
+
+ private:
+  // How many times the worker checks for new records before it sleeps.
+  static const int kSpins = 256;
+  // The most samples passed on in one batch.
+  static const std::size_t kMaxBatchSize = 64;
+
+  // The types of sample collected into batches, in the order in which their
+  // batches are passed on.
+  enum StreamKind {
+    orientationStream,
+    accelerometerStream,
+    gyroscopeStream,
+    emgStream,
+    numStreamKinds
+  };
+
+  // The samples of one stream waiting to be passed on as a batch.
+  struct Stream {
+    std::vector<uint64_t> timestamps;
+    std::vector<myo::Quaternion<float>> orientations;
+    std::vector<myo::Vector3<float>> vectors;
+    std::vector<core::EmgSample> emg;
+  };
+
+  static bool isSample(const replay::Record& record);
+
+  // Called on the hub thread.
+  uint8_t myoIndex(myo::Myo* myo);
+  void push(const replay::Record& record);
+
+  // Called on the worker thread.
+  void run();
+  // Returns false once the ring is empty and stop() was called.
+  bool waitForRecords();
+  void dispatch(const replay::Record& record);
+  // The stream of a sample, which is created on first use.
+  Stream& stream(StreamKind kind, uint8_t myo_index);
+  // Passes on the samples collected by dispatch.
+  void flushBatches();
+
+  RootFeature& root_feature_;
+  const OverflowPolicy overflow_policy_;
+  const BatchPolicy batch_policy_;
+  core::SpscRing<replay::Record> ring_;
+
+  // Written by the hub thread before the first record with their index is
+  // pushed, which makes them visible to the worker thread.
+  std::array<myo::Myo*, 256> myos_;
+  std::size_t num_myos_;
+
+  std::atomic<uint64_t> pushed_, dispatched_, dropped_, blocked_;
+  std::atomic<std::size_t> high_water_mark_;
+
+  std::mutex mutex_;
+  std::condition_variable records_available_;
+  std::atomic<bool> sleeping_, stopping_;
+
+  // Only used by the worker thread. Indexed by kind and then by Myo index.
+  std::array<std::vector<Stream>, numStreamKinds> streams_;
+  bool streams_empty_;
+  // The stream of the last sample collected.
+  StreamKind last_kind_;
+  uint8_t last_myo_index_;
+
+  std::thread worker_;
+};
+
+template <typename RootFeature>
+QueuedRootFeature<RootFeature>::QueuedRootFeature(
+    RootFeature& root_feature, std::size_t capacity,
+    OverflowPolicy overflow_policy, BatchPolicy batch_policy)
+    : root_feature_(root_feature),
+      overflow_policy_(overflow_policy),
+      batch_policy_(batch_policy),
+      ring_(capacity),
+      num_myos_(0),
+      pushed_(0),
+      dispatched_(0),
+      dropped_(0),
+      blocked_(0),
+      high_water_mark_(0),
+      sleeping_(false),
+      stopping_(false),
+      streams_empty_(true),
+      last_kind_(orientationStream),
+      last_myo_index_(0) {
+  myos_.fill(nullptr);
+  worker_ = std::thread(&QueuedRootFeature::run, this);
+}
+
+template <typename RootFeature>
+QueuedRootFeature<RootFeature>::~QueuedRootFeature() {
+  stop();
+}
+
+template <typename RootFeature>
+void QueuedRootFeature<RootFeature>::stop() {
+  if (!worker_.joinable()) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  records_available_.notify_one();
+  worker_.join();
+}
+
+template <typename RootFeature>
+QueuedRootFeatureTypes::QueueStats QueuedRootFeature<RootFeature>::stats()
+    const {
+  return QueueStats{pushed_, dispatched_, dropped_, blocked_,
+                    high_water_mark_};
+}
+
+template <typename RootFeature>
+void QueuedRootFeature<RootFeature>::onPair(
+    myo::Myo* myo, uint64_t timestamp, myo::FirmwareVersion firmware_version) {
+  push(replay::Record::pair(myoIndex(myo), timestamp, firmware_version));
+}
+
+template <typename RootFeature>
+void QueuedRootFeature<RootFeature>::onUnpair(myo::Myo* myo,
+                                              uint64_t timestamp) {
+  push(replay::Record::unpair(myoIndex(myo), timestamp));
+}
+
+template <typename RootFeature>
+void QueuedRootFeature<RootFeature>::onConnect(
+    myo::Myo* myo, uint64_t timestamp, myo::FirmwareVersion firmware_version) {
+  push(replay::Record::connect(myoIndex(myo), timestamp, firmware_version));
+}
+
+template <typename RootFeature>
+void QueuedRootFeature<RootFeature>::onDisconnect(myo::Myo* myo,
+                                                  uint64_t timestamp) {
+  push(replay::Record::disconnect(myoIndex(myo), timestamp));
+}
+
+template <typename RootFeature>
+void QueuedRootFeature<RootFeature>::onArmSync(myo::Myo* myo,
+                                               uint64_t timestamp,
+                                               myo::Arm arm,
+                                               myo::XDirection x_direction) {
+  push(replay::Record::armSync(myoIndex(myo), timestamp, arm, x_direction));
+}
+
+template <typename RootFeature>
+void QueuedRootFeature<RootFeature>::onArmUnsync(myo::Myo* myo,
+                                                 uint64_t timestamp) {
+  push(replay::Record::armUnsync(myoIndex(myo), timestamp));
+}
+
+template <typename RootFeature>
+void QueuedRootFeature<RootFeature>::onUnlock(myo::Myo* myo,
+                                              uint64_t timestamp) {
+  push(replay::Record::unlock(myoIndex(myo), timestamp));
+}
+
+template <typename RootFeature>
+void QueuedRootFeature<RootFeature>::onLock(myo::Myo* myo,
+                                            uint64_t timestamp) {
+  push(replay::Record::lock(myoIndex(myo), timestamp));
+}
+
+template <typename RootFeature>
+void QueuedRootFeature<RootFeature>::onPose(myo::Myo* myo, uint64_t timestamp,
+                                            myo::Pose pose) {
+  push(replay::Record::pose(myoIndex(myo), timestamp, pose));
+}
+
+template <typename RootFeature>
+void QueuedRootFeature<RootFeature>::onOrientationData(
+    myo::Myo* myo, uint64_t timestamp, const myo::Quaternion<float>& rotation) {
+  push(replay::Record::orientationData(myoIndex(myo), timestamp, rotation));
+}
+
+template <typename RootFeature>
+void QueuedRootFeature<RootFeature>::onAccelerometerData(
+    myo::Myo* myo, uint64_t timestamp,
+    const myo::Vector3<float>& acceleration) {
+  push(replay::Record::accelerometerData(myoIndex(myo), timestamp,
+                                         acceleration));
+}
+
+template <typename RootFeature>
+void QueuedRootFeature<RootFeature>::onGyroscopeData(
+    myo::Myo* myo, uint64_t timestamp, const myo::Vector3<float>& gyro) {
+  push(replay::Record::gyroscopeData(myoIndex(myo), timestamp, gyro));
+}
+
+template <typename RootFeature>
+void QueuedRootFeature<RootFeature>::onRssi(myo::Myo* myo, uint64_t timestamp,
+                                            int8_t rssi) {
+  push(replay::Record::rssi(myoIndex(myo), timestamp, rssi));
+}
+
+template <typename RootFeature>
+void QueuedRootFeature<RootFeature>::onEmgData(myo::Myo* myo,
+                                               uint64_t timestamp,
+                                               const int8_t* emg) {
+  push(replay::Record::emgData(myoIndex(myo), timestamp, emg));
+}
+
+template <typename RootFeature>
+void QueuedRootFeature<RootFeature>::onPeriodic(myo::Myo* myo) {
+  push(replay::Record::periodic(myoIndex(myo)));
+}
+
+template <typename RootFeature>
+bool QueuedRootFeature<RootFeature>::isSample(const replay::Record& record) {
+  switch (record.eventType()) {
+    case core::Event::OrientationData:
+    case core::Event::AccelerometerData:
+    case core::Event::GyroscopeData:
+    case core::Event::Rssi:
+    case core::Event::EmgData:
+      return true;
+    default:
+      return false;
+  }
+}
+
+template <typename RootFeature>
+uint8_t QueuedRootFeature<RootFeature>::myoIndex(myo::Myo* myo) {
+  for (std::size_t i = 0; i < num_myos_; ++i) {
+    if (myos_[i] == myo) {
+      return i;
+    }
+  }
+  if (num_myos_ == myos_.size()) {
+    // Any further Myos are passed on as the last one.
+    return num_myos_ - 1;
+  }
+  myos_[num_myos_] = myo;
+  return num_myos_++;
+}
+
+template <typename RootFeature>
+void QueuedRootFeature<RootFeature>::push(const replay::Record& record) {
+  if (stopping_) {
+    dropped_.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+  if (!ring_.tryPush(record)) {
+    if (overflow_policy_ == OverflowPolicy::dropNewest ||
+        (overflow_policy_ == OverflowPolicy::dropSamples &&
+         isSample(record))) {
+      dropped_.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+    blocked_.fetch_add(1, std::memory_order_relaxed);
+    do {
+      std::this_thread::yield();
+    } while (!ring_.tryPush(record));
+  }
+  pushed_.fetch_add(1, std::memory_order_relaxed);
+  // Pairs with the fence in waitForRecords: either the worker sees the new
+  // record before it sleeps, or this thread sees that it is sleeping.
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (sleeping_.load(std::memory_order_relaxed)) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    records_available_.notify_one();
+  }
+}
+
+template <typename RootFeature>
+void QueuedRootFeature<RootFeature>::run() {
+  replay::Record record;
+  do {
+    std::size_t size = ring_.size();
+    if (size > high_water_mark_.load(std::memory_order_relaxed)) {
+      high_water_mark_.store(size, std::memory_order_relaxed);
+    }
+    while (ring_.tryPop(record)) {
+      dispatch(record);
+      dispatched_.fetch_add(1, std::memory_order_relaxed);
+    }
+    // Nothing else is waiting, so the samples are passed on before sleeping.
+    flushBatches();
+  } while (waitForRecords());
+}
+
+template <typename RootFeature>
+bool QueuedRootFeature<RootFeature>::waitForRecords() {
+  for (int i = 0; i < kSpins; ++i) {
+    if (!ring_.empty()) {
+      return true;
+    }
+    std::this_thread::yield();
+  }
+  std::unique_lock<std::mutex> lock(mutex_);
+  sleeping_.store(true, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  records_available_.wait(lock,
+                          [this] { return !ring_.empty() || stopping_; });
+  sleeping_.store(false, std::memory_order_relaxed);
+  return !ring_.empty() || !stopping_;
+}
+
+template <typename RootFeature>
+void QueuedRootFeature<RootFeature>::dispatch(const replay::Record& record) {
+  const core::Event::Type type = record.eventType();
+  StreamKind kind;
+  switch (type) {
+    case core::Event::OrientationData:
+      kind = orientationStream;
+      break;
+    case core::Event::AccelerometerData:
+      kind = accelerometerStream;
+      break;
+    case core::Event::GyroscopeData:
+      kind = gyroscopeStream;
+      break;
+    case core::Event::EmgData:
+      kind = emgStream;
+      break;
+    default: {
+      flushBatches();
+      myo::Myo* myo = myos_[record.myo_index];
+      if (type == core::Event::Periodic) {
+        root_feature_.onPeriodic(myo);
+      } else {
+        record.dispatch(root_feature_, myo);
+      }
+      return;
+    }
+  }
+  Stream* samples = &stream(kind, record.myo_index);
+  if (samples->timestamps.size() == kMaxBatchSize ||
+      (batch_policy_ == BatchPolicy::arrivalOrder && !streams_empty_ &&
+       (kind != last_kind_ || record.myo_index != last_myo_index_))) {
+    flushBatches();
+  }
+  last_kind_ = kind;
+  last_myo_index_ = record.myo_index;
+  switch (kind) {
+    case orientationStream:
+      samples->orientations.emplace_back(
+          record.data.quaternion[0], record.data.quaternion[1],
+          record.data.quaternion[2], record.data.quaternion[3]);
+      break;
+    case accelerometerStream:
+    case gyroscopeStream:
+      samples->vectors.emplace_back(record.data.vector[0],
+                                    record.data.vector[1],
+                                    record.data.vector[2]);
+      break;
+    default:
+      samples->emg.emplace_back();
+      std::copy(record.data.emg, record.data.emg + 8,
+                samples->emg.back().begin());
+      break;
+  }
+  samples->timestamps.push_back(record.timestamp);
+  streams_empty_ = false;
+}
+
+template <typename RootFeature>
+typename QueuedRootFeature<RootFeature>::Stream&
+QueuedRootFeature<RootFeature>::stream(StreamKind kind, uint8_t myo_index) {
+  std::vector<Stream>& streams = streams_[kind];
+  while (streams.size() <= myo_index) {
+    streams.emplace_back();
+    streams.back().timestamps.reserve(kMaxBatchSize);
+    switch (kind) {
+      case orientationStream:
+        streams.back().orientations.reserve(kMaxBatchSize);
+        break;
+      case accelerometerStream:
+      case gyroscopeStream:
+        streams.back().vectors.reserve(kMaxBatchSize);
+        break;
+      default:
+        streams.back().emg.reserve(kMaxBatchSize);
+        break;
+    }
+  }
+  return streams[myo_index];
+}
+
+// With BatchPolicy::perStream, orientation goes first, as it does for each
+// sample from the Myo.
+template <typename RootFeature>
+void QueuedRootFeature<RootFeature>::flushBatches() {
+  if (streams_empty_) {
+    return;
+  }
+  for (int kind = 0; kind < numStreamKinds; ++kind) {
+    for (std::size_t myo_index = 0; myo_index < streams_[kind].size();
+         ++myo_index) {
+      Stream& samples = streams_[kind][myo_index];
+      if (samples.timestamps.empty()) {
+        continue;
+      }
+      myo::Myo* myo = myos_[myo_index];
+      const uint64_t* timestamps = samples.timestamps.data();
+      std::size_t size = samples.timestamps.size();
+      switch (kind) {
+        case orientationStream:
+          root_feature_.onOrientationDataBatch(
+              myo, core::OrientationBatch(timestamps,
+                                          samples.orientations.data(), size));
+          break;
+        case accelerometerStream:
+          root_feature_.onAccelerometerDataBatch(
+              myo, core::VectorBatch(timestamps, samples.vectors.data(), size));
+          break;
+        case gyroscopeStream:
+          root_feature_.onGyroscopeDataBatch(
+              myo, core::VectorBatch(timestamps, samples.vectors.data(), size));
+          break;
+        default:
+          root_feature_.onEmgDataBatch(
+              myo, core::EmgBatch(timestamps, samples.emg.data(), size));
+          break;
+      }
+      samples.timestamps.clear();
+      samples.orientations.clear();
+      samples.vectors.clear();
+      samples.emg.clear();
+    }
+  }
+  streams_empty_ = true;
+}
+}
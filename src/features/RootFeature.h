@@ -2,66 +2,121 @@
 
 #include <myo/myo.hpp>
 
+#include "../core/Clock.h"
 #include "../core/DeviceListenerWrapper.h"
 #include "../core/Pose.h"
 
 namespace features {
-class RootFeature : public myo::DeviceListener,
-                    public core::DeviceListenerWrapper {
+template <typename Base = core::DeviceListenerWrapper>
+class BasicRootFeature : public myo::DeviceListener, public Base {
  public:
+  virtual core::EventMask handledEvents() const override {
+    return core::NoEvents;
+  }
+
+  // A clock which follows the timestamps of the events from the Myo. Pass
+  // this to features to make them independent of real time.
+  core::DeviceClock& deviceClock() { return device_clock_; }
+
   virtual void onPair(myo::Myo* myo, uint64_t timestamp,
                       myo::FirmwareVersion firmware_version) override {
-    core::DeviceListenerWrapper::onPair(myo, timestamp, firmware_version);
+    device_clock_.advance(timestamp);
+    Base::onPair(myo, timestamp, firmware_version);
   }
   virtual void onUnpair(myo::Myo* myo, uint64_t timestamp) override {
-    core::DeviceListenerWrapper::onUnpair(myo, timestamp);
+    device_clock_.advance(timestamp);
+    Base::onUnpair(myo, timestamp);
   }
   virtual void onConnect(myo::Myo* myo, uint64_t timestamp,
                          myo::FirmwareVersion firmware_version) override {
-    core::DeviceListenerWrapper::onConnect(myo, timestamp, firmware_version);
+    device_clock_.advance(timestamp);
+    Base::onConnect(myo, timestamp, firmware_version);
   }
   virtual void onDisconnect(myo::Myo* myo, uint64_t timestamp) override {
-    core::DeviceListenerWrapper::onDisconnect(myo, timestamp);
+    device_clock_.advance(timestamp);
+    Base::onDisconnect(myo, timestamp);
   }
   virtual void onArmSync(myo::Myo* myo, uint64_t timestamp, myo::Arm arm,
                          myo::XDirection x_direction) override {
-    core::DeviceListenerWrapper::onArmSync(myo, timestamp, arm, x_direction);
+    device_clock_.advance(timestamp);
+    Base::onArmSync(myo, timestamp, arm, x_direction);
   }
   virtual void onArmUnsync(myo::Myo* myo, uint64_t timestamp) override {
-    core::DeviceListenerWrapper::onArmUnsync(myo, timestamp);
+    device_clock_.advance(timestamp);
+    Base::onArmUnsync(myo, timestamp);
   }
   virtual void onUnlock(myo::Myo* myo, uint64_t timestamp) override {
-    core::DeviceListenerWrapper::onUnlock(myo, timestamp);
+    device_clock_.advance(timestamp);
+    Base::onUnlock(myo, timestamp);
   }
   virtual void onLock(myo::Myo* myo, uint64_t timestamp) override {
-    core::DeviceListenerWrapper::onLock(myo, timestamp);
+    device_clock_.advance(timestamp);
+    Base::onLock(myo, timestamp);
   }
   virtual void onPose(myo::Myo* myo, uint64_t timestamp,
                       myo::Pose pose) override {
-    std::shared_ptr<core::Pose> shared_pose(new core::Pose(pose));
-    core::DeviceListenerWrapper::onPose(myo, timestamp, shared_pose);
+    device_clock_.advance(timestamp);
+    Base::onPose(myo, timestamp, core::Pose::interned(pose));
   }
   virtual void onOrientationData(
       myo::Myo* myo, uint64_t timestamp,
       const myo::Quaternion<float>& rotation) override {
-    core::DeviceListenerWrapper::onOrientationData(myo, timestamp, rotation);
+    device_clock_.advance(timestamp);
+    Base::onOrientationData(myo, timestamp, rotation);
   }
   virtual void onAccelerometerData(
       myo::Myo* myo, uint64_t timestamp,
       const myo::Vector3<float>& acceleration) override {
-    core::DeviceListenerWrapper::onAccelerometerData(myo, timestamp,
-                                                     acceleration);
+    device_clock_.advance(timestamp);
+    Base::onAccelerometerData(myo, timestamp, acceleration);
   }
   virtual void onGyroscopeData(myo::Myo* myo, uint64_t timestamp,
                                const myo::Vector3<float>& gyro) override {
-    core::DeviceListenerWrapper::onGyroscopeData(myo, timestamp, gyro);
+    device_clock_.advance(timestamp);
+    Base::onGyroscopeData(myo, timestamp, gyro);
   }
   virtual void onRssi(myo::Myo* myo, uint64_t timestamp, int8_t rssi) override {
-    core::DeviceListenerWrapper::onRssi(myo, timestamp, rssi);
+    device_clock_.advance(timestamp);
+    Base::onRssi(myo, timestamp, rssi);
   }
   virtual void onEmgData(myo::Myo* myo, uint64_t timestamp,
                          const int8_t* emg) override {
-    core::DeviceListenerWrapper::onEmgData(myo, timestamp, emg);
+    device_clock_.advance(timestamp);
+    Base::onEmgData(myo, timestamp, emg);
+  }
+  virtual void onOrientationDataBatch(
+      myo::Myo* myo, const core::OrientationBatch& batch) override {
+    advance(batch);
+    Base::forwardOrientationDataBatch(myo, batch);
+  }
+  virtual void onAccelerometerDataBatch(
+      myo::Myo* myo, const core::VectorBatch& batch) override {
+    advance(batch);
+    Base::forwardAccelerometerDataBatch(myo, batch);
+  }
+  virtual void onGyroscopeDataBatch(myo::Myo* myo,
+                                    const core::VectorBatch& batch) override {
+    advance(batch);
+    Base::forwardGyroscopeDataBatch(myo, batch);
   }
+  virtual void onEmgDataBatch(myo::Myo* myo,
+                              const core::EmgBatch& batch) override {
+    advance(batch);
+    Base::forwardEmgDataBatch(myo, batch);
+  }
+
+ private:
+  // The whole batch is passed on at once, so the device clock is moved to the
+  // last sample of the batch before the first sample reaches the tree.
+  template <typename Sample>
+  void advance(const core::SampleBatch<Sample>& batch) {
+    for (std::size_t i = 0; i < batch.size; ++i) {
+      device_clock_.advance(batch.timestamps[i]);
+    }
+  }
+
+  core::DeviceClock device_clock_;
 };
+
+typedef BasicRootFeature<> RootFeature;
 }
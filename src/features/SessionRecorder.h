@@ -0,0 +1,251 @@
+/* SessionRecorder writes every event it receives to a session file, which can
+ * be read back with replay::SessionReader and played into a feature tree with
+ * replay::Replayer. Gestures, EMG envelopes and features and periodic calls
+ * are not recorded; the replayer recreates the latter. Events are passed on to
+ * child features unchanged.
+ *
+ * Record the raw events by making the recorder a child of the root feature.
+ * Poses added by other features, e.g. OrientationPoses, are recorded as
+ * unknown.
+ *
+ * Writes happen on the event path, so a failed write, e.g. to a full disk, is
+ * not thrown but makes good() false for good, and nothing more is written. The
+ * file is then incomplete and may end part way through a record, so it should
+ * not be replayed.
+ */
+
+#pragma once
+
+#include <cstdio>
+#include <myo/myo.hpp>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "../core/DeviceListenerWrapper.h"
+#include "../replay/Record.h"
+
+namespace features {
+template <typename Base = core::DeviceListenerWrapper>
+class BasicSessionRecorder : public Base {
+ public:
+  // Creates or truncates the file at path. Throws std::runtime_error if the
+  // file can not be opened.
+  BasicSessionRecorder(core::DeviceListenerWrapper& parent_feature,
+                       const std::string& path);
+  virtual ~BasicSessionRecorder();
+
+  virtual core::EventMask handledEvents() const override;
+
+  // Writes all buffered records to the file.
+  void flush();
+  // False once any write to the file has failed. Call flush() first to check
+  // the records which are still buffered.
+  bool good() const;
+
+  virtual void onPair(myo::Myo* myo, uint64_t timestamp,
+                      myo::FirmwareVersion firmware_version) override;
+  virtual void onUnpair(myo::Myo* myo, uint64_t timestamp) override;
+  virtual void onConnect(myo::Myo* myo, uint64_t timestamp,
+                         myo::FirmwareVersion firmware_version) override;
+  virtual void onDisconnect(myo::Myo* myo, uint64_t timestamp) override;
+  virtual void onArmSync(myo::Myo* myo, uint64_t timestamp, myo::Arm arm,
+                         myo::XDirection x_direction) override;
+  virtual void onArmUnsync(myo::Myo* myo, uint64_t timestamp) override;
+  virtual void onUnlock(myo::Myo* myo, uint64_t timestamp) override;
+  virtual void onLock(myo::Myo* myo, uint64_t timestamp) override;
+  virtual void onPose(myo::Myo* myo, uint64_t timestamp,
+                      const std::shared_ptr<core::Pose>& pose) override;
+  virtual void onOrientationData(
+      myo::Myo* myo, uint64_t timestamp,
+      const myo::Quaternion<float>& rotation) override;
+  virtual void onAccelerometerData(myo::Myo* myo, uint64_t timestamp,
+                                   const myo::Vector3<float>& accel) override;
+  virtual void onGyroscopeData(myo::Myo* myo, uint64_t timestamp,
+                               const myo::Vector3<float>& gyro) override;
+  virtual void onRssi(myo::Myo* myo, uint64_t timestamp, int8_t rssi) override;
+  virtual void onEmgData(myo::Myo* myo, uint64_t timestamp,
+                         const int8_t* emg) override;
+
+ private:
+  // Records are written in blocks of this many.
+  static const std::size_t kBufferSize = 4096;
+
+  // Myos are numbered in the order they are first seen.
+  uint8_t myoIndex(myo::Myo* myo);
+  void write(const replay::Record& record);
+  void writeBuffer();
+
+  std::FILE* file_;
+  bool good_;
+  std::vector<replay::Record> buffer_;
+  std::vector<myo::Myo*> myos_;
+};
+
+typedef BasicSessionRecorder<> SessionRecorder;
+
+template <typename Base>
+BasicSessionRecorder<Base>::BasicSessionRecorder(
+    core::DeviceListenerWrapper& parent_feature, const std::string& path)
+    : file_(std::fopen(path.c_str(), "wb")), good_(true) {
+  if (!file_) {
+    throw std::runtime_error("Unable to open " + path + " for recording.");
+  }
+  replay::SessionHeader header = replay::SessionHeader::current();
+  good_ = std::fwrite(&header, sizeof(header), 1, file_) == 1;
+  buffer_.reserve(kBufferSize);
+  parent_feature.addChildFeature(this);
+}
+
+template <typename Base>
+BasicSessionRecorder<Base>::~BasicSessionRecorder() {
+  flush();
+  std::fclose(file_);
+}
+
+template <typename Base>
+core::EventMask BasicSessionRecorder<Base>::handledEvents() const {
+  return core::AllEvents & ~core::EventBit(core::Event::Gesture) &
+         ~core::EventBit(core::Event::Periodic) &
+         ~core::EventBit(core::Event::EmgEnvelope) &
+         ~core::EventBit(core::Event::EmgFeatures);
+}
+
+template <typename Base>
+void BasicSessionRecorder<Base>::flush() {
+  writeBuffer();
+  if (std::fflush(file_) != 0) {
+    good_ = false;
+  }
+}
+
+template <typename Base>
+bool BasicSessionRecorder<Base>::good() const {
+  return good_;
+}
+
+template <typename Base>
+void BasicSessionRecorder<Base>::onPair(myo::Myo* myo, uint64_t timestamp,
+                                        myo::FirmwareVersion firmware_version) {
+  write(replay::Record::pair(myoIndex(myo), timestamp, firmware_version));
+  Base::onPair(myo, timestamp, firmware_version);
+}
+
+template <typename Base>
+void BasicSessionRecorder<Base>::onUnpair(myo::Myo* myo, uint64_t timestamp) {
+  write(replay::Record::unpair(myoIndex(myo), timestamp));
+  Base::onUnpair(myo, timestamp);
+}
+
+template <typename Base>
+void BasicSessionRecorder<Base>::onConnect(
+    myo::Myo* myo, uint64_t timestamp, myo::FirmwareVersion firmware_version) {
+  write(replay::Record::connect(myoIndex(myo), timestamp, firmware_version));
+  Base::onConnect(myo, timestamp, firmware_version);
+}
+
+template <typename Base>
+void BasicSessionRecorder<Base>::onDisconnect(myo::Myo* myo,
+                                              uint64_t timestamp) {
+  write(replay::Record::disconnect(myoIndex(myo), timestamp));
+  Base::onDisconnect(myo, timestamp);
+}
+
+template <typename Base>
+void BasicSessionRecorder<Base>::onArmSync(myo::Myo* myo, uint64_t timestamp,
+                                           myo::Arm arm,
+                                           myo::XDirection x_direction) {
+  write(replay::Record::armSync(myoIndex(myo), timestamp, arm, x_direction));
+  Base::onArmSync(myo, timestamp, arm, x_direction);
+}
+
+template <typename Base>
+void BasicSessionRecorder<Base>::onArmUnsync(myo::Myo* myo,
+                                             uint64_t timestamp) {
+  write(replay::Record::armUnsync(myoIndex(myo), timestamp));
+  Base::onArmUnsync(myo, timestamp);
+}
+
+template <typename Base>
+void BasicSessionRecorder<Base>::onUnlock(myo::Myo* myo, uint64_t timestamp) {
+  write(replay::Record::unlock(myoIndex(myo), timestamp));
+  Base::onUnlock(myo, timestamp);
+}
+
+template <typename Base>
+void BasicSessionRecorder<Base>::onLock(myo::Myo* myo, uint64_t timestamp) {
+  write(replay::Record::lock(myoIndex(myo), timestamp));
+  Base::onLock(myo, timestamp);
+}
+
+template <typename Base>
+void BasicSessionRecorder<Base>::onPose(
+    myo::Myo* myo, uint64_t timestamp,
+    const std::shared_ptr<core::Pose>& pose) {
+  write(replay::Record::pose(myoIndex(myo), timestamp, *pose));
+  Base::onPose(myo, timestamp, pose);
+}
+
+template <typename Base>
+void BasicSessionRecorder<Base>::onOrientationData(
+    myo::Myo* myo, uint64_t timestamp, const myo::Quaternion<float>& rotation) {
+  write(replay::Record::orientationData(myoIndex(myo), timestamp, rotation));
+  Base::onOrientationData(myo, timestamp, rotation);
+}
+
+template <typename Base>
+void BasicSessionRecorder<Base>::onAccelerometerData(
+    myo::Myo* myo, uint64_t timestamp, const myo::Vector3<float>& accel) {
+  write(replay::Record::accelerometerData(myoIndex(myo), timestamp, accel));
+  Base::onAccelerometerData(myo, timestamp, accel);
+}
+
+template <typename Base>
+void BasicSessionRecorder<Base>::onGyroscopeData(
+    myo::Myo* myo, uint64_t timestamp, const myo::Vector3<float>& gyro) {
+  write(replay::Record::gyroscopeData(myoIndex(myo), timestamp, gyro));
+  Base::onGyroscopeData(myo, timestamp, gyro);
+}
+
+template <typename Base>
+void BasicSessionRecorder<Base>::onRssi(myo::Myo* myo, uint64_t timestamp,
+                                        int8_t rssi) {
+  write(replay::Record::rssi(myoIndex(myo), timestamp, rssi));
+  Base::onRssi(myo, timestamp, rssi);
+}
+
+template <typename Base>
+void BasicSessionRecorder<Base>::onEmgData(myo::Myo* myo, uint64_t timestamp,
+                                           const int8_t* emg) {
+  write(replay::Record::emgData(myoIndex(myo), timestamp, emg));
+  Base::onEmgData(myo, timestamp, emg);
+}
+
+template <typename Base>
+uint8_t BasicSessionRecorder<Base>::myoIndex(myo::Myo* myo) {
+  for (std::size_t i = 0; i < myos_.size(); ++i) {
+    if (myos_[i] == myo) {
+      return i;
+    }
+  }
+  myos_.push_back(myo);
+  return myos_.size() - 1;
+}
+
+template <typename Base>
+void BasicSessionRecorder<Base>::write(const replay::Record& record) {
+  buffer_.push_back(record);
+  if (buffer_.size() == kBufferSize) {
+    writeBuffer();
+  }
+}
+
+template <typename Base>
+void BasicSessionRecorder<Base>::writeBuffer() {
+  if (good_ && std::fwrite(buffer_.data(), sizeof(replay::Record),
+                          buffer_.size(), file_) != buffer_.size()) {
+    good_ = false;
+  }
+  buffer_.clear();
+}
+}
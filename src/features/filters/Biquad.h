@@ -0,0 +1,392 @@
+/* Infinite Impulse Response (IIR) filters made of a cascade of second order
+ * sections (biquads). Each section computes
+ *
+ *   y[n] = b0 * x[n] + b1 * x[n - 1] + b2 * x[n - 2]
+ *          - a1 * y[n - 1] - a2 * y[n - 2]
+ *
+ * and feeds the next. The namespace butterworth below designs low-pass,
+ * high-pass and band-pass cascades from their cutoffs and the sample rate.
+ * The designs are constexpr, so that a filter whose cutoffs are constants has
+ * its coefficients computed at compile time:
+ *
+ *   constexpr auto kSmooth = butterworth::lowPass<4>(5, 50);
+ *
+ * For the same smoothing, a Butterworth low-pass lags much less than a chain
+ * of exponential moving averages, and removes the frequencies above its cutoff
+ * much more sharply. The IMU data of a Myo arrives at 50 Hz.
+ *
+ * Every component of a sample is filtered at once (see core/Float4.h). The
+ * filter is primed with its first sample as if that sample had always been the
+ * input, so that there is no step at the start. BiquadCascadeChannel filters
+ * one stream of samples and can be used on its own for other streams.
+ *
+ * See StaticInfiniteImpulseResponse.h for more info on IIR filters.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <myo/myo.hpp>
+
+#include "Filter.h"
+#include "InfiniteImpulseResponse.h"
+#include "../../core/ConstexprMath.h"
+#include "../../core/DeviceListenerWrapper.h"
+#include "../../core/Float4.h"
+#include "../../core/IndexSequence.h"
+
+namespace features {
+namespace filters {
+// The coefficients of one section, normalized so that a0 is 1.
+struct BiquadSection {
+  double b0, b1, b2, a1, a2;
+};
+
+template <std::size_t NumSections>
+struct BiquadCascade {
+  // From the first section the samples go through to the last.
+  BiquadSection sections[NumSections];
+};
+
+template <std::size_t NumSections, typename Lanes = core::Float4>
+class BiquadCascadeChannel {
+ public:
+  explicit BiquadCascadeChannel(const BiquadCascade<NumSections>& cascade);
+
+  // Adds a sample and returns the filtered output.
+  Lanes update(const Lanes& sample);
+  // Forgets every sample seen so far.
+  void reset();
+
+ private:
+  // A section in transposed direct form II, which keeps two values of state
+  // instead of the last two inputs and outputs.
+  struct Section {
+    Lanes b0, b1, b2, a1, a2;
+    // The section's gain for a constant input.
+    Lanes dc_gain;
+    Lanes s1, s2;
+  };
+
+  std::array<Section, NumSections> sections_;
+  bool has_samples_;
+};
+
+template <std::size_t NumSections, typename Base = core::DeviceListenerWrapper>
+class BasicBiquadFilter : public BasicFilter<Base>,
+                          public InfiniteImpulseResponseTypes {
+ public:
+  BasicBiquadFilter(core::DeviceListenerWrapper& parent_feature,
+                    DataFlags flags,
+                    const BiquadCascade<NumSections>& cascade);
+
+  virtual void onOrientationData(
+      myo::Myo* myo, uint64_t timestamp,
+      const myo::Quaternion<float>& rotation) override;
+  virtual void onAccelerometerData(
+      myo::Myo* myo, uint64_t timestamp,
+      const myo::Vector3<float>& acceleration) override;
+  virtual void onGyroscopeData(myo::Myo* myo, uint64_t timestamp,
+                               const myo::Vector3<float>& gyro) override;
+  virtual void onOrientationDataBatch(
+      myo::Myo* myo, const core::OrientationBatch& batch) override;
+  virtual void onAccelerometerDataBatch(
+      myo::Myo* myo, const core::VectorBatch& batch) override;
+  virtual void onGyroscopeDataBatch(myo::Myo* myo,
+                                    const core::VectorBatch& batch) override;
+
+ private:
+  myo::Quaternion<float> updateOrientation(
+      const myo::Quaternion<float>& rotation);
+
+  const DataFlags flags_;
+  BiquadCascadeChannel<NumSections> orientation_channel_;
+  BiquadCascadeChannel<NumSections> accelerometer_channel_;
+  BiquadCascadeChannel<NumSections> gyroscope_channel_;
+  OrientationFilterMode orientation_mode_;
+};
+
+template <std::size_t NumSections>
+using BiquadFilter = BasicBiquadFilter<NumSections>;
+
+// Butterworth designs, by the bilinear transform with the cutoffs prewarped,
+// from Robert Bristow-Johnson's Audio EQ Cookbook. Higher orders remove the
+// stop band more sharply, at the cost of more delay and one section per two
+// orders. Frequencies are in Hz and must be between 0 and half the sample
+// rate.
+namespace butterworth {
+// A single section with the given quality. The quality of a second order
+// Butterworth filter is 1 / sqrt(2).
+constexpr BiquadSection lowPassSection(double cutoff_hz, double sample_rate_hz,
+                                       double quality);
+constexpr BiquadSection highPassSection(double cutoff_hz,
+                                        double sample_rate_hz,
+                                        double quality);
+// The quality of section k of a filter of the given order.
+constexpr double sectionQuality(std::size_t k, std::size_t order);
+
+// Unity gain below cutoff_hz. Order must be even.
+template <std::size_t Order>
+constexpr BiquadCascade<Order / 2> lowPass(double cutoff_hz,
+                                           double sample_rate_hz);
+// Unity gain above cutoff_hz. Order must be even.
+template <std::size_t Order>
+constexpr BiquadCascade<Order / 2> highPass(double cutoff_hz,
+                                            double sample_rate_hz);
+// A high-pass at low_hz followed by a low-pass at high_hz, each of the given
+// order, so about unity gain between them if they are well apart. Order must
+// be even.
+template <std::size_t Order>
+constexpr BiquadCascade<Order> bandPass(double low_hz, double high_hz,
+                                        double sample_rate_hz);
+}
+
+template <std::size_t NumSections, typename Lanes>
+BiquadCascadeChannel<NumSections, Lanes>::BiquadCascadeChannel(
+    const BiquadCascade<NumSections>& cascade)
+    : has_samples_(false) {
+  static_assert(NumSections > 0, "A cascade needs at least one section.");
+  for (std::size_t i = 0; i < NumSections; ++i) {
+    const BiquadSection& from = cascade.sections[i];
+    Section& to = sections_[i];
+    to.b0 = Lanes(float(from.b0));
+    to.b1 = Lanes(float(from.b1));
+    to.b2 = Lanes(float(from.b2));
+    to.a1 = Lanes(float(from.a1));
+    to.a2 = Lanes(float(from.a2));
+    to.dc_gain = Lanes(float((from.b0 + from.b1 + from.b2) /
+                             (1 + from.a1 + from.a2)));
+  }
+}
+
+template <std::size_t NumSections, typename Lanes>
+Lanes BiquadCascadeChannel<NumSections, Lanes>::update(const Lanes& sample) {
+  Lanes x = sample;
+  if (!has_samples_) {
+    // The state of each section when its input has always been constant.
+    for (Section& section : sections_) {
+      const Lanes y = section.dc_gain * x;
+      section.s1 = y - section.b0 * x;
+      section.s2 = section.b2 * x - section.a2 * y;
+      x = y;
+    }
+    x = sample;
+    has_samples_ = true;
+  }
+  for (Section& section : sections_) {
+    const Lanes y = section.b0 * x + section.s1;
+    section.s1 = section.b1 * x - section.a1 * y + section.s2;
+    section.s2 = section.b2 * x - section.a2 * y;
+    x = y;
+  }
+  return x;
+}
+
+template <std::size_t NumSections, typename Lanes>
+void BiquadCascadeChannel<NumSections, Lanes>::reset() {
+  has_samples_ = false;
+}
+
+template <std::size_t NumSections, typename Base>
+BasicBiquadFilter<NumSections, Base>::BasicBiquadFilter(
+    core::DeviceListenerWrapper& parent_feature, DataFlags flags,
+    const BiquadCascade<NumSections>& cascade)
+    : flags_(flags),
+      orientation_channel_(cascade),
+      accelerometer_channel_(cascade),
+      gyroscope_channel_(cascade),
+      orientation_mode_((flags & QuaternionOrientation) != 0) {
+  parent_feature.addChildFeature(this);
+}
+
+template <std::size_t NumSections, typename Base>
+void BasicBiquadFilter<NumSections, Base>::onOrientationData(
+    myo::Myo* myo, uint64_t timestamp,
+    const myo::Quaternion<float>& rotation) {
+  if (flags_ & OrientationData) {
+    Base::onOrientationData(myo, timestamp, updateOrientation(rotation));
+  } else {
+    Base::onOrientationData(myo, timestamp, rotation);
+  }
+}
+
+template <std::size_t NumSections, typename Base>
+void BasicBiquadFilter<NumSections, Base>::onAccelerometerData(
+    myo::Myo* myo, uint64_t timestamp,
+    const myo::Vector3<float>& acceleration) {
+  if (flags_ & AccelerometerData) {
+    Base::onAccelerometerData(
+        myo, timestamp,
+        accelerometer_channel_.update(core::Float4(acceleration)).toVector3());
+  } else {
+    Base::onAccelerometerData(myo, timestamp, acceleration);
+  }
+}
+
+template <std::size_t NumSections, typename Base>
+void BasicBiquadFilter<NumSections, Base>::onGyroscopeData(
+    myo::Myo* myo, uint64_t timestamp, const myo::Vector3<float>& gyro) {
+  if (flags_ & GyroscopeData) {
+    Base::onGyroscopeData(
+        myo, timestamp,
+        gyroscope_channel_.update(core::Float4(gyro)).toVector3());
+  } else {
+    Base::onGyroscopeData(myo, timestamp, gyro);
+  }
+}
+
+template <std::size_t NumSections, typename Base>
+void BasicBiquadFilter<NumSections, Base>::onOrientationDataBatch(
+    myo::Myo* myo, const core::OrientationBatch& batch) {
+  if (flags_ & OrientationData) {
+    this->filterOrientationDataBatch(
+        myo, batch, [this](uint64_t, const myo::Quaternion<float>& rotation) {
+          return updateOrientation(rotation);
+        });
+  } else {
+    Base::forwardOrientationDataBatch(myo, batch);
+  }
+}
+
+template <std::size_t NumSections, typename Base>
+void BasicBiquadFilter<NumSections, Base>::onAccelerometerDataBatch(
+    myo::Myo* myo, const core::VectorBatch& batch) {
+  if (flags_ & AccelerometerData) {
+    this->filterAccelerometerDataBatch(
+        myo, batch, [this](uint64_t, const myo::Vector3<float>& acceleration) {
+          return accelerometer_channel_.update(core::Float4(acceleration))
+              .toVector3();
+        });
+  } else {
+    Base::forwardAccelerometerDataBatch(myo, batch);
+  }
+}
+
+template <std::size_t NumSections, typename Base>
+void BasicBiquadFilter<NumSections, Base>::onGyroscopeDataBatch(
+    myo::Myo* myo, const core::VectorBatch& batch) {
+  if (flags_ & GyroscopeData) {
+    this->filterGyroscopeDataBatch(
+        myo, batch, [this](uint64_t, const myo::Vector3<float>& gyro) {
+          return gyroscope_channel_.update(core::Float4(gyro)).toVector3();
+        });
+  } else {
+    Base::forwardGyroscopeDataBatch(myo, batch);
+  }
+}
+
+template <std::size_t NumSections, typename Base>
+myo::Quaternion<float> BasicBiquadFilter<NumSections, Base>::updateOrientation(
+    const myo::Quaternion<float>& rotation) {
+  const core::Float4 input = orientation_mode_.input(core::Float4(rotation));
+  return orientation_mode_.output(orientation_channel_.update(input))
+      .toQuaternion();
+}
+
+namespace butterworth {
+// The designs are written as single return statements, as C++11 requires of
+// constexpr functions.
+namespace detail {
+// Divides every coefficient by a0.
+constexpr BiquadSection normalize(double b0, double b1, double b2, double a0,
+                                  double a1, double a2) {
+  return BiquadSection{b0 / a0, b1 / a0, b2 / a0, a1 / a0, a2 / a0};
+}
+
+// w0 is the cutoff in radians per sample.
+constexpr double alpha(double w0, double quality) {
+  return core::constexprSin(w0) / (2 * quality);
+}
+
+constexpr BiquadSection lowPassSection(double cos_w0, double alpha) {
+  return normalize((1 - cos_w0) / 2, 1 - cos_w0, (1 - cos_w0) / 2, 1 + alpha,
+                   -2 * cos_w0, 1 - alpha);
+}
+
+constexpr BiquadSection highPassSection(double cos_w0, double alpha) {
+  return normalize((1 + cos_w0) / 2, -(1 + cos_w0), (1 + cos_w0) / 2,
+                   1 + alpha, -2 * cos_w0, 1 - alpha);
+}
+
+template <std::size_t Order, std::size_t... K>
+constexpr BiquadCascade<Order / 2> lowPass(double cutoff_hz,
+                                           double sample_rate_hz,
+                                           core::IndexSequence<K...>) {
+  return BiquadCascade<Order / 2>{{butterworth::lowPassSection(
+      cutoff_hz, sample_rate_hz, sectionQuality(K, Order))...}};
+}
+
+template <std::size_t Order, std::size_t... K>
+constexpr BiquadCascade<Order / 2> highPass(double cutoff_hz,
+                                            double sample_rate_hz,
+                                            core::IndexSequence<K...>) {
+  return BiquadCascade<Order / 2>{{butterworth::highPassSection(
+      cutoff_hz, sample_rate_hz, sectionQuality(K, Order))...}};
+}
+
+// The first Order / 2 sections are the high-pass.
+template <std::size_t Order, std::size_t... K>
+constexpr BiquadCascade<Order> bandPass(double low_hz, double high_hz,
+                                        double sample_rate_hz,
+                                        core::IndexSequence<K...>) {
+  return BiquadCascade<Order>{
+      {(K < Order / 2
+            ? butterworth::highPassSection(low_hz, sample_rate_hz,
+                                           sectionQuality(K, Order))
+            : butterworth::lowPassSection(
+                  high_hz, sample_rate_hz,
+                  sectionQuality(K - Order / 2, Order)))...}};
+}
+}
+
+constexpr BiquadSection lowPassSection(double cutoff_hz, double sample_rate_hz,
+                                       double quality) {
+  return detail::lowPassSection(
+      core::constexprCos(2 * core::kPi * cutoff_hz / sample_rate_hz),
+      detail::alpha(2 * core::kPi * cutoff_hz / sample_rate_hz, quality));
+}
+
+constexpr BiquadSection highPassSection(double cutoff_hz,
+                                        double sample_rate_hz,
+                                        double quality) {
+  return detail::highPassSection(
+      core::constexprCos(2 * core::kPi * cutoff_hz / sample_rate_hz),
+      detail::alpha(2 * core::kPi * cutoff_hz / sample_rate_hz, quality));
+}
+
+// The poles of a Butterworth filter are evenly spaced on the unit circle;
+// section k takes the pair at angles +-pi * (2k + 1) / (2 * order).
+constexpr double sectionQuality(std::size_t k, std::size_t order) {
+  return 1 / (2 * core::constexprCos(core::kPi * (2 * k + 1) / (2 * order)));
+}
+
+template <std::size_t Order>
+constexpr BiquadCascade<Order / 2> lowPass(double cutoff_hz,
+                                           double sample_rate_hz) {
+  static_assert(Order > 0 && Order % 2 == 0, "The order must be even.");
+  return detail::lowPass<Order>(
+      cutoff_hz, sample_rate_hz,
+      typename core::MakeIndexSequence<Order / 2>::type());
+}
+
+template <std::size_t Order>
+constexpr BiquadCascade<Order / 2> highPass(double cutoff_hz,
+                                            double sample_rate_hz) {
+  static_assert(Order > 0 && Order % 2 == 0, "The order must be even.");
+  return detail::highPass<Order>(
+      cutoff_hz, sample_rate_hz,
+      typename core::MakeIndexSequence<Order / 2>::type());
+}
+
+template <std::size_t Order>
+constexpr BiquadCascade<Order> bandPass(double low_hz, double high_hz,
+                                        double sample_rate_hz) {
+  static_assert(Order > 0 && Order % 2 == 0, "The order must be even.");
+  return detail::bandPass<Order>(
+      low_hz, high_hz, sample_rate_hz,
+      typename core::MakeIndexSequence<Order>::type());
+}
+}
+}
+}
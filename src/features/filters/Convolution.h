@@ -0,0 +1,303 @@
+/* A Finite Impulse Response (FIR) filter with arbitrary taps. Each output is
+ *
+ *   y[n] = taps[0] * x[n] + taps[1] * x[n - 1] + ... + taps[k] * x[n - k]
+ *
+ * so the taps decide whether it is e.g. a low-pass, band-pass or
+ * differentiating filter. The namespace taps below designs common ones.
+ * Until enough samples have been seen, the samples before the first are taken
+ * to be equal to it.
+ *
+ * Every component of a sample is filtered at once (see core/Float4.h), and the
+ * recent samples are kept contiguous in memory so that the convolution is a
+ * single pass over them. ConvolutionChannel filters one stream of samples and
+ * can be used on its own for other streams.
+ *
+ * See FiniteImpulseResponse.h for more info on FIR filters.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <myo/myo.hpp>
+#include <vector>
+
+#include "Filter.h"
+#include "FiniteImpulseResponse.h"
+#include "../../core/DeviceListenerWrapper.h"
+#include "../../core/Float4.h"
+
+namespace features {
+namespace filters {
+template <typename Lanes = core::Float4>
+class ConvolutionChannel {
+ public:
+  // taps must not be empty.
+  explicit ConvolutionChannel(const std::vector<float>& taps);
+
+  // Adds a sample and returns the filtered output.
+  Lanes update(const Lanes& sample);
+  // Forgets every sample seen so far.
+  void reset();
+
+  std::size_t numTaps() const;
+
+ private:
+  // Each tap in every lane, from the oldest sample's tap to the newest's.
+  std::vector<Lanes> reversed_taps_;
+  // Every sample is written twice, numTaps() apart, so that the last
+  // numTaps() samples are always contiguous, from history_[position_ + 1] to
+  // history_[position_ + numTaps()].
+  std::vector<Lanes> history_;
+  std::size_t position_;
+  bool has_samples_;
+};
+
+template <typename Base = core::DeviceListenerWrapper>
+class BasicConvolution : public BasicFilter<Base>,
+                         public FiniteImpulseResponseTypes {
+ public:
+  BasicConvolution(core::DeviceListenerWrapper& parent_feature,
+                   DataFlags flags, const std::vector<float>& taps);
+
+  virtual void onOrientationData(
+      myo::Myo* myo, uint64_t timestamp,
+      const myo::Quaternion<float>& rotation) override;
+  virtual void onAccelerometerData(
+      myo::Myo* myo, uint64_t timestamp,
+      const myo::Vector3<float>& acceleration) override;
+  virtual void onGyroscopeData(myo::Myo* myo, uint64_t timestamp,
+                               const myo::Vector3<float>& gyro) override;
+  virtual void onOrientationDataBatch(
+      myo::Myo* myo, const core::OrientationBatch& batch) override;
+  virtual void onAccelerometerDataBatch(
+      myo::Myo* myo, const core::VectorBatch& batch) override;
+  virtual void onGyroscopeDataBatch(myo::Myo* myo,
+                                    const core::VectorBatch& batch) override;
+
+ private:
+  myo::Quaternion<float> updateOrientation(
+      const myo::Quaternion<float>& rotation);
+
+  const DataFlags flags_;
+  ConvolutionChannel<> orientation_channel_;
+  ConvolutionChannel<> accelerometer_channel_;
+  ConvolutionChannel<> gyroscope_channel_;
+  OrientationFilterMode orientation_mode_;
+};
+
+typedef BasicConvolution<> Convolution;
+
+// Windowed-sinc designs with a Hamming window. More taps give a sharper
+// transition between the pass and stop bands, at the cost of more delay: the
+// output lags by (num_taps - 1) / 2 samples. Frequencies are in Hz.
+namespace taps {
+// Unity gain below cutoff_hz.
+std::vector<float> lowPass(float cutoff_hz, float sample_rate_hz,
+                           std::size_t num_taps);
+// Unity gain above cutoff_hz. num_taps must be odd.
+std::vector<float> highPass(float cutoff_hz, float sample_rate_hz,
+                            std::size_t num_taps);
+// Unity gain between low_hz and high_hz.
+std::vector<float> bandPass(float low_hz, float high_hz, float sample_rate_hz,
+                            std::size_t num_taps);
+// The rate of change per second, by central difference. The output lags by
+// one sample.
+std::vector<float> differentiator(float sample_rate_hz);
+}
+
+template <typename Lanes>
+ConvolutionChannel<Lanes>::ConvolutionChannel(const std::vector<float>& taps)
+    : history_(2 * taps.size()), position_(0), has_samples_(false) {
+  for (auto tap = taps.rbegin(); tap != taps.rend(); ++tap) {
+    reversed_taps_.push_back(Lanes(*tap));
+  }
+}
+
+template <typename Lanes>
+Lanes ConvolutionChannel<Lanes>::update(const Lanes& sample) {
+  const std::size_t num_taps = reversed_taps_.size();
+  if (!has_samples_) {
+    std::fill(history_.begin(), history_.end(), sample);
+    has_samples_ = true;
+  }
+  position_ = position_ + 1 == num_taps ? 0 : position_ + 1;
+  history_[position_] = sample;
+  history_[position_ + num_taps] = sample;
+
+  // Two sums so that consecutive multiply-adds don't wait on each other.
+  const Lanes* window = &history_[position_ + 1];
+  const Lanes* taps = reversed_taps_.data();
+  Lanes sum0(0.f), sum1(0.f);
+  std::size_t i = 0;
+  for (; i + 1 < num_taps; i += 2) {
+    sum0 = sum0 + taps[i] * window[i];
+    sum1 = sum1 + taps[i + 1] * window[i + 1];
+  }
+  if (i < num_taps) {
+    sum0 = sum0 + taps[i] * window[i];
+  }
+  return sum0 + sum1;
+}
+
+template <typename Lanes>
+void ConvolutionChannel<Lanes>::reset() {
+  has_samples_ = false;
+}
+
+template <typename Lanes>
+std::size_t ConvolutionChannel<Lanes>::numTaps() const {
+  return reversed_taps_.size();
+}
+
+template <typename Base>
+BasicConvolution<Base>::BasicConvolution(
+    core::DeviceListenerWrapper& parent_feature, DataFlags flags,
+    const std::vector<float>& taps)
+    : flags_(flags),
+      orientation_channel_(taps),
+      accelerometer_channel_(taps),
+      gyroscope_channel_(taps),
+      orientation_mode_((flags & QuaternionOrientation) != 0) {
+  parent_feature.addChildFeature(this);
+}
+
+template <typename Base>
+void BasicConvolution<Base>::onOrientationData(
+    myo::Myo* myo, uint64_t timestamp,
+    const myo::Quaternion<float>& rotation) {
+  if (flags_ & OrientationData) {
+    Base::onOrientationData(myo, timestamp, updateOrientation(rotation));
+  } else {
+    Base::onOrientationData(myo, timestamp, rotation);
+  }
+}
+
+template <typename Base>
+void BasicConvolution<Base>::onAccelerometerData(
+    myo::Myo* myo, uint64_t timestamp,
+    const myo::Vector3<float>& acceleration) {
+  if (flags_ & AccelerometerData) {
+    Base::onAccelerometerData(
+        myo, timestamp,
+        accelerometer_channel_.update(core::Float4(acceleration)).toVector3());
+  } else {
+    Base::onAccelerometerData(myo, timestamp, acceleration);
+  }
+}
+
+template <typename Base>
+void BasicConvolution<Base>::onGyroscopeData(myo::Myo* myo,
+                                             uint64_t timestamp,
+                                             const myo::Vector3<float>& gyro) {
+  if (flags_ & GyroscopeData) {
+    Base::onGyroscopeData(
+        myo, timestamp,
+        gyroscope_channel_.update(core::Float4(gyro)).toVector3());
+  } else {
+    Base::onGyroscopeData(myo, timestamp, gyro);
+  }
+}
+
+template <typename Base>
+void BasicConvolution<Base>::onOrientationDataBatch(
+    myo::Myo* myo, const core::OrientationBatch& batch) {
+  if (flags_ & OrientationData) {
+    this->filterOrientationDataBatch(
+        myo, batch, [this](uint64_t, const myo::Quaternion<float>& rotation) {
+          return updateOrientation(rotation);
+        });
+  } else {
+    Base::forwardOrientationDataBatch(myo, batch);
+  }
+}
+
+template <typename Base>
+void BasicConvolution<Base>::onAccelerometerDataBatch(
+    myo::Myo* myo, const core::VectorBatch& batch) {
+  if (flags_ & AccelerometerData) {
+    this->filterAccelerometerDataBatch(
+        myo, batch, [this](uint64_t, const myo::Vector3<float>& acceleration) {
+          return accelerometer_channel_.update(core::Float4(acceleration))
+              .toVector3();
+        });
+  } else {
+    Base::forwardAccelerometerDataBatch(myo, batch);
+  }
+}
+
+template <typename Base>
+void BasicConvolution<Base>::onGyroscopeDataBatch(
+    myo::Myo* myo, const core::VectorBatch& batch) {
+  if (flags_ & GyroscopeData) {
+    this->filterGyroscopeDataBatch(
+        myo, batch, [this](uint64_t, const myo::Vector3<float>& gyro) {
+          return gyroscope_channel_.update(core::Float4(gyro)).toVector3();
+        });
+  } else {
+    Base::forwardGyroscopeDataBatch(myo, batch);
+  }
+}
+
+template <typename Base>
+myo::Quaternion<float> BasicConvolution<Base>::updateOrientation(
+    const myo::Quaternion<float>& rotation) {
+  const core::Float4 input = orientation_mode_.input(core::Float4(rotation));
+  return orientation_mode_.output(orientation_channel_.update(input))
+      .toQuaternion();
+}
+
+namespace taps {
+std::vector<float> lowPass(float cutoff_hz, float sample_rate_hz,
+                           std::size_t num_taps) {
+  const double pi = 3.14159265358979323846;
+  const double cutoff = cutoff_hz / sample_rate_hz;
+  const double middle = (num_taps - 1) / 2.0;
+  std::vector<double> taps(num_taps);
+  double sum = 0;
+  for (std::size_t i = 0; i < num_taps; ++i) {
+    double t = i - middle;
+    double sinc =
+        t == 0 ? 2 * cutoff : std::sin(2 * pi * cutoff * t) / (pi * t);
+    double window =
+        num_taps == 1 ? 1 : 0.54 - 0.46 * std::cos(2 * pi * i / (num_taps - 1));
+    taps[i] = sinc * window;
+    sum += taps[i];
+  }
+  // Scaled for exactly unity gain at 0 Hz.
+  std::vector<float> normalized;
+  for (double tap : taps) {
+    normalized.push_back(static_cast<float>(tap / sum));
+  }
+  return normalized;
+}
+
+// Subtracting a low-pass filter from the identity filter leaves the high
+// frequencies.
+std::vector<float> highPass(float cutoff_hz, float sample_rate_hz,
+                            std::size_t num_taps) {
+  std::vector<float> taps = lowPass(cutoff_hz, sample_rate_hz, num_taps);
+  for (float& tap : taps) {
+    tap = -tap;
+  }
+  taps[num_taps / 2] += 1;
+  return taps;
+}
+
+std::vector<float> bandPass(float low_hz, float high_hz, float sample_rate_hz,
+                            std::size_t num_taps) {
+  std::vector<float> taps = lowPass(high_hz, sample_rate_hz, num_taps);
+  std::vector<float> below = lowPass(low_hz, sample_rate_hz, num_taps);
+  for (std::size_t i = 0; i < num_taps; ++i) {
+    taps[i] -= below[i];
+  }
+  return taps;
+}
+
+std::vector<float> differentiator(float sample_rate_hz) {
+  return {sample_rate_hz / 2, 0, -sample_rate_hz / 2};
+}
+}
+}
+}
@@ -1,22 +1,28 @@
 /* Debounce class debounces poses to reduce accidental poses. Only poses held
  * for at least the debounce delay will trigger a pose. A pose which is held for
  * longer than the debounce delay will trigger the virtual function
- * onPose(myo::Myo*, Pose).
+ * onPose(myo::Myo*, Pose). How long a pose is held for is measured with the
+ * given clock, see Clock.h.
  */
 
 #pragma once
 
 #include <myo/myo.hpp>
 
+#include "../../core/Clock.h"
 #include "../../core/DeviceListenerWrapper.h"
 #include "../../core/Pose.h"
-#include "../../../lib/Basic-Timer/BasicTimer.h"
 
 namespace features {
 namespace filters {
-class Debounce : public core::DeviceListenerWrapper {
+template <typename Base = core::DeviceListenerWrapper>
+class BasicDebounce : public Base {
  public:
-  Debounce(core::DeviceListenerWrapper& parent_feature, int timeout_ms = 10);
+  BasicDebounce(core::DeviceListenerWrapper& parent_feature,
+                int timeout_ms = 10,
+                core::Clock& clock = core::WallClock::instance());
+
+  virtual core::EventMask handledEvents() const override;
 
   virtual void onPose(myo::Myo* myo, uint64_t timestamp,
                       const std::shared_ptr<core::Pose>& pose) override;
@@ -26,48 +32,65 @@ class Debounce : public core::DeviceListenerWrapper {
   void debounceLastPose(myo::Myo* myo);
 
   int timeout_ms_;
+  core::Clock& clock_;
   std::shared_ptr<core::Pose> last_pose_, last_debounced_pose_;
-  BasicTimer last_pose_time_;
+  uint64_t last_pose_time_;
   uint64_t last_pose_timestamp_;
 };
 
-Debounce::Debounce(core::DeviceListenerWrapper& parent_feature, int timeout_ms)
+typedef BasicDebounce<> Debounce;
+
+template <typename Base>
+BasicDebounce<Base>::BasicDebounce(core::DeviceListenerWrapper& parent_feature,
+                                   int timeout_ms, core::Clock& clock)
     : timeout_ms_(timeout_ms),
-      last_pose_(new core::Pose(core::Pose::rest)),
+      clock_(clock),
+      last_pose_(core::Pose::interned(core::Pose::rest)),
       last_debounced_pose_(last_pose_),
+      last_pose_time_(clock.now()),
       last_pose_timestamp_(0) {
   parent_feature.addChildFeature(this);
-  last_pose_time_.tick();
 }
 
-void Debounce::onPose(myo::Myo* myo, uint64_t timestamp,
-                      const std::shared_ptr<core::Pose>& pose) {
+template <typename Base>
+core::EventMask BasicDebounce<Base>::handledEvents() const {
+  return core::EventBit(core::Event::Pose) |
+         core::EventBit(core::Event::Periodic);
+}
+
+template <typename Base>
+void BasicDebounce<Base>::onPose(myo::Myo* myo, uint64_t timestamp,
+                                 const std::shared_ptr<core::Pose>& pose) {
+  // The timestamps of the poses say how long the last pose was held for
+  // regardless of the clock.
   if (timestamp - last_pose_timestamp_ > 1000 * timeout_ms_ &&
       *last_pose_ != *last_debounced_pose_) {
     debounceLastPose(myo);
   }
   last_pose_ = pose;
-  last_pose_time_.tick();
+  last_pose_time_ = clock_.now();
   last_pose_timestamp_ = timestamp;
   // Don't debounce doubleTaps because of their uniqely short duration.
   if (*last_pose_ == core::Pose::doubleTap) {
     last_debounced_pose_ = last_pose_;
-    core::DeviceListenerWrapper::onPose(myo, 0, last_pose_);
+    Base::onPose(myo, timestamp, last_pose_);
   }
 }
 
-void Debounce::onPeriodic(myo::Myo* myo) {
-  if (last_pose_time_.millisecondsSinceTick() > timeout_ms_ &&
+template <typename Base>
+void BasicDebounce<Base>::onPeriodic(myo::Myo* myo) {
+  if (core::millisecondsBetween(last_pose_time_, clock_.now()) > timeout_ms_ &&
       *last_pose_ != *last_debounced_pose_) {
     debounceLastPose(myo);
   }
-  core::DeviceListenerWrapper::onPeriodic(myo);
+  Base::onPeriodic(myo);
 }
 
-void Debounce::debounceLastPose(myo::Myo* myo) {
+template <typename Base>
+void BasicDebounce<Base>::debounceLastPose(myo::Myo* myo) {
   last_debounced_pose_ = last_pose_;
-  last_pose_time_.tick();
-  core::DeviceListenerWrapper::onPose(myo, last_pose_timestamp_, last_pose_);
+  last_pose_time_ = clock_.now();
+  Base::onPose(myo, last_pose_timestamp_, last_pose_);
 }
 }
 }
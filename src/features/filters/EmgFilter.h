@@ -0,0 +1,257 @@
+/* Conditions the EMG data for features which look at muscle activity. Each
+ * sample goes through
+ *
+ *   1. DC removal, by subtracting a slow moving average of the sample,
+ *   2. an optional second order section, e.g. a notch at the mains frequency
+ *      or a band-pass around the frequencies of muscle activity,
+ *   3. full-wave rectification, and
+ *   4. a fast moving average of the rectified sample, the envelope.
+ *
+ * The output of step 2 replaces the EMG data passed on to child features, and
+ * the envelope is passed on with onEmgEnvelope right after it. A batch of EMG
+ * data is passed on as one batch unless a child feature wants the envelope, in
+ * which case its samples are passed on one at a time so that the events keep
+ * that order.
+ *
+ * Everything is computed in 16 bit fixed point, with the EMG data scaled by
+ * core::kEmgEnvelopeScale, and all eight channels are filtered at once (see
+ * core/Int16x8.h). The moving averages are exponential, and update with a
+ * shift instead of a multiplication: a shift of k averages over about 2^k
+ * samples. At the Myo's 200 Hz, the default DC shift of 5 removes
+ * frequencies below about 1 Hz and the default envelope shift of 4 follows
+ * changes of up to about 2 Hz. Since an average stops moving once the
+ * difference rounds to 0, the DC removal may leave an offset of up to
+ * 2^(dc_shift - 1) / core::kEmgEnvelopeScale, half a unit by default.
+ *
+ * EmgFilterChannel filters one stream of samples and can be used on its own,
+ * e.g. to filter the EMG data of several Myos.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <myo/myo.hpp>
+
+#include "Filter.h"
+#include "../../core/DeviceListenerWrapper.h"
+#include "../../core/Int16x8.h"
+#include "../../core/SampleBatch.h"
+
+namespace features {
+namespace filters {
+// The section does not depend on the type of the filter, so it lives in a
+// separate class to be shared by every instantiation.
+class EmgFilterTypes {
+ public:
+  // The coefficients of a second order section,
+  //
+  //   y[n] = b0 * x[n] + b1 * x[n - 1] + b2 * x[n - 2]
+  //          - a1 * y[n - 1] - a2 * y[n - 2],
+  //
+  // as fixed point numbers with 14 fractional bits. Each is between -2 and 2.
+  struct Section {
+    int16_t b0, b1, b2, a1, a2;
+  };
+
+  // Frequencies are in Hz and must be between 0 and half the sample rate.
+  // A section which leaves the samples unchanged.
+  static Section passThrough();
+  // Removes hz, with a stop band about hz / quality wide.
+  static Section notch(float hz, float quality, float sample_rate_hz = 200);
+  // Unity gain at the geometric mean of low_hz and high_hz.
+  static Section bandPass(float low_hz, float high_hz,
+                          float sample_rate_hz = 200);
+
+ private:
+  // Normalizes the coefficients by a0 and converts them to fixed point.
+  static Section toFixedPoint(double b0, double b1, double b2, double a0,
+                              double a1, double a2);
+};
+
+template <typename Lanes = core::Int16x8>
+class EmgFilterChannel : public EmgFilterTypes {
+ public:
+  EmgFilterChannel(const Section& section, int dc_shift, int envelope_shift);
+
+  // Adds a sample and writes out the filtered sample and its envelope. Each
+  // holds eight channels.
+  void update(const int8_t* emg, int8_t* filtered, int16_t* envelope);
+  // Forgets every sample seen so far.
+  void reset();
+
+ private:
+  // Adds (value + half) >> shift to average, so that it rounds to nearest.
+  static Lanes approach(const Lanes& average, const Lanes& value, int shift);
+
+  const int dc_shift_;
+  const int envelope_shift_;
+  const Lanes b0_, b1_, b2_, a1_, a2_;
+  Lanes dc_;
+  // The last two inputs and outputs of the section.
+  Lanes x1_, x2_, y1_, y2_;
+  Lanes envelope_;
+  bool has_samples_;
+};
+
+template <typename Base = core::DeviceListenerWrapper>
+class BasicEmgFilter : public BasicFilter<Base>, public EmgFilterTypes {
+ public:
+  BasicEmgFilter(core::DeviceListenerWrapper& parent_feature,
+                 const Section& section = passThrough(), int dc_shift = 5,
+                 int envelope_shift = 4);
+
+  virtual core::EventMask subscribedEvents() override;
+
+  virtual void onEmgData(myo::Myo* myo, uint64_t timestamp,
+                         const int8_t* emg) override;
+  virtual void onEmgDataBatch(myo::Myo* myo,
+                              const core::EmgBatch& batch) override;
+
+ private:
+  EmgFilterChannel<> channel_;
+};
+
+typedef BasicEmgFilter<> EmgFilter;
+
+EmgFilterTypes::Section EmgFilterTypes::passThrough() {
+  return toFixedPoint(1, 0, 0, 1, 0, 0);
+}
+
+// From Robert Bristow-Johnson's Audio EQ Cookbook.
+EmgFilterTypes::Section EmgFilterTypes::notch(float hz, float quality,
+                                              float sample_rate_hz) {
+  const double pi = 3.14159265358979323846;
+  const double w0 = 2 * pi * hz / sample_rate_hz;
+  const double alpha = std::sin(w0) / (2 * quality);
+  return toFixedPoint(1, -2 * std::cos(w0), 1, 1 + alpha, -2 * std::cos(w0),
+                      1 - alpha);
+}
+
+EmgFilterTypes::Section EmgFilterTypes::bandPass(float low_hz, float high_hz,
+                                                 float sample_rate_hz) {
+  const double pi = 3.14159265358979323846;
+  const double center_hz = std::sqrt(double(low_hz) * high_hz);
+  const double w0 = 2 * pi * center_hz / sample_rate_hz;
+  const double alpha = std::sin(w0) * (high_hz - low_hz) / (2 * center_hz);
+  return toFixedPoint(alpha, 0, -alpha, 1 + alpha, -2 * std::cos(w0),
+                      1 - alpha);
+}
+
+EmgFilterTypes::Section EmgFilterTypes::toFixedPoint(double b0, double b1,
+                                                     double b2, double a0,
+                                                     double a1, double a2) {
+  auto convert = [a0](double coefficient) {
+    double fixed = std::round(coefficient / a0 * (1 << 14));
+    return static_cast<int16_t>(std::min(std::max(fixed, -32768.), 32767.));
+  };
+  return Section{convert(b0), convert(b1), convert(b2), convert(a1),
+                 convert(a2)};
+}
+
+template <typename Lanes>
+EmgFilterChannel<Lanes>::EmgFilterChannel(const Section& section,
+                                          int dc_shift, int envelope_shift)
+    : dc_shift_(dc_shift),
+      envelope_shift_(envelope_shift),
+      b0_(section.b0),
+      b1_(section.b1),
+      b2_(section.b2),
+      a1_(section.a1),
+      a2_(section.a2),
+      has_samples_(false) {}
+
+template <typename Lanes>
+void EmgFilterChannel<Lanes>::update(const int8_t* emg, int8_t* filtered,
+                                     int16_t* envelope) {
+  const int scale_bits = 5;
+  static_assert(core::kEmgEnvelopeScale == 1 << scale_bits,
+                "The envelope is in the filter's fixed point scale.");
+  const Lanes x = Lanes::load(emg) << scale_bits;
+  if (!has_samples_) {
+    // Start from the first sample's offset so that there is no step.
+    dc_ = x;
+    x1_ = x2_ = y1_ = y2_ = envelope_ = Lanes(0);
+    has_samples_ = true;
+  }
+  dc_ = approach(dc_, x, dc_shift_);
+  const Lanes x0 = x - dc_;
+
+  const Lanes y0 = b0_.mulQ14(x0) + b1_.mulQ14(x1_) + b2_.mulQ14(x2_) -
+                   a1_.mulQ14(y1_) - a2_.mulQ14(y2_);
+  x2_ = x1_;
+  x1_ = x0;
+  y2_ = y1_;
+  y1_ = y0;
+
+  envelope_ = approach(envelope_, y0.abs(), envelope_shift_);
+  ((y0 + Lanes(1 << (scale_bits - 1))) >> scale_bits).store(filtered);
+  envelope_.store(envelope);
+}
+
+template <typename Lanes>
+void EmgFilterChannel<Lanes>::reset() {
+  has_samples_ = false;
+}
+
+template <typename Lanes>
+Lanes EmgFilterChannel<Lanes>::approach(const Lanes& average,
+                                        const Lanes& value, int shift) {
+  if (shift == 0) {
+    return value;
+  }
+  return average +
+         ((value - average + Lanes(int16_t(1 << (shift - 1)))) >> shift);
+}
+
+template <typename Base>
+BasicEmgFilter<Base>::BasicEmgFilter(
+    core::DeviceListenerWrapper& parent_feature, const Section& section,
+    int dc_shift, int envelope_shift)
+    : channel_(section, dc_shift, envelope_shift) {
+  parent_feature.addChildFeature(this);
+}
+
+// The envelope is made from the EMG data, so a child which only wants the
+// envelope still needs the EMG data to be sent to this feature.
+template <typename Base>
+core::EventMask BasicEmgFilter<Base>::subscribedEvents() {
+  core::EventMask events = Base::subscribedEvents();
+  if (events & core::EventBit(core::Event::EmgEnvelope)) {
+    events |= core::EventBit(core::Event::EmgData);
+  }
+  return events;
+}
+
+template <typename Base>
+void BasicEmgFilter<Base>::onEmgData(myo::Myo* myo, uint64_t timestamp,
+                                     const int8_t* emg) {
+  int8_t filtered[8];
+  int16_t envelope[8];
+  channel_.update(emg, filtered, envelope);
+  Base::onEmgData(myo, timestamp, filtered);
+  Base::onEmgEnvelope(myo, timestamp, envelope);
+}
+
+template <typename Base>
+void BasicEmgFilter<Base>::onEmgDataBatch(myo::Myo* myo,
+                                          const core::EmgBatch& batch) {
+  if (Base::subscribedEvents() & core::EventBit(core::Event::EmgEnvelope)) {
+    for (std::size_t i = 0; i < batch.size; ++i) {
+      BasicEmgFilter::onEmgData(myo, batch.timestamps[i],
+                                batch.samples[i].data());
+    }
+    return;
+  }
+  this->filterEmgDataBatch(
+      myo, batch, [this](uint64_t, const core::EmgSample& emg) {
+        core::EmgSample filtered;
+        int16_t envelope[8];
+        channel_.update(emg.data(), filtered.data(), envelope);
+        return filtered;
+      });
+}
+}
+}
@@ -1,32 +1,56 @@
 /* A basic exponential moving average filter.
- * See InfiniteImpulseResponse.h for more info on IIR filters.
+ * See StaticInfiniteImpulseResponse.h for more info on IIR filters.
  * http://en.wikipedia.org/wiki/Moving_average#Exponential_moving_average
  */
 
 #pragma once
 
-#include "InfiniteImpulseResponse.h"
+#include "StaticInfiniteImpulseResponse.h"
 #include "../../core/DeviceListenerWrapper.h"
 
 namespace features {
 namespace filters {
-class ExponentialMovingAverage : public InfiniteImpulseResponse {
+// The filter's kernel, which can also be used with an
+// InfiniteImpulseResponseBank.
+class ExponentialMovingAverageKernel {
  public:
-  explicit ExponentialMovingAverage(core::DeviceListenerWrapper& parent_feature,
-                                    DataFlags flags, float alpha);
+  explicit ExponentialMovingAverageKernel(float alpha);
+
+  template <typename Lanes>
+  Lanes update(const Lanes& new_value, const Lanes& old_value) const;
 
  private:
-  virtual float Update(float new_value, float old_value) override;
+  float alpha_;
+  float one_minus_alpha_;
+};
+
+template <typename Base = core::DeviceListenerWrapper>
+class BasicExponentialMovingAverage
+    : public BasicStaticInfiniteImpulseResponse<ExponentialMovingAverageKernel,
+                                                Base> {
+ public:
+  typedef InfiniteImpulseResponseTypes::DataFlags DataFlags;
 
-  const float alpha_;
+  explicit BasicExponentialMovingAverage(
+      core::DeviceListenerWrapper& parent_feature, DataFlags flags,
+      float alpha);
 };
 
-ExponentialMovingAverage::ExponentialMovingAverage(
-    core::DeviceListenerWrapper& parent_feature, DataFlags flags, float alpha)
-    : InfiniteImpulseResponse(parent_feature, flags), alpha_(alpha) {}
+typedef BasicExponentialMovingAverage<> ExponentialMovingAverage;
+
+ExponentialMovingAverageKernel::ExponentialMovingAverageKernel(float alpha)
+    : alpha_(alpha), one_minus_alpha_(1 - alpha) {}
 
-float ExponentialMovingAverage::Update(float new_value, float old_value) {
-  return (alpha_ * new_value) + ((1 - alpha_) * old_value);
+template <typename Lanes>
+Lanes ExponentialMovingAverageKernel::update(const Lanes& new_value,
+                                             const Lanes& old_value) const {
+  return (Lanes(alpha_) * new_value) + (Lanes(one_minus_alpha_) * old_value);
 }
+
+template <typename Base>
+BasicExponentialMovingAverage<Base>::BasicExponentialMovingAverage(
+    core::DeviceListenerWrapper& parent_feature, DataFlags flags, float alpha)
+    : BasicStaticInfiniteImpulseResponse<ExponentialMovingAverageKernel, Base>(
+          parent_feature, flags, ExponentialMovingAverageKernel(alpha)) {}
 }
 }
@@ -0,0 +1,131 @@
+/* BasicFilter is the base of the filters, which replace the samples of some
+ * streams with filtered ones and pass every other event on unchanged.
+ *
+ * A filter keeps no state of its own worth updating if no child feature wants
+ * the filtered data, so it handles no events for itself, and the samples only
+ * reach it while some child subscribes to them (see handledEvents in
+ * core/DeviceListenerWrapper.h).
+ *
+ * A filter which handles batches passes each one through a filter*Batch
+ * method, which replaces every sample with update(timestamp, sample) and
+ * passes the filtered batch on to the child features:
+ *
+ *   this->filterAccelerometerDataBatch(
+ *       myo, batch,
+ *       [this](uint64_t, const myo::Vector3<float>& acceleration) {
+ *         return filterAcceleration(acceleration);
+ *       });
+ *
+ * The filtered samples are written to an array on the stack, kChunkSize
+ * samples at a time, and each chunk is passed on before the next is filtered,
+ * so that filtering a batch never allocates. A long batch therefore reaches the
+ * child features as several shorter ones.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <myo/myo.hpp>
+
+#include "../../core/DeviceListenerWrapper.h"
+#include "../../core/SampleBatch.h"
+
+namespace features {
+namespace filters {
+template <typename Base = core::DeviceListenerWrapper>
+class BasicFilter : public Base {
+ public:
+  // The most samples filtered and passed on at once.
+  static const std::size_t kChunkSize = 32;
+
+  virtual core::EventMask handledEvents() const override;
+
+ protected:
+  // Each passes on the batch with every sample replaced by
+  // update(timestamp, sample), which is called in order.
+  template <typename Update>
+  void filterOrientationDataBatch(myo::Myo* myo,
+                                  const core::OrientationBatch& batch,
+                                  Update update);
+  template <typename Update>
+  void filterAccelerometerDataBatch(myo::Myo* myo,
+                                    const core::VectorBatch& batch,
+                                    Update update);
+  template <typename Update>
+  void filterGyroscopeDataBatch(myo::Myo* myo, const core::VectorBatch& batch,
+                                Update update);
+  template <typename Update>
+  void filterEmgDataBatch(myo::Myo* myo, const core::EmgBatch& batch,
+                          Update update);
+
+ private:
+  // Calls forward with each chunk of the updated samples of the batch.
+  template <typename Sample, typename Update, typename Forward>
+  static void filterBatch(const core::SampleBatch<Sample>& batch,
+                          Update& update, Forward forward);
+};
+
+template <typename Base>
+core::EventMask BasicFilter<Base>::handledEvents() const {
+  return core::NoEvents;
+}
+
+template <typename Base>
+template <typename Update>
+void BasicFilter<Base>::filterOrientationDataBatch(
+    myo::Myo* myo, const core::OrientationBatch& batch, Update update) {
+  filterBatch(batch, update, [this, myo](const core::OrientationBatch& chunk) {
+    Base::forwardOrientationDataBatch(myo, chunk);
+  });
+}
+
+template <typename Base>
+template <typename Update>
+void BasicFilter<Base>::filterAccelerometerDataBatch(
+    myo::Myo* myo, const core::VectorBatch& batch, Update update) {
+  filterBatch(batch, update, [this, myo](const core::VectorBatch& chunk) {
+    Base::forwardAccelerometerDataBatch(myo, chunk);
+  });
+}
+
+template <typename Base>
+template <typename Update>
+void BasicFilter<Base>::filterGyroscopeDataBatch(
+    myo::Myo* myo, const core::VectorBatch& batch, Update update) {
+  filterBatch(batch, update, [this, myo](const core::VectorBatch& chunk) {
+    Base::forwardGyroscopeDataBatch(myo, chunk);
+  });
+}
+
+template <typename Base>
+template <typename Update>
+void BasicFilter<Base>::filterEmgDataBatch(myo::Myo* myo,
+                                           const core::EmgBatch& batch,
+                                           Update update) {
+  filterBatch(batch, update, [this, myo](const core::EmgBatch& chunk) {
+    Base::forwardEmgDataBatch(myo, chunk);
+  });
+}
+
+template <typename Base>
+template <typename Sample, typename Update, typename Forward>
+void BasicFilter<Base>::filterBatch(const core::SampleBatch<Sample>& batch,
+                                    Update& update, Forward forward) {
+  std::array<Sample, kChunkSize> filtered;
+  for (std::size_t begin = 0; begin < batch.size; begin += kChunkSize) {
+    std::size_t size = batch.size - begin;
+    if (size > kChunkSize) {
+      size = kChunkSize;
+    }
+    for (std::size_t i = 0; i < size; ++i) {
+      filtered[i] =
+          update(batch.timestamps[begin + i], batch.samples[begin + i]);
+    }
+    forward(core::SampleBatch<Sample>(batch.timestamps + begin,
+                                      filtered.data(), size));
+  }
+}
+}
+}
@@ -8,21 +8,34 @@
 #include <myo/myo.hpp>
 #include <boost/circular_buffer.hpp>
 #include <boost/optional.hpp>
+#include <cstddef>
 
+#include "Filter.h"
+#include "OrientationFilterMode.h"
 #include "../../core/DeviceListenerWrapper.h"
 
 namespace features {
 namespace filters {
-class FiniteImpulseResponse : public core::DeviceListenerWrapper {
+// The flags do not depend on BasicFiniteImpulseResponse's base class, so they
+// live in a separate class to be shared by every instantiation.
+class FiniteImpulseResponseTypes {
  public:
   enum DataFlags {
-    OrientationData   = 1 << 0,
-    AccelerometerData = 1 << 1,
-    GyroscopeData     = 1 << 2
+    OrientationData       = 1 << 0,
+    AccelerometerData     = 1 << 1,
+    GyroscopeData         = 1 << 2,
+    // Filters the orientation data as rotations, see OrientationFilterMode.h.
+    QuaternionOrientation = 1 << 3
   };
+};
 
-  explicit FiniteImpulseResponse(core::DeviceListenerWrapper& parent_feature,
-                                 DataFlags flags, int window_size);
+template <typename Base = core::DeviceListenerWrapper>
+class BasicFiniteImpulseResponse : public BasicFilter<Base>,
+                                   public FiniteImpulseResponseTypes {
+ public:
+  explicit BasicFiniteImpulseResponse(
+      core::DeviceListenerWrapper& parent_feature, DataFlags flags,
+      int window_size);
 
   virtual void onOrientationData(
       myo::Myo* myo, uint64_t timestamp,
@@ -32,6 +45,12 @@ class FiniteImpulseResponse : public core::DeviceListenerWrapper {
       const myo::Vector3<float>& acceleration) override;
   virtual void onGyroscopeData(myo::Myo* myo, uint64_t timestamp,
                                const myo::Vector3<float>& gyro) override;
+  virtual void onOrientationDataBatch(
+      myo::Myo* myo, const core::OrientationBatch& batch) override;
+  virtual void onAccelerometerDataBatch(
+      myo::Myo* myo, const core::VectorBatch& batch) override;
+  virtual void onGyroscopeDataBatch(myo::Myo* myo,
+                                    const core::VectorBatch& batch) override;
 
  protected:
   myo::Quaternion<float> UpdateOrientationData(
@@ -52,68 +71,122 @@ class FiniteImpulseResponse : public core::DeviceListenerWrapper {
   boost::circular_buffer<myo::Quaternion<float>> orientation_data_;
   boost::circular_buffer<myo::Vector3<float>> accelerometer_data_;
   boost::circular_buffer<myo::Vector3<float>> gyroscope_data_;
+
+ private:
+  OrientationFilterMode orientation_mode_;
 };
 
-FiniteImpulseResponse::DataFlags operator|(
-    FiniteImpulseResponse::DataFlags lhs,
-    FiniteImpulseResponse::DataFlags rhs) {
-  return static_cast<FiniteImpulseResponse::DataFlags>(static_cast<int>(lhs) |
-                                                       static_cast<int>(rhs));
+typedef BasicFiniteImpulseResponse<> FiniteImpulseResponse;
+
+// constexpr so that combined flags can be template arguments, see
+// StaticFiniteImpulseResponse.h.
+constexpr FiniteImpulseResponseTypes::DataFlags operator|(
+    FiniteImpulseResponseTypes::DataFlags lhs,
+    FiniteImpulseResponseTypes::DataFlags rhs) {
+  return static_cast<FiniteImpulseResponseTypes::DataFlags>(
+      static_cast<int>(lhs) | static_cast<int>(rhs));
 }
 
-FiniteImpulseResponse::FiniteImpulseResponse(
+template <typename Base>
+BasicFiniteImpulseResponse<Base>::BasicFiniteImpulseResponse(
     core::DeviceListenerWrapper& parent_feature, DataFlags flags,
     int window_size)
     : flags_(flags),
       orientation_data_(window_size),
       accelerometer_data_(window_size),
-      gyroscope_data_(window_size) {
+      gyroscope_data_(window_size),
+      orientation_mode_((flags & QuaternionOrientation) != 0) {
   parent_feature.addChildFeature(this);
 }
 
-void FiniteImpulseResponse::onOrientationData(
-    myo::Myo* myo, uint64_t timestamp, const myo::Quaternion<float>& rotation) {
+template <typename Base>
+void BasicFiniteImpulseResponse<Base>::onOrientationData(
+    myo::Myo* myo, uint64_t timestamp,
+    const myo::Quaternion<float>& rotation) {
   if (flags_ & OrientationData) {
-    core::DeviceListenerWrapper::onOrientationData(
-        myo, timestamp, UpdateOrientationData(rotation));
+    Base::onOrientationData(myo, timestamp, UpdateOrientationData(rotation));
   } else {
-    core::DeviceListenerWrapper::onOrientationData(myo, timestamp, rotation);
+    Base::onOrientationData(myo, timestamp, rotation);
   }
 }
 
-void FiniteImpulseResponse::onAccelerometerData(
+template <typename Base>
+void BasicFiniteImpulseResponse<Base>::onAccelerometerData(
     myo::Myo* myo, uint64_t timestamp,
     const myo::Vector3<float>& acceleration) {
   if (flags_ & AccelerometerData) {
-    core::DeviceListenerWrapper::onAccelerometerData(
-        myo, timestamp, UpdateAccelerationData(acceleration));
+    Base::onAccelerometerData(myo, timestamp,
+                              UpdateAccelerationData(acceleration));
+  } else {
+    Base::onAccelerometerData(myo, timestamp, acceleration);
+  }
+}
+
+template <typename Base>
+void BasicFiniteImpulseResponse<Base>::onGyroscopeData(
+    myo::Myo* myo, uint64_t timestamp, const myo::Vector3<float>& gyro) {
+  if (flags_ & GyroscopeData) {
+    Base::onGyroscopeData(myo, timestamp, UpdateGyroscopeData(gyro));
+  } else {
+    Base::onGyroscopeData(myo, timestamp, gyro);
+  }
+}
+
+template <typename Base>
+void BasicFiniteImpulseResponse<Base>::onOrientationDataBatch(
+    myo::Myo* myo, const core::OrientationBatch& batch) {
+  if (flags_ & OrientationData) {
+    this->filterOrientationDataBatch(
+        myo, batch, [this](uint64_t, const myo::Quaternion<float>& rotation) {
+          return UpdateOrientationData(rotation);
+        });
+  } else {
+    Base::forwardOrientationDataBatch(myo, batch);
+  }
+}
+
+template <typename Base>
+void BasicFiniteImpulseResponse<Base>::onAccelerometerDataBatch(
+    myo::Myo* myo, const core::VectorBatch& batch) {
+  if (flags_ & AccelerometerData) {
+    this->filterAccelerometerDataBatch(
+        myo, batch, [this](uint64_t, const myo::Vector3<float>& acceleration) {
+          return UpdateAccelerationData(acceleration);
+        });
   } else {
-    core::DeviceListenerWrapper::onAccelerometerData(myo, timestamp,
-                                                     acceleration);
+    Base::forwardAccelerometerDataBatch(myo, batch);
   }
 }
 
-void FiniteImpulseResponse::onGyroscopeData(myo::Myo* myo, uint64_t timestamp,
-                                            const myo::Vector3<float>& gyro) {
+template <typename Base>
+void BasicFiniteImpulseResponse<Base>::onGyroscopeDataBatch(
+    myo::Myo* myo, const core::VectorBatch& batch) {
   if (flags_ & GyroscopeData) {
-    core::DeviceListenerWrapper::onGyroscopeData(myo, timestamp,
-                                                 UpdateGyroscopeData(gyro));
+    this->filterGyroscopeDataBatch(
+        myo, batch, [this](uint64_t, const myo::Vector3<float>& gyro) {
+          return UpdateGyroscopeData(gyro);
+        });
   } else {
-    core::DeviceListenerWrapper::onGyroscopeData(myo, timestamp, gyro);
+    Base::forwardGyroscopeDataBatch(myo, batch);
   }
 }
 
-myo::Quaternion<float> FiniteImpulseResponse::UpdateOrientationData(
+// The window holds the samples as given to the filter, so that a sample which
+// leaves the window has the same sign as when it entered.
+template <typename Base>
+myo::Quaternion<float> BasicFiniteImpulseResponse<Base>::UpdateOrientationData(
     const myo::Quaternion<float>& data) {
+  const myo::Quaternion<float> input = orientation_mode_.input(data);
   boost::optional<myo::Quaternion<float>> old_data;
   if (orientation_data_.full()) {
     old_data = orientation_data_.front();
   }
-  orientation_data_.push_back(data);
-  return RecalculateOrientation(data, old_data);
+  orientation_data_.push_back(input);
+  return orientation_mode_.output(RecalculateOrientation(input, old_data));
 }
 
-myo::Vector3<float> FiniteImpulseResponse::UpdateAccelerationData(
+template <typename Base>
+myo::Vector3<float> BasicFiniteImpulseResponse<Base>::UpdateAccelerationData(
     const myo::Vector3<float>& data) {
   boost::optional<myo::Vector3<float>> old_data;
   if (accelerometer_data_.full()) {
@@ -123,7 +196,8 @@ myo::Vector3<float> FiniteImpulseResponse::UpdateAccelerationData(
   return RecalculateAcceleration(data, old_data);
 }
 
-myo::Vector3<float> FiniteImpulseResponse::UpdateGyroscopeData(
+template <typename Base>
+myo::Vector3<float> BasicFiniteImpulseResponse<Base>::UpdateGyroscopeData(
     const myo::Vector3<float>& data) {
   boost::optional<myo::Vector3<float>> old_data;
   if (gyroscope_data_.full()) {
@@ -3,27 +3,44 @@
  * store on data point. A simple example of an IIR filter is an exponential
  * moving average. An exponential moving average filter is provided in
  * ExponentialMovingAverage.h
+ *
+ * Update is called once for each component of every sample. Filters whose
+ * update is known at compile time should derive from
+ * BasicStaticInfiniteImpulseResponse instead, which updates every component at
+ * once. See StaticInfiniteImpulseResponse.h.
  */
 
 #pragma once
 
 #include <myo/myo.hpp>
 
+#include "Filter.h"
+#include "OrientationFilterMode.h"
 #include "../../core/DeviceListenerWrapper.h"
 #include <boost/optional.hpp>
+#include <cstddef>
 
 namespace features {
 namespace filters {
-class InfiniteImpulseResponse : public core::DeviceListenerWrapper {
+// The flags do not depend on BasicInfiniteImpulseResponse's base class, so they
+// live in a separate class to be shared by every instantiation.
+class InfiniteImpulseResponseTypes {
  public:
   enum DataFlags {
-    OrientationData   = 1 << 0,
-    AccelerometerData = 1 << 1,
-    GyroscopeData     = 1 << 2
+    OrientationData       = 1 << 0,
+    AccelerometerData     = 1 << 1,
+    GyroscopeData         = 1 << 2,
+    // Filters the orientation data as rotations, see OrientationFilterMode.h.
+    QuaternionOrientation = 1 << 3
   };
+};
 
-  explicit InfiniteImpulseResponse(core::DeviceListenerWrapper& parent_feature,
-                                   DataFlags flags);
+template <typename Base = core::DeviceListenerWrapper>
+class BasicInfiniteImpulseResponse : public BasicFilter<Base>,
+                                     public InfiniteImpulseResponseTypes {
+ public:
+  explicit BasicInfiniteImpulseResponse(
+      core::DeviceListenerWrapper& parent_feature, DataFlags flags);
 
   virtual void onOrientationData(
       myo::Myo* myo, uint64_t timestamp,
@@ -33,6 +50,12 @@ class InfiniteImpulseResponse : public core::DeviceListenerWrapper {
       const myo::Vector3<float>& acceleration) override;
   virtual void onGyroscopeData(myo::Myo* myo, uint64_t timestamp,
                                const myo::Vector3<float>& gyro) override;
+  virtual void onOrientationDataBatch(
+      myo::Myo* myo, const core::OrientationBatch& batch) override;
+  virtual void onAccelerometerDataBatch(
+      myo::Myo* myo, const core::VectorBatch& batch) override;
+  virtual void onGyroscopeDataBatch(myo::Myo* myo,
+                                    const core::VectorBatch& batch) override;
 
  protected:
   virtual float Update(float new_value, float old_value) = 0;
@@ -44,73 +67,126 @@ class InfiniteImpulseResponse : public core::DeviceListenerWrapper {
   boost::optional<myo::Quaternion<float>> orientation_data_;
   boost::optional<myo::Vector3<float>> accelerometer_data_;
   boost::optional<myo::Vector3<float>> gyroscope_data_;
+
+ private:
+  OrientationFilterMode orientation_mode_;
 };
 
-InfiniteImpulseResponse::DataFlags operator|(
-    InfiniteImpulseResponse::DataFlags lhs,
-    InfiniteImpulseResponse::DataFlags rhs) {
-  return static_cast<InfiniteImpulseResponse::DataFlags>(static_cast<int>(lhs) |
-                                                         static_cast<int>(rhs));
+typedef BasicInfiniteImpulseResponse<> InfiniteImpulseResponse;
+
+InfiniteImpulseResponseTypes::DataFlags operator|(
+    InfiniteImpulseResponseTypes::DataFlags lhs,
+    InfiniteImpulseResponseTypes::DataFlags rhs) {
+  return static_cast<InfiniteImpulseResponseTypes::DataFlags>(
+      static_cast<int>(lhs) | static_cast<int>(rhs));
 }
 
-InfiniteImpulseResponse::InfiniteImpulseResponse(
+template <typename Base>
+BasicInfiniteImpulseResponse<Base>::BasicInfiniteImpulseResponse(
     core::DeviceListenerWrapper& parent_feature, DataFlags flags)
     : flags_(flags),
       orientation_data_(),
       accelerometer_data_(),
-      gyroscope_data_() {
+      gyroscope_data_(),
+      orientation_mode_((flags & QuaternionOrientation) != 0) {
   parent_feature.addChildFeature(this);
 }
 
-void InfiniteImpulseResponse::onOrientationData(
-    myo::Myo* myo, uint64_t timestamp, const myo::Quaternion<float>& rotation) {
+template <typename Base>
+void BasicInfiniteImpulseResponse<Base>::onOrientationData(
+    myo::Myo* myo, uint64_t timestamp,
+    const myo::Quaternion<float>& rotation) {
   if (flags_ & OrientationData) {
     UpdateOrientationData(rotation);
-    core::DeviceListenerWrapper::onOrientationData(myo, timestamp,
-                                                   orientation_data_.get());
+    Base::onOrientationData(myo, timestamp,
+                            orientation_mode_.output(orientation_data_.get()));
   } else {
-    core::DeviceListenerWrapper::onOrientationData(myo, timestamp, rotation);
+    Base::onOrientationData(myo, timestamp, rotation);
   }
 }
 
-void InfiniteImpulseResponse::onAccelerometerData(
+template <typename Base>
+void BasicInfiniteImpulseResponse<Base>::onAccelerometerData(
     myo::Myo* myo, uint64_t timestamp,
     const myo::Vector3<float>& acceleration) {
   if (flags_ & AccelerometerData) {
     UpdateAccelerometerData(acceleration);
-    core::DeviceListenerWrapper::onAccelerometerData(myo, timestamp,
-                                                     accelerometer_data_.get());
+    Base::onAccelerometerData(myo, timestamp, accelerometer_data_.get());
   } else {
-    core::DeviceListenerWrapper::onAccelerometerData(myo, timestamp,
-                                                     acceleration);
+    Base::onAccelerometerData(myo, timestamp, acceleration);
   }
 }
 
-void InfiniteImpulseResponse::onGyroscopeData(myo::Myo* myo, uint64_t timestamp,
-                                              const myo::Vector3<float>& gyro) {
+template <typename Base>
+void BasicInfiniteImpulseResponse<Base>::onGyroscopeData(
+    myo::Myo* myo, uint64_t timestamp, const myo::Vector3<float>& gyro) {
   if (flags_ & GyroscopeData) {
     UpdateGyroscopeData(gyro);
-    core::DeviceListenerWrapper::onGyroscopeData(myo, timestamp,
-                                                 gyroscope_data_.get());
+    Base::onGyroscopeData(myo, timestamp, gyroscope_data_.get());
+  } else {
+    Base::onGyroscopeData(myo, timestamp, gyro);
+  }
+}
+
+template <typename Base>
+void BasicInfiniteImpulseResponse<Base>::onOrientationDataBatch(
+    myo::Myo* myo, const core::OrientationBatch& batch) {
+  if (flags_ & OrientationData) {
+    this->filterOrientationDataBatch(
+        myo, batch, [this](uint64_t, const myo::Quaternion<float>& rotation) {
+          UpdateOrientationData(rotation);
+          return orientation_mode_.output(orientation_data_.get());
+        });
+  } else {
+    Base::forwardOrientationDataBatch(myo, batch);
+  }
+}
+
+template <typename Base>
+void BasicInfiniteImpulseResponse<Base>::onAccelerometerDataBatch(
+    myo::Myo* myo, const core::VectorBatch& batch) {
+  if (flags_ & AccelerometerData) {
+    this->filterAccelerometerDataBatch(
+        myo, batch, [this](uint64_t, const myo::Vector3<float>& acceleration) {
+          UpdateAccelerometerData(acceleration);
+          return accelerometer_data_.get();
+        });
+  } else {
+    Base::forwardAccelerometerDataBatch(myo, batch);
+  }
+}
+
+template <typename Base>
+void BasicInfiniteImpulseResponse<Base>::onGyroscopeDataBatch(
+    myo::Myo* myo, const core::VectorBatch& batch) {
+  if (flags_ & GyroscopeData) {
+    this->filterGyroscopeDataBatch(
+        myo, batch, [this](uint64_t, const myo::Vector3<float>& gyro) {
+          UpdateGyroscopeData(gyro);
+          return gyroscope_data_.get();
+        });
   } else {
-    core::DeviceListenerWrapper::onGyroscopeData(myo, timestamp, gyro);
+    Base::forwardGyroscopeDataBatch(myo, batch);
   }
 }
 
-void InfiniteImpulseResponse::UpdateOrientationData(
+template <typename Base>
+void BasicInfiniteImpulseResponse<Base>::UpdateOrientationData(
     const myo::Quaternion<float>& data) {
+  const myo::Quaternion<float> input = orientation_mode_.input(data);
   if (!orientation_data_) {
-    orientation_data_ = data;
+    orientation_data_ = input;
   } else {
-    float x = Update(data.x(), orientation_data_.get().x());
-    float y = Update(data.y(), orientation_data_.get().y());
-    float z = Update(data.z(), orientation_data_.get().z());
-    float w = Update(data.w(), orientation_data_.get().w());
+    float x = Update(input.x(), orientation_data_.get().x());
+    float y = Update(input.y(), orientation_data_.get().y());
+    float z = Update(input.z(), orientation_data_.get().z());
+    float w = Update(input.w(), orientation_data_.get().w());
     orientation_data_ = myo::Quaternion<float>(x, y, z, w);
   }
 }
 
-void InfiniteImpulseResponse::UpdateAccelerometerData(
+template <typename Base>
+void BasicInfiniteImpulseResponse<Base>::UpdateAccelerometerData(
     const myo::Vector3<float>& data) {
   if (!accelerometer_data_) {
     accelerometer_data_ = data;
@@ -122,7 +198,8 @@ void InfiniteImpulseResponse::UpdateAccelerometerData(
   }
 }
 
-void InfiniteImpulseResponse::UpdateGyroscopeData(
+template <typename Base>
+void BasicInfiniteImpulseResponse<Base>::UpdateGyroscopeData(
     const myo::Vector3<float>& data) {
   if (!gyroscope_data_) {
     gyroscope_data_ = data;
@@ -0,0 +1,241 @@
+/* Sliding window median filters, which remove short spikes, such as the ones
+ * a glitch in the Bluetooth link leaves in the accelerometer and gyroscope
+ * data, instead of smearing them across the window as a moving average does.
+ * See FiniteImpulseResponse.h for more info on FIR filters.
+ *
+ * MedianFilter replaces each component of a sample by the median of that
+ * component over the window. A spike shorter than half the window never
+ * reaches the output, but the output lags by about half a window.
+ *
+ * HampelFilter passes each component through unchanged unless it is an
+ * outlier: further from the median of the window than num_deviations
+ * standard deviations, estimated robustly as 1.4826 times the median absolute
+ * deviation from the median. Outliers are replaced by the median. The newest
+ * sample is compared against the window which ends with it, so the output
+ * does not lag.
+ *
+ * Each component of the window is kept sorted in a core::OrderStatisticTree,
+ * so a sample costs O(log n) for the median and O(log^2 n) for the median
+ * absolute deviation, where n is the window size. Windows of hundreds of
+ * samples stay cheap. With an even number of samples in the window, the
+ * median is the mean of the two middle ones.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <boost/circular_buffer.hpp>
+#include <boost/optional.hpp>
+#include <cmath>
+#include <cstddef>
+#include <myo/myo.hpp>
+#include <vector>
+
+#include "FiniteImpulseResponse.h"
+#include "../../core/DeviceListenerWrapper.h"
+#include "../../core/Float4.h"
+#include "../../core/OrderStatisticTree.h"
+
+namespace features {
+namespace filters {
+template <typename Base = core::DeviceListenerWrapper>
+class BasicMedianFilter : public BasicFiniteImpulseResponse<Base> {
+ public:
+  typedef FiniteImpulseResponseTypes::DataFlags DataFlags;
+
+  BasicMedianFilter(core::DeviceListenerWrapper& parent_feature,
+                    DataFlags flags, int window_size);
+
+ protected:
+  typedef core::OrderStatisticTree<float> Window;
+
+  // Returns the filtered value of one component, given the sorted window of
+  // that component, which already holds new_value.
+  virtual float FilterComponent(float new_value, const Window& window);
+
+  static float Median(const Window& window);
+  static float MedianAbsoluteDeviation(const Window& window, float median);
+
+ private:
+  virtual myo::Quaternion<float> RecalculateOrientation(
+      const myo::Quaternion<float>& new_data,
+      const boost::optional<myo::Quaternion<float>>& old_data) override;
+  virtual myo::Vector3<float> RecalculateAcceleration(
+      const myo::Vector3<float>& new_data,
+      const boost::optional<myo::Vector3<float>>& old_data) override;
+  virtual myo::Vector3<float> RecalculateGyration(
+      const myo::Vector3<float>& new_data,
+      const boost::optional<myo::Vector3<float>>& old_data) override;
+
+  // Moves every component's window on by one sample, the same way for each
+  // kind of data.
+  template <typename Data>
+  core::Float4 UpdateWindows(const Data& new_data,
+                             const boost::optional<Data>& old_data,
+                             std::vector<Window>& windows);
+  // The k-th smallest distance from median to a value in the window.
+  static float SelectDeviation(const Window& window, float median,
+                               std::size_t k);
+
+  // One window per component.
+  std::vector<Window> orientation_windows_;
+  std::vector<Window> accelerometer_windows_;
+  std::vector<Window> gyroscope_windows_;
+};
+
+typedef BasicMedianFilter<> MedianFilter;
+
+template <typename Base = core::DeviceListenerWrapper>
+class BasicHampelFilter : public BasicMedianFilter<Base> {
+ public:
+  typedef FiniteImpulseResponseTypes::DataFlags DataFlags;
+
+  BasicHampelFilter(core::DeviceListenerWrapper& parent_feature,
+                    DataFlags flags, int window_size,
+                    float num_deviations = 3);
+
+ protected:
+  typedef typename BasicMedianFilter<Base>::Window Window;
+
+  virtual float FilterComponent(float new_value,
+                                const Window& window) override;
+
+ private:
+  // The median absolute deviation times this is the threshold for outliers.
+  const float threshold_scale_;
+};
+
+typedef BasicHampelFilter<> HampelFilter;
+
+template <typename Base>
+BasicMedianFilter<Base>::BasicMedianFilter(
+    core::DeviceListenerWrapper& parent_feature, DataFlags flags,
+    int window_size)
+    : BasicFiniteImpulseResponse<Base>(parent_feature, flags, window_size),
+      orientation_windows_(4, Window(window_size)),
+      accelerometer_windows_(3, Window(window_size)),
+      gyroscope_windows_(3, Window(window_size)) {}
+
+template <typename Base>
+float BasicMedianFilter<Base>::FilterComponent(float, const Window& window) {
+  return Median(window);
+}
+
+template <typename Base>
+float BasicMedianFilter<Base>::Median(const Window& window) {
+  const std::size_t size = window.size();
+  if (size % 2 == 1) {
+    return window.select(size / 2);
+  }
+  return (window.select(size / 2 - 1) + window.select(size / 2)) / 2;
+}
+
+template <typename Base>
+float BasicMedianFilter<Base>::MedianAbsoluteDeviation(const Window& window,
+                                                       float median) {
+  const std::size_t size = window.size();
+  if (size % 2 == 1) {
+    return SelectDeviation(window, median, size / 2);
+  }
+  return (SelectDeviation(window, median, size / 2 - 1) +
+          SelectDeviation(window, median, size / 2)) /
+         2;
+}
+
+template <typename Base>
+myo::Quaternion<float> BasicMedianFilter<Base>::RecalculateOrientation(
+    const myo::Quaternion<float>& new_data,
+    const boost::optional<myo::Quaternion<float>>& old_data) {
+  return UpdateWindows(new_data, old_data, orientation_windows_)
+      .toQuaternion();
+}
+
+template <typename Base>
+myo::Vector3<float> BasicMedianFilter<Base>::RecalculateAcceleration(
+    const myo::Vector3<float>& new_data,
+    const boost::optional<myo::Vector3<float>>& old_data) {
+  return UpdateWindows(new_data, old_data, accelerometer_windows_)
+      .toVector3();
+}
+
+template <typename Base>
+myo::Vector3<float> BasicMedianFilter<Base>::RecalculateGyration(
+    const myo::Vector3<float>& new_data,
+    const boost::optional<myo::Vector3<float>>& old_data) {
+  return UpdateWindows(new_data, old_data, gyroscope_windows_).toVector3();
+}
+
+template <typename Base>
+template <typename Data>
+core::Float4 BasicMedianFilter<Base>::UpdateWindows(
+    const Data& new_data, const boost::optional<Data>& old_data,
+    std::vector<Window>& windows) {
+  float new_values[4], old_values[4], filtered[4] = {};
+  core::Float4(new_data).store(new_values);
+  if (old_data) {
+    core::Float4(old_data.get()).store(old_values);
+  }
+  for (std::size_t i = 0; i < windows.size(); ++i) {
+    if (old_data) {
+      windows[i].erase(old_values[i]);
+    }
+    windows[i].insert(new_values[i]);
+    filtered[i] = FilterComponent(new_values[i], windows[i]);
+  }
+  return core::Float4::load(filtered);
+}
+
+// The distances below the median, median - value, and those above it,
+// value - median, are each sorted in the window. The k + 1 smallest distances
+// are the i smallest below and the k + 1 - i smallest above, for the i found
+// by a binary search.
+template <typename Base>
+float BasicMedianFilter<Base>::SelectDeviation(const Window& window,
+                                               float median, std::size_t k) {
+  const std::size_t num_below = window.rank(median);
+  const std::size_t num_above = window.size() - num_below;
+  auto below = [&](std::size_t j) {
+    return median - window.select(num_below - 1 - j);
+  };
+  auto above = [&](std::size_t j) {
+    return window.select(num_below + j) - median;
+  };
+  std::size_t low = k + 1 > num_above ? k + 1 - num_above : 0;
+  std::size_t high = std::min(num_below, k + 1);
+  while (low < high) {
+    const std::size_t i = (low + high) / 2;
+    if (below(i) < above(k - i)) {
+      low = i + 1;
+    } else {
+      high = i;
+    }
+  }
+  const std::size_t i = low;
+  if (i == 0) {
+    return above(k);
+  }
+  if (i == k + 1) {
+    return below(k);
+  }
+  return std::max(below(i - 1), above(k - i));
+}
+
+template <typename Base>
+BasicHampelFilter<Base>::BasicHampelFilter(
+    core::DeviceListenerWrapper& parent_feature, DataFlags flags,
+    int window_size, float num_deviations)
+    : BasicMedianFilter<Base>(parent_feature, flags, window_size),
+      threshold_scale_(1.4826f * num_deviations) {}
+
+template <typename Base>
+float BasicHampelFilter<Base>::FilterComponent(float new_value,
+                                               const Window& window) {
+  const float median = this->Median(window);
+  const float deviation = this->MedianAbsoluteDeviation(window, median);
+  if (std::abs(new_value - median) > threshold_scale_ * deviation) {
+    return median;
+  }
+  return new_value;
+}
+}
+}
@@ -1,23 +1,32 @@
 /* A basic moving average filter.
  * See FiniteImpulseResponse.h for more info on FIR filters.
+ *
+ * BasicStaticMovingAverage is the same filter with the window size and the
+ * filtered streams given at compile time, see StaticFiniteImpulseResponse.h.
+ * It gives the same output as MovingAverage.
  * http://en.wikipedia.org/wiki/Moving_average#Simple_moving_average
  */
 
 #pragma once
 
 #include <myo/myo.hpp>
+#include <boost/circular_buffer.hpp>
 #include <boost/optional.hpp>
-#include <cassert>
 
 #include "FiniteImpulseResponse.h"
+#include "StaticFiniteImpulseResponse.h"
 #include "../../core/DeviceListenerWrapper.h"
+#include "../../core/Float4.h"
 
 namespace features {
 namespace filters {
-class MovingAverage : public FiniteImpulseResponse {
+template <typename Base = core::DeviceListenerWrapper>
+class BasicMovingAverage : public BasicFiniteImpulseResponse<Base> {
  public:
-  explicit MovingAverage(core::DeviceListenerWrapper& parent_feature,
-                         DataFlags flags, int window_size);
+  typedef FiniteImpulseResponseTypes::DataFlags DataFlags;
+
+  explicit BasicMovingAverage(core::DeviceListenerWrapper& parent_feature,
+                              DataFlags flags, int window_size);
 
  private:
   virtual myo::Quaternion<float> RecalculateOrientation(
@@ -30,111 +39,124 @@ class MovingAverage : public FiniteImpulseResponse {
       const myo::Vector3<float>& new_data,
       const boost::optional<myo::Vector3<float>>& old_data) override;
 
-  boost::optional<myo::Quaternion<float>> orientation_avg_;
-  boost::optional<myo::Vector3<float>> accelerometer_avg_;
-  boost::optional<myo::Vector3<float>> gyroscope_avg_;
+  // Every component of the average is updated at once, the same way for each
+  // kind of data.
+  template <typename Data>
+  core::Float4 UpdateAverage(const Data& new_data,
+                             const boost::optional<Data>& old_data,
+                             const boost::circular_buffer<Data>& window,
+                             boost::optional<core::Float4>& avg);
+
+  boost::optional<core::Float4> orientation_avg_;
+  boost::optional<core::Float4> accelerometer_avg_;
+  boost::optional<core::Float4> gyroscope_avg_;
+};
+
+typedef BasicMovingAverage<> MovingAverage;
+
+// The filter's kernel for BasicStaticFiniteImpulseResponse.
+class MovingAverageKernel {
+ public:
+  MovingAverageKernel();
+
+  template <typename Window>
+  core::Float4 update(const Window& window, const core::Float4* dropped);
+
+ private:
+  core::Float4 avg_;
+  bool has_avg_;
+};
+
+template <std::size_t WindowSize, FiniteImpulseResponseTypes::DataFlags Flags,
+          typename Base = core::DeviceListenerWrapper>
+class BasicStaticMovingAverage
+    : public BasicStaticFiniteImpulseResponse<MovingAverageKernel, WindowSize,
+                                              Flags, Base> {
+ public:
+  explicit BasicStaticMovingAverage(
+      core::DeviceListenerWrapper& parent_feature);
 };
 
-MovingAverage::MovingAverage(core::DeviceListenerWrapper& parent_feature,
-                             DataFlags flags, int window_size)
-    : FiniteImpulseResponse(parent_feature, flags, window_size) {}
+template <typename Base>
+BasicMovingAverage<Base>::BasicMovingAverage(
+    core::DeviceListenerWrapper& parent_feature, DataFlags flags,
+    int window_size)
+    : BasicFiniteImpulseResponse<Base>(parent_feature, flags, window_size) {}
 
-myo::Quaternion<float> MovingAverage::RecalculateOrientation(
+template <typename Base>
+myo::Quaternion<float> BasicMovingAverage<Base>::RecalculateOrientation(
     const myo::Quaternion<float>& new_data,
     const boost::optional<myo::Quaternion<float>>& old_data) {
-  if (!orientation_avg_) {
-    orientation_avg_ = new_data;
-  } else if (!orientation_data_.full() || !old_data) {
-    assert(orientation_avg_);
-    float x = orientation_avg_->x() * (orientation_data_.size() - 1);
-    float y = orientation_avg_->y() * (orientation_data_.size() - 1);
-    float z = orientation_avg_->z() * (orientation_data_.size() - 1);
-    float w = orientation_avg_->w() * (orientation_data_.size() - 1);
-    x = (x + new_data.x()) / orientation_data_.size();
-    y = (y + new_data.y()) / orientation_data_.size();
-    z = (z + new_data.z()) / orientation_data_.size();
-    w = (w + new_data.w()) / orientation_data_.size();
-    orientation_avg_ = myo::Quaternion<float>(x, y, z, w);
-  } else {
-    assert(orientation_avg_);
-    assert(old_data);
-    float x = orientation_avg_->x();
-    float y = orientation_avg_->y();
-    float z = orientation_avg_->z();
-    float w = orientation_avg_->w();
-    x -= old_data->x() / orientation_data_.capacity();
-    y -= old_data->y() / orientation_data_.capacity();
-    z -= old_data->z() / orientation_data_.capacity();
-    w -= old_data->w() / orientation_data_.capacity();
-    x += new_data.x() / orientation_data_.capacity();
-    y += new_data.y() / orientation_data_.capacity();
-    z += new_data.z() / orientation_data_.capacity();
-    w += new_data.w() / orientation_data_.capacity();
-    orientation_avg_ = myo::Quaternion<float>(x, y, z, w);
-  }
-  return orientation_avg_.get();
+  return UpdateAverage(new_data, old_data, this->orientation_data_,
+                       orientation_avg_)
+      .toQuaternion();
 }
 
-myo::Vector3<float> MovingAverage::RecalculateAcceleration(
+template <typename Base>
+myo::Vector3<float> BasicMovingAverage<Base>::RecalculateAcceleration(
     const myo::Vector3<float>& new_data,
     const boost::optional<myo::Vector3<float>>& old_data) {
-  if (!accelerometer_avg_) {
-    accelerometer_avg_ = new_data;
-  } else if (!accelerometer_data_.full() || !old_data) {
-    assert(accelerometer_avg_);
-    float x = accelerometer_avg_->x() * (accelerometer_data_.size() - 1);
-    float y = accelerometer_avg_->y() * (accelerometer_data_.size() - 1);
-    float z = accelerometer_avg_->z() * (accelerometer_data_.size() - 1);
-    x = (x + new_data.x()) / accelerometer_data_.size();
-    y = (y + new_data.y()) / accelerometer_data_.size();
-    z = (z + new_data.z()) / accelerometer_data_.size();
-    accelerometer_avg_ = myo::Vector3<float>(x, y, z);
-  } else {
-    assert(accelerometer_avg_);
-    assert(old_data);
-    float x = accelerometer_avg_->x();
-    float y = accelerometer_avg_->y();
-    float z = accelerometer_avg_->z();
-    x -= old_data->x() / accelerometer_data_.capacity();
-    y -= old_data->y() / accelerometer_data_.capacity();
-    z -= old_data->z() / accelerometer_data_.capacity();
-    x += new_data.x() / accelerometer_data_.capacity();
-    y += new_data.y() / accelerometer_data_.capacity();
-    z += new_data.z() / accelerometer_data_.capacity();
-    accelerometer_avg_ = myo::Vector3<float>(x, y, z);
-  }
-  return accelerometer_avg_.get();
+  return UpdateAverage(new_data, old_data, this->accelerometer_data_,
+                       accelerometer_avg_)
+      .toVector3();
 }
 
-myo::Vector3<float> MovingAverage::RecalculateGyration(
+template <typename Base>
+myo::Vector3<float> BasicMovingAverage<Base>::RecalculateGyration(
     const myo::Vector3<float>& new_data,
     const boost::optional<myo::Vector3<float>>& old_data) {
-  if (!gyroscope_avg_) {
-    gyroscope_avg_ = new_data;
-  } else if (!gyroscope_data_.full() || !old_data) {
-    assert(gyroscope_avg_);
-    float x = gyroscope_avg_->x() * (gyroscope_data_.size() - 1);
-    float y = gyroscope_avg_->y() * (gyroscope_data_.size() - 1);
-    float z = gyroscope_avg_->z() * (gyroscope_data_.size() - 1);
-    x = (x + new_data.x()) / gyroscope_data_.size();
-    y = (y + new_data.y()) / gyroscope_data_.size();
-    z = (z + new_data.z()) / gyroscope_data_.size();
-    gyroscope_avg_ = myo::Vector3<float>(x, y, z);
+  return UpdateAverage(new_data, old_data, this->gyroscope_data_,
+                       gyroscope_avg_)
+      .toVector3();
+}
+
+template <typename Base>
+template <typename Data>
+core::Float4 BasicMovingAverage<Base>::UpdateAverage(
+    const Data& new_data, const boost::optional<Data>& old_data,
+    const boost::circular_buffer<Data>& window,
+    boost::optional<core::Float4>& avg) {
+  core::Float4 new_lanes(new_data);
+  if (!avg) {
+    avg = new_lanes;
+  } else if (!window.full() || !old_data) {
+    core::Float4 size(window.size());
+    core::Float4 previous_size(window.size() - 1);
+    avg = (avg.get() * previous_size + new_lanes) / size;
   } else {
-    assert(gyroscope_avg_);
-    assert(old_data);
-    float x = gyroscope_avg_->x();
-    float y = gyroscope_avg_->y();
-    float z = gyroscope_avg_->z();
-    x -= old_data->x() / gyroscope_data_.capacity();
-    y -= old_data->y() / gyroscope_data_.capacity();
-    z -= old_data->z() / gyroscope_data_.capacity();
-    x += new_data.x() / gyroscope_data_.capacity();
-    y += new_data.y() / gyroscope_data_.capacity();
-    z += new_data.z() / gyroscope_data_.capacity();
-    gyroscope_avg_ = myo::Vector3<float>(x, y, z);
+    core::Float4 capacity(window.capacity());
+    avg = (avg.get() - core::Float4(old_data.get()) / capacity) +
+          new_lanes / capacity;
   }
-  return gyroscope_avg_.get();
+  return avg.get();
 }
+
+MovingAverageKernel::MovingAverageKernel() : avg_(0.f), has_avg_(false) {}
+
+// The same steps as UpdateAverage, so that the output is the same.
+template <typename Window>
+core::Float4 MovingAverageKernel::update(const Window& window,
+                                         const core::Float4* dropped) {
+  const core::Float4& new_lanes = window[window.size() - 1];
+  if (!has_avg_) {
+    avg_ = new_lanes;
+    has_avg_ = true;
+  } else if (!dropped) {
+    core::Float4 size(window.size());
+    core::Float4 previous_size(window.size() - 1);
+    avg_ = (avg_ * previous_size + new_lanes) / size;
+  } else {
+    core::Float4 capacity(window.capacity());
+    avg_ = (avg_ - *dropped / capacity) + new_lanes / capacity;
+  }
+  return avg_;
+}
+
+template <std::size_t WindowSize, FiniteImpulseResponseTypes::DataFlags Flags,
+          typename Base>
+BasicStaticMovingAverage<WindowSize, Flags, Base>::BasicStaticMovingAverage(
+    core::DeviceListenerWrapper& parent_feature)
+    : BasicStaticFiniteImpulseResponse<MovingAverageKernel, WindowSize, Flags,
+                                       Base>(parent_feature) {}
 }
 }
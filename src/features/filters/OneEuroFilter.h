@@ -0,0 +1,264 @@
+/* The One Euro filter, from "1 Euro Filter: A Simple Speed-based Low-pass
+ * Filter for Noisy Input in Interactive Systems" by Casiez, Roussel and Vogel.
+ * It is an exponential moving average whose cutoff frequency rises with the
+ * speed of the signal, so that it smooths away jitter while the signal is
+ * still and barely lags while it moves quickly.
+ *
+ * The cutoff is
+ *
+ *   min_cutoff_hz + beta * speed
+ *
+ * where speed is the magnitude of the rate of change of the sample per second,
+ * itself smoothed with a fixed cutoff of derivative_cutoff_hz. All components
+ * of a sample share the speed, so that e.g. a rotation is smoothed the same on
+ * every axis. To tune the filter, set beta to 0 and lower min_cutoff_hz until
+ * the jitter at rest is gone, then raise beta until fast motion no longer
+ * lags.
+ *
+ * The time between samples is taken from their timestamps, never from a
+ * clock, so a recording filters identically at any replay speed. A sample
+ * with the same timestamp as the one before does not move the filter, and one
+ * with an earlier timestamp, e.g. from a new recording, starts it over.
+ *
+ * Every component of a sample is updated at once (see core/Float4.h).
+ * OneEuroChannel filters one stream of samples and can be used on its own for
+ * other streams.
+ */
+
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <myo/myo.hpp>
+
+#include "Filter.h"
+#include "InfiniteImpulseResponse.h"
+#include "../../core/DeviceListenerWrapper.h"
+#include "../../core/Float4.h"
+
+namespace features {
+namespace filters {
+template <typename Lanes = core::Float4>
+class OneEuroChannel {
+ public:
+  OneEuroChannel(float min_cutoff_hz, float beta, float derivative_cutoff_hz);
+
+  // Adds a sample taken at timestamp, in microseconds, and returns the
+  // filtered output.
+  Lanes update(uint64_t timestamp, const Lanes& sample);
+  // Forgets every sample seen so far.
+  void reset();
+
+ private:
+  // The weight of a new sample in an exponential moving average with the
+  // given cutoff, seconds after the last one.
+  static float smoothingFactor(float cutoff_hz, float seconds);
+  static float magnitude(const Lanes& lanes);
+
+  const float min_cutoff_hz_;
+  const float beta_;
+  const float derivative_cutoff_hz_;
+  Lanes value_;
+  Lanes derivative_;
+  // The last sample as it came in, for the derivative.
+  Lanes last_sample_;
+  uint64_t last_timestamp_;
+  bool has_samples_;
+};
+
+template <typename Base = core::DeviceListenerWrapper>
+class BasicOneEuroFilter : public BasicFilter<Base>,
+                           public InfiniteImpulseResponseTypes {
+ public:
+  BasicOneEuroFilter(core::DeviceListenerWrapper& parent_feature,
+                     DataFlags flags, float min_cutoff_hz, float beta,
+                     float derivative_cutoff_hz = 1);
+
+  virtual void onOrientationData(
+      myo::Myo* myo, uint64_t timestamp,
+      const myo::Quaternion<float>& rotation) override;
+  virtual void onAccelerometerData(
+      myo::Myo* myo, uint64_t timestamp,
+      const myo::Vector3<float>& acceleration) override;
+  virtual void onGyroscopeData(myo::Myo* myo, uint64_t timestamp,
+                               const myo::Vector3<float>& gyro) override;
+  virtual void onOrientationDataBatch(
+      myo::Myo* myo, const core::OrientationBatch& batch) override;
+  virtual void onAccelerometerDataBatch(
+      myo::Myo* myo, const core::VectorBatch& batch) override;
+  virtual void onGyroscopeDataBatch(myo::Myo* myo,
+                                    const core::VectorBatch& batch) override;
+
+ private:
+  myo::Quaternion<float> updateOrientation(
+      uint64_t timestamp, const myo::Quaternion<float>& rotation);
+
+  const DataFlags flags_;
+  OneEuroChannel<> orientation_channel_;
+  OneEuroChannel<> accelerometer_channel_;
+  OneEuroChannel<> gyroscope_channel_;
+  OrientationFilterMode orientation_mode_;
+};
+
+typedef BasicOneEuroFilter<> OneEuroFilter;
+
+template <typename Lanes>
+OneEuroChannel<Lanes>::OneEuroChannel(float min_cutoff_hz, float beta,
+                                      float derivative_cutoff_hz)
+    : min_cutoff_hz_(min_cutoff_hz),
+      beta_(beta),
+      derivative_cutoff_hz_(derivative_cutoff_hz),
+      last_timestamp_(0),
+      has_samples_(false) {}
+
+template <typename Lanes>
+Lanes OneEuroChannel<Lanes>::update(uint64_t timestamp, const Lanes& sample) {
+  if (!has_samples_ || timestamp < last_timestamp_) {
+    value_ = last_sample_ = sample;
+    derivative_ = Lanes(0);
+    last_timestamp_ = timestamp;
+    has_samples_ = true;
+    return value_;
+  }
+  if (timestamp == last_timestamp_) {
+    return value_;
+  }
+  const float seconds = (timestamp - last_timestamp_) * 1e-6f;
+  last_timestamp_ = timestamp;
+
+  const Lanes rate = (sample - last_sample_) * Lanes(1 / seconds);
+  last_sample_ = sample;
+  derivative_ =
+      derivative_ +
+      Lanes(smoothingFactor(derivative_cutoff_hz_, seconds)) *
+          (rate - derivative_);
+  const float cutoff_hz = min_cutoff_hz_ + beta_ * magnitude(derivative_);
+  value_ = value_ +
+           Lanes(smoothingFactor(cutoff_hz, seconds)) * (sample - value_);
+  return value_;
+}
+
+template <typename Lanes>
+void OneEuroChannel<Lanes>::reset() {
+  has_samples_ = false;
+}
+
+template <typename Lanes>
+float OneEuroChannel<Lanes>::smoothingFactor(float cutoff_hz, float seconds) {
+  const float pi = 3.14159265358979f;
+  const float time_constant = 1 / (2 * pi * cutoff_hz);
+  return seconds / (seconds + time_constant);
+}
+
+template <typename Lanes>
+float OneEuroChannel<Lanes>::magnitude(const Lanes& lanes) {
+  float values[4];
+  (lanes * lanes).store(values);
+  return std::sqrt(values[0] + values[1] + values[2] + values[3]);
+}
+
+template <typename Base>
+BasicOneEuroFilter<Base>::BasicOneEuroFilter(
+    core::DeviceListenerWrapper& parent_feature, DataFlags flags,
+    float min_cutoff_hz, float beta, float derivative_cutoff_hz)
+    : flags_(flags),
+      orientation_channel_(min_cutoff_hz, beta, derivative_cutoff_hz),
+      accelerometer_channel_(min_cutoff_hz, beta, derivative_cutoff_hz),
+      gyroscope_channel_(min_cutoff_hz, beta, derivative_cutoff_hz),
+      orientation_mode_((flags & QuaternionOrientation) != 0) {
+  parent_feature.addChildFeature(this);
+}
+
+template <typename Base>
+void BasicOneEuroFilter<Base>::onOrientationData(
+    myo::Myo* myo, uint64_t timestamp,
+    const myo::Quaternion<float>& rotation) {
+  if (flags_ & OrientationData) {
+    Base::onOrientationData(myo, timestamp,
+                            updateOrientation(timestamp, rotation));
+  } else {
+    Base::onOrientationData(myo, timestamp, rotation);
+  }
+}
+
+template <typename Base>
+void BasicOneEuroFilter<Base>::onAccelerometerData(
+    myo::Myo* myo, uint64_t timestamp,
+    const myo::Vector3<float>& acceleration) {
+  if (flags_ & AccelerometerData) {
+    Base::onAccelerometerData(
+        myo, timestamp,
+        accelerometer_channel_.update(timestamp, core::Float4(acceleration))
+            .toVector3());
+  } else {
+    Base::onAccelerometerData(myo, timestamp, acceleration);
+  }
+}
+
+template <typename Base>
+void BasicOneEuroFilter<Base>::onGyroscopeData(
+    myo::Myo* myo, uint64_t timestamp, const myo::Vector3<float>& gyro) {
+  if (flags_ & GyroscopeData) {
+    Base::onGyroscopeData(
+        myo, timestamp,
+        gyroscope_channel_.update(timestamp, core::Float4(gyro)).toVector3());
+  } else {
+    Base::onGyroscopeData(myo, timestamp, gyro);
+  }
+}
+
+template <typename Base>
+void BasicOneEuroFilter<Base>::onOrientationDataBatch(
+    myo::Myo* myo, const core::OrientationBatch& batch) {
+  if (flags_ & OrientationData) {
+    this->filterOrientationDataBatch(
+        myo, batch,
+        [this](uint64_t timestamp, const myo::Quaternion<float>& rotation) {
+          return updateOrientation(timestamp, rotation);
+        });
+  } else {
+    Base::forwardOrientationDataBatch(myo, batch);
+  }
+}
+
+template <typename Base>
+void BasicOneEuroFilter<Base>::onAccelerometerDataBatch(
+    myo::Myo* myo, const core::VectorBatch& batch) {
+  if (flags_ & AccelerometerData) {
+    this->filterAccelerometerDataBatch(
+        myo, batch,
+        [this](uint64_t timestamp, const myo::Vector3<float>& acceleration) {
+          return accelerometer_channel_
+              .update(timestamp, core::Float4(acceleration))
+              .toVector3();
+        });
+  } else {
+    Base::forwardAccelerometerDataBatch(myo, batch);
+  }
+}
+
+template <typename Base>
+void BasicOneEuroFilter<Base>::onGyroscopeDataBatch(
+    myo::Myo* myo, const core::VectorBatch& batch) {
+  if (flags_ & GyroscopeData) {
+    this->filterGyroscopeDataBatch(
+        myo, batch,
+        [this](uint64_t timestamp, const myo::Vector3<float>& gyro) {
+          return gyroscope_channel_.update(timestamp, core::Float4(gyro))
+              .toVector3();
+        });
+  } else {
+    Base::forwardGyroscopeDataBatch(myo, batch);
+  }
+}
+
+template <typename Base>
+myo::Quaternion<float> BasicOneEuroFilter<Base>::updateOrientation(
+    uint64_t timestamp, const myo::Quaternion<float>& rotation) {
+  const core::Float4 input = orientation_mode_.input(core::Float4(rotation));
+  return orientation_mode_.output(orientation_channel_.update(timestamp, input))
+      .toQuaternion();
+}
+}
+}
@@ -0,0 +1,86 @@
+/* The FIR and IIR filters filter the four components of a quaternion as if
+ * they were unrelated numbers, which is cheap but not quite right for
+ * rotations: q and -q are the same rotation, so a filter which is given both
+ * averages a rotation with its own opposite, and the average of unit
+ * quaternions is shorter than a unit quaternion, which skews the conversions
+ * to roll, pitch and yaw in core/OrientationUtility.h.
+ *
+ * With the QuaternionOrientation flag, a filter uses an OrientationFilterMode
+ * to flip each sample to the sign closest to the sample before it, before
+ * filtering it, and to normalize the output. The filter itself is unchanged,
+ * so e.g. an exponential moving average becomes an incremental normalized
+ * linear interpolation (NLERP) between rotations, which for the small steps
+ * between samples is as good as slerp. This costs two dot products and a
+ * square root per sample (see core/Float4.h).
+ */
+
+#pragma once
+
+#include <cmath>
+#include <myo/myo.hpp>
+
+#include "../../core/Float4.h"
+
+namespace features {
+namespace filters {
+class OrientationFilterMode {
+ public:
+  // If quaternion is false, samples pass through unchanged.
+  explicit OrientationFilterMode(bool quaternion);
+
+  // Prepares a sample for the filter.
+  core::Float4 input(const core::Float4& rotation);
+  myo::Quaternion<float> input(const myo::Quaternion<float>& rotation);
+  // Turns the output of the filter back into a rotation. An output of length
+  // 0 is returned unchanged.
+  core::Float4 output(const core::Float4& filtered) const;
+  myo::Quaternion<float> output(const myo::Quaternion<float>& filtered) const;
+
+ private:
+  const bool quaternion_;
+  // The last sample given to the filter. The first sample is aligned with the
+  // identity.
+  core::Float4 last_input_;
+};
+
+OrientationFilterMode::OrientationFilterMode(bool quaternion)
+    : quaternion_(quaternion), last_input_(0, 0, 0, 1) {}
+
+core::Float4 OrientationFilterMode::input(const core::Float4& rotation) {
+  if (!quaternion_) {
+    return rotation;
+  }
+  const float sign = rotation.dot(last_input_) < 0 ? -1.f : 1.f;
+  last_input_ = rotation * core::Float4(sign);
+  return last_input_;
+}
+
+myo::Quaternion<float> OrientationFilterMode::input(
+    const myo::Quaternion<float>& rotation) {
+  if (!quaternion_) {
+    return rotation;
+  }
+  return input(core::Float4(rotation)).toQuaternion();
+}
+
+core::Float4 OrientationFilterMode::output(
+    const core::Float4& filtered) const {
+  if (!quaternion_) {
+    return filtered;
+  }
+  const float squared_length = filtered.dot(filtered);
+  if (squared_length == 0) {
+    return filtered;
+  }
+  return filtered * core::Float4(1 / std::sqrt(squared_length));
+}
+
+myo::Quaternion<float> OrientationFilterMode::output(
+    const myo::Quaternion<float>& filtered) const {
+  if (!quaternion_) {
+    return filtered;
+  }
+  return output(core::Float4(filtered)).toQuaternion();
+}
+}
+}
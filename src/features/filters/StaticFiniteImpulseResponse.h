@@ -0,0 +1,318 @@
+/* Finite Impulse Response (FIR) filters whose window size, filtered streams and
+ * update are given at compile time, instead of at run time as in
+ * FiniteImpulseResponse.h. Each filtered stream keeps its window of samples in
+ * an array inside the filter, so that the filter does not allocate, and a
+ * stream which is not filtered takes no space at all. For the small windows
+ * that filters usually have, the whole state of a stream fits in a cache line
+ * or two.
+ *
+ * Each sample is kept as a core::Float4 (see core/Float4.h), so that every
+ * component is updated at once. The update is given by a kernel class with the
+ * method
+ *
+ *   template <typename Window>
+ *   core::Float4 update(const Window& window, const core::Float4* dropped);
+ *
+ * which returns the filtered sample. window is a SampleWindow which already
+ * holds the new sample, and dropped is the sample which the new one pushed out
+ * of the window, or nullptr if the window was not yet full. Every stream has
+ * its own copy of the kernel, so a kernel may keep state. See MovingAverage.h
+ * for an example.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <myo/myo.hpp>
+
+#include "Filter.h"
+#include "FiniteImpulseResponse.h"
+#include "OrientationFilterMode.h"
+#include "../../core/DeviceListenerWrapper.h"
+#include "../../core/Float4.h"
+
+namespace features {
+namespace filters {
+// The last Size samples, in a ring inside the object.
+template <typename Sample, std::size_t Size>
+class SampleWindow {
+ public:
+  SampleWindow();
+
+  // Adds sample as the newest. If the window was full, the oldest sample is
+  // copied to dropped and true is returned.
+  bool push(const Sample& sample, Sample& dropped);
+
+  std::size_t size() const;
+  bool full() const;
+  static constexpr std::size_t capacity() { return Size; }
+  // The samples from the oldest, at 0, to the newest, at size() - 1.
+  const Sample& operator[](std::size_t i) const;
+
+ private:
+  std::array<Sample, Size> samples_;
+  // The position of the oldest sample.
+  std::size_t start_;
+  std::size_t size_;
+};
+
+// The window and kernel of one stream, or nothing if the stream is not
+// filtered, in which case update is never called. Stream tells the streams
+// apart so that the filter can derive from all three, which lets the empty ones
+// take no space.
+template <typename Kernel, std::size_t WindowSize, int Stream, bool Enabled>
+class StaticFiniteImpulseResponseStream {
+ public:
+  explicit StaticFiniteImpulseResponseStream(const Kernel& kernel);
+
+  core::Float4 update(const core::Float4& sample);
+
+ private:
+  Kernel kernel_;
+  SampleWindow<core::Float4, WindowSize> window_;
+};
+
+template <typename Kernel, std::size_t WindowSize, int Stream>
+class StaticFiniteImpulseResponseStream<Kernel, WindowSize, Stream, false> {
+ public:
+  explicit StaticFiniteImpulseResponseStream(const Kernel&) {}
+
+  core::Float4 update(const core::Float4& sample) { return sample; }
+};
+
+// The OrientationFilterMode of the orientation stream if it is filtered as
+// quaternions, or else nothing, in which case samples pass through unchanged.
+template <bool Enabled>
+class StaticOrientationFilterMode : private OrientationFilterMode {
+ public:
+  StaticOrientationFilterMode();
+
+  using OrientationFilterMode::input;
+  using OrientationFilterMode::output;
+};
+
+template <>
+class StaticOrientationFilterMode<false> {
+ public:
+  core::Float4 input(const core::Float4& rotation) { return rotation; }
+  core::Float4 output(const core::Float4& filtered) const { return filtered; }
+};
+
+template <typename Kernel, std::size_t WindowSize,
+          FiniteImpulseResponseTypes::DataFlags Flags,
+          typename Base = core::DeviceListenerWrapper>
+class BasicStaticFiniteImpulseResponse
+    : public BasicFilter<Base>,
+      public FiniteImpulseResponseTypes,
+      private StaticFiniteImpulseResponseStream<
+          Kernel, WindowSize, FiniteImpulseResponseTypes::OrientationData,
+          (Flags & FiniteImpulseResponseTypes::OrientationData) != 0>,
+      private StaticFiniteImpulseResponseStream<
+          Kernel, WindowSize, FiniteImpulseResponseTypes::AccelerometerData,
+          (Flags & FiniteImpulseResponseTypes::AccelerometerData) != 0>,
+      private StaticFiniteImpulseResponseStream<
+          Kernel, WindowSize, FiniteImpulseResponseTypes::GyroscopeData,
+          (Flags & FiniteImpulseResponseTypes::GyroscopeData) != 0>,
+      private StaticOrientationFilterMode<
+          (Flags & FiniteImpulseResponseTypes::OrientationData) != 0 &&
+          (Flags & FiniteImpulseResponseTypes::QuaternionOrientation) != 0> {
+ public:
+  explicit BasicStaticFiniteImpulseResponse(
+      core::DeviceListenerWrapper& parent_feature,
+      const Kernel& kernel = Kernel());
+
+  virtual void onOrientationData(
+      myo::Myo* myo, uint64_t timestamp,
+      const myo::Quaternion<float>& rotation) override;
+  virtual void onAccelerometerData(
+      myo::Myo* myo, uint64_t timestamp,
+      const myo::Vector3<float>& acceleration) override;
+  virtual void onGyroscopeData(myo::Myo* myo, uint64_t timestamp,
+                               const myo::Vector3<float>& gyro) override;
+  virtual void onOrientationDataBatch(
+      myo::Myo* myo, const core::OrientationBatch& batch) override;
+  virtual void onAccelerometerDataBatch(
+      myo::Myo* myo, const core::VectorBatch& batch) override;
+  virtual void onGyroscopeDataBatch(myo::Myo* myo,
+                                    const core::VectorBatch& batch) override;
+
+ private:
+  typedef StaticFiniteImpulseResponseStream<
+      Kernel, WindowSize, OrientationData, (Flags & OrientationData) != 0>
+      OrientationStream;
+  typedef StaticFiniteImpulseResponseStream<Kernel, WindowSize,
+                                            AccelerometerData,
+                                            (Flags & AccelerometerData) != 0>
+      AccelerometerStream;
+  typedef StaticFiniteImpulseResponseStream<
+      Kernel, WindowSize, GyroscopeData, (Flags & GyroscopeData) != 0>
+      GyroscopeStream;
+  typedef StaticOrientationFilterMode<(Flags & OrientationData) != 0 &&
+                                      (Flags & QuaternionOrientation) != 0>
+      OrientationMode;
+
+  myo::Quaternion<float> updateOrientation(
+      const myo::Quaternion<float>& rotation);
+};
+
+template <typename Sample, std::size_t Size>
+SampleWindow<Sample, Size>::SampleWindow() : samples_(), start_(0), size_(0) {
+  static_assert(Size > 0, "A window must hold at least one sample.");
+}
+
+template <typename Sample, std::size_t Size>
+bool SampleWindow<Sample, Size>::push(const Sample& sample, Sample& dropped) {
+  if (size_ < Size) {
+    samples_[(start_ + size_) % Size] = sample;
+    ++size_;
+    return false;
+  }
+  dropped = samples_[start_];
+  samples_[start_] = sample;
+  start_ = start_ + 1 == Size ? 0 : start_ + 1;
+  return true;
+}
+
+template <typename Sample, std::size_t Size>
+std::size_t SampleWindow<Sample, Size>::size() const {
+  return size_;
+}
+
+template <typename Sample, std::size_t Size>
+bool SampleWindow<Sample, Size>::full() const {
+  return size_ == Size;
+}
+
+template <typename Sample, std::size_t Size>
+const Sample& SampleWindow<Sample, Size>::operator[](std::size_t i) const {
+  return samples_[(start_ + i) % Size];
+}
+
+template <typename Kernel, std::size_t WindowSize, int Stream, bool Enabled>
+StaticFiniteImpulseResponseStream<Kernel, WindowSize, Stream, Enabled>::
+    StaticFiniteImpulseResponseStream(const Kernel& kernel)
+    : kernel_(kernel) {}
+
+template <typename Kernel, std::size_t WindowSize, int Stream, bool Enabled>
+core::Float4
+StaticFiniteImpulseResponseStream<Kernel, WindowSize, Stream, Enabled>::update(
+    const core::Float4& sample) {
+  core::Float4 dropped;
+  if (window_.push(sample, dropped)) {
+    return kernel_.update(window_, &dropped);
+  }
+  return kernel_.update(window_, static_cast<const core::Float4*>(nullptr));
+}
+
+template <bool Enabled>
+StaticOrientationFilterMode<Enabled>::StaticOrientationFilterMode()
+    : OrientationFilterMode(true) {}
+
+template <typename Kernel, std::size_t WindowSize,
+          FiniteImpulseResponseTypes::DataFlags Flags, typename Base>
+BasicStaticFiniteImpulseResponse<Kernel, WindowSize, Flags, Base>::
+    BasicStaticFiniteImpulseResponse(
+        core::DeviceListenerWrapper& parent_feature, const Kernel& kernel)
+    : OrientationStream(kernel),
+      AccelerometerStream(kernel),
+      GyroscopeStream(kernel) {
+  parent_feature.addChildFeature(this);
+}
+
+// The flags are known at compile time, so the unused branches are removed.
+template <typename Kernel, std::size_t WindowSize,
+          FiniteImpulseResponseTypes::DataFlags Flags, typename Base>
+void BasicStaticFiniteImpulseResponse<Kernel, WindowSize, Flags, Base>::
+    onOrientationData(myo::Myo* myo, uint64_t timestamp,
+                      const myo::Quaternion<float>& rotation) {
+  if (Flags & OrientationData) {
+    Base::onOrientationData(myo, timestamp, updateOrientation(rotation));
+  } else {
+    Base::onOrientationData(myo, timestamp, rotation);
+  }
+}
+
+template <typename Kernel, std::size_t WindowSize,
+          FiniteImpulseResponseTypes::DataFlags Flags, typename Base>
+void BasicStaticFiniteImpulseResponse<Kernel, WindowSize, Flags, Base>::
+    onAccelerometerData(myo::Myo* myo, uint64_t timestamp,
+                        const myo::Vector3<float>& acceleration) {
+  if (Flags & AccelerometerData) {
+    Base::onAccelerometerData(
+        myo, timestamp,
+        AccelerometerStream::update(core::Float4(acceleration)).toVector3());
+  } else {
+    Base::onAccelerometerData(myo, timestamp, acceleration);
+  }
+}
+
+template <typename Kernel, std::size_t WindowSize,
+          FiniteImpulseResponseTypes::DataFlags Flags, typename Base>
+void BasicStaticFiniteImpulseResponse<Kernel, WindowSize, Flags, Base>::
+    onGyroscopeData(myo::Myo* myo, uint64_t timestamp,
+                    const myo::Vector3<float>& gyro) {
+  if (Flags & GyroscopeData) {
+    Base::onGyroscopeData(
+        myo, timestamp,
+        GyroscopeStream::update(core::Float4(gyro)).toVector3());
+  } else {
+    Base::onGyroscopeData(myo, timestamp, gyro);
+  }
+}
+
+template <typename Kernel, std::size_t WindowSize,
+          FiniteImpulseResponseTypes::DataFlags Flags, typename Base>
+void BasicStaticFiniteImpulseResponse<Kernel, WindowSize, Flags, Base>::
+    onOrientationDataBatch(myo::Myo* myo,
+                           const core::OrientationBatch& batch) {
+  if (Flags & OrientationData) {
+    this->filterOrientationDataBatch(
+        myo, batch, [this](uint64_t, const myo::Quaternion<float>& rotation) {
+          return updateOrientation(rotation);
+        });
+  } else {
+    Base::forwardOrientationDataBatch(myo, batch);
+  }
+}
+
+template <typename Kernel, std::size_t WindowSize,
+          FiniteImpulseResponseTypes::DataFlags Flags, typename Base>
+void BasicStaticFiniteImpulseResponse<Kernel, WindowSize, Flags, Base>::
+    onAccelerometerDataBatch(myo::Myo* myo, const core::VectorBatch& batch) {
+  if (Flags & AccelerometerData) {
+    this->filterAccelerometerDataBatch(
+        myo, batch, [this](uint64_t, const myo::Vector3<float>& acceleration) {
+          return AccelerometerStream::update(core::Float4(acceleration))
+              .toVector3();
+        });
+  } else {
+    Base::forwardAccelerometerDataBatch(myo, batch);
+  }
+}
+
+template <typename Kernel, std::size_t WindowSize,
+          FiniteImpulseResponseTypes::DataFlags Flags, typename Base>
+void BasicStaticFiniteImpulseResponse<Kernel, WindowSize, Flags, Base>::
+    onGyroscopeDataBatch(myo::Myo* myo, const core::VectorBatch& batch) {
+  if (Flags & GyroscopeData) {
+    this->filterGyroscopeDataBatch(
+        myo, batch, [this](uint64_t, const myo::Vector3<float>& gyro) {
+          return GyroscopeStream::update(core::Float4(gyro)).toVector3();
+        });
+  } else {
+    Base::forwardGyroscopeDataBatch(myo, batch);
+  }
+}
+
+template <typename Kernel, std::size_t WindowSize,
+          FiniteImpulseResponseTypes::DataFlags Flags, typename Base>
+myo::Quaternion<float>
+BasicStaticFiniteImpulseResponse<Kernel, WindowSize, Flags, Base>::
+    updateOrientation(const myo::Quaternion<float>& rotation) {
+  const core::Float4 input = OrientationMode::input(core::Float4(rotation));
+  return OrientationMode::output(OrientationStream::update(input))
+      .toQuaternion();
+}
+}
+}
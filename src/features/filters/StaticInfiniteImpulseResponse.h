@@ -0,0 +1,249 @@
+/* Infinite Impulse Response (IIR) filters whose update is given at compile time
+ * by a kernel class, instead of by a virtual Update method as in
+ * InfiniteImpulseResponse.h. Every component of a sample is updated at once,
+ * with SIMD instructions where available (see core/Float4.h).
+ *
+ * A kernel is a copyable class with the method
+ *
+ *   template <typename Lanes>
+ *   Lanes update(const Lanes& new_value, const Lanes& old_value) const;
+ *
+ * which returns the new state of the filter. Lanes supports +, -, * and /, and
+ * can be constructed from a float to set every lane to that float. See
+ * ExponentialMovingAverage.h for an example.
+ *
+ * InfiniteImpulseResponseBank applies a kernel to many independent groups of
+ * four lanes at once, e.g. one group per Myo or per four EMG channels.
+ * BasicStaticInfiniteImpulseResponse is the feature which filters a
+ * Myo's IMU data with a kernel.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <myo/myo.hpp>
+#include <vector>
+
+#include "Filter.h"
+#include "InfiniteImpulseResponse.h"
+#include "../../core/DeviceListenerWrapper.h"
+#include "../../core/Float4.h"
+
+namespace features {
+namespace filters {
+template <typename Kernel, typename Lanes = core::Float4>
+class InfiniteImpulseResponseBank {
+ public:
+  InfiniteImpulseResponseBank(const Kernel& kernel, std::size_t num_groups);
+
+  std::size_t numGroups() const;
+
+  // Updates every group with one new sample. input and output hold four floats
+  // per group, and may be the same array.
+  void update(const float* input, float* output);
+  // Updates a single group and returns its new state. The first sample of a
+  // group becomes its state unchanged.
+  Lanes update(std::size_t group, const Lanes& sample);
+  // Forgets every sample seen so far.
+  void reset();
+
+  const Kernel& kernel() const;
+
+ private:
+  Kernel kernel_;
+  std::vector<Lanes> states_;
+  std::vector<char> has_state_;
+  // Whether every group has a state, so that update can skip the checks.
+  bool all_have_state_;
+};
+
+template <typename Kernel, typename Base = core::DeviceListenerWrapper>
+class BasicStaticInfiniteImpulseResponse
+    : public BasicFilter<Base>,
+      public InfiniteImpulseResponseTypes {
+ public:
+  BasicStaticInfiniteImpulseResponse(
+      core::DeviceListenerWrapper& parent_feature, DataFlags flags,
+      const Kernel& kernel);
+
+  virtual void onOrientationData(
+      myo::Myo* myo, uint64_t timestamp,
+      const myo::Quaternion<float>& rotation) override;
+  virtual void onAccelerometerData(
+      myo::Myo* myo, uint64_t timestamp,
+      const myo::Vector3<float>& acceleration) override;
+  virtual void onGyroscopeData(myo::Myo* myo, uint64_t timestamp,
+                               const myo::Vector3<float>& gyro) override;
+  virtual void onOrientationDataBatch(
+      myo::Myo* myo, const core::OrientationBatch& batch) override;
+  virtual void onAccelerometerDataBatch(
+      myo::Myo* myo, const core::VectorBatch& batch) override;
+  virtual void onGyroscopeDataBatch(myo::Myo* myo,
+                                    const core::VectorBatch& batch) override;
+
+ private:
+  // The bank's group for each stream.
+  enum Group { OrientationGroup, AccelerometerGroup, GyroscopeGroup };
+
+  myo::Quaternion<float> UpdateOrientation(
+      const myo::Quaternion<float>& rotation);
+  myo::Vector3<float> UpdateVector(Group group,
+                                   const myo::Vector3<float>& data);
+
+  const DataFlags flags_;
+  InfiniteImpulseResponseBank<Kernel> bank_;
+  OrientationFilterMode orientation_mode_;
+};
+
+template <typename Kernel, typename Lanes>
+InfiniteImpulseResponseBank<Kernel, Lanes>::InfiniteImpulseResponseBank(
+    const Kernel& kernel, std::size_t num_groups)
+    : kernel_(kernel),
+      states_(num_groups),
+      has_state_(num_groups, false),
+      all_have_state_(false) {}
+
+template <typename Kernel, typename Lanes>
+std::size_t InfiniteImpulseResponseBank<Kernel, Lanes>::numGroups() const {
+  return states_.size();
+}
+
+template <typename Kernel, typename Lanes>
+void InfiniteImpulseResponseBank<Kernel, Lanes>::update(const float* input,
+                                                        float* output) {
+  if (!all_have_state_) {
+    for (std::size_t group = 0; group < states_.size(); ++group) {
+      update(group, Lanes::load(input + 4 * group)).store(output + 4 * group);
+    }
+    all_have_state_ = true;
+    return;
+  }
+  Lanes* states = states_.data();
+  for (std::size_t group = 0; group < states_.size(); ++group) {
+    states[group] = kernel_.update(Lanes::load(input + 4 * group),
+                                   states[group]);
+    states[group].store(output + 4 * group);
+  }
+}
+
+template <typename Kernel, typename Lanes>
+Lanes InfiniteImpulseResponseBank<Kernel, Lanes>::update(std::size_t group,
+                                                         const Lanes& sample) {
+  if (!has_state_[group]) {
+    has_state_[group] = true;
+    states_[group] = sample;
+  } else {
+    states_[group] = kernel_.update(sample, states_[group]);
+  }
+  return states_[group];
+}
+
+template <typename Kernel, typename Lanes>
+void InfiniteImpulseResponseBank<Kernel, Lanes>::reset() {
+  has_state_.assign(has_state_.size(), false);
+  all_have_state_ = false;
+}
+
+template <typename Kernel, typename Lanes>
+const Kernel& InfiniteImpulseResponseBank<Kernel, Lanes>::kernel() const {
+  return kernel_;
+}
+
+template <typename Kernel, typename Base>
+BasicStaticInfiniteImpulseResponse<Kernel, Base>::
+    BasicStaticInfiniteImpulseResponse(
+        core::DeviceListenerWrapper& parent_feature, DataFlags flags,
+        const Kernel& kernel)
+    : flags_(flags),
+      bank_(kernel, 3),
+      orientation_mode_((flags & QuaternionOrientation) != 0) {
+  parent_feature.addChildFeature(this);
+}
+
+template <typename Kernel, typename Base>
+void BasicStaticInfiniteImpulseResponse<Kernel, Base>::onOrientationData(
+    myo::Myo* myo, uint64_t timestamp,
+    const myo::Quaternion<float>& rotation) {
+  if (flags_ & OrientationData) {
+    Base::onOrientationData(myo, timestamp, UpdateOrientation(rotation));
+  } else {
+    Base::onOrientationData(myo, timestamp, rotation);
+  }
+}
+
+template <typename Kernel, typename Base>
+void BasicStaticInfiniteImpulseResponse<Kernel, Base>::onAccelerometerData(
+    myo::Myo* myo, uint64_t timestamp,
+    const myo::Vector3<float>& acceleration) {
+  if (flags_ & AccelerometerData) {
+    Base::onAccelerometerData(myo, timestamp,
+                              UpdateVector(AccelerometerGroup, acceleration));
+  } else {
+    Base::onAccelerometerData(myo, timestamp, acceleration);
+  }
+}
+
+template <typename Kernel, typename Base>
+void BasicStaticInfiniteImpulseResponse<Kernel, Base>::onGyroscopeData(
+    myo::Myo* myo, uint64_t timestamp, const myo::Vector3<float>& gyro) {
+  if (flags_ & GyroscopeData) {
+    Base::onGyroscopeData(myo, timestamp, UpdateVector(GyroscopeGroup, gyro));
+  } else {
+    Base::onGyroscopeData(myo, timestamp, gyro);
+  }
+}
+
+template <typename Kernel, typename Base>
+void BasicStaticInfiniteImpulseResponse<Kernel, Base>::onOrientationDataBatch(
+    myo::Myo* myo, const core::OrientationBatch& batch) {
+  if (flags_ & OrientationData) {
+    this->filterOrientationDataBatch(
+        myo, batch, [this](uint64_t, const myo::Quaternion<float>& rotation) {
+          return UpdateOrientation(rotation);
+        });
+  } else {
+    Base::forwardOrientationDataBatch(myo, batch);
+  }
+}
+
+template <typename Kernel, typename Base>
+void BasicStaticInfiniteImpulseResponse<Kernel, Base>::onAccelerometerDataBatch(
+    myo::Myo* myo, const core::VectorBatch& batch) {
+  if (flags_ & AccelerometerData) {
+    this->filterAccelerometerDataBatch(
+        myo, batch, [this](uint64_t, const myo::Vector3<float>& acceleration) {
+          return UpdateVector(AccelerometerGroup, acceleration);
+        });
+  } else {
+    Base::forwardAccelerometerDataBatch(myo, batch);
+  }
+}
+
+template <typename Kernel, typename Base>
+void BasicStaticInfiniteImpulseResponse<Kernel, Base>::onGyroscopeDataBatch(
+    myo::Myo* myo, const core::VectorBatch& batch) {
+  if (flags_ & GyroscopeData) {
+    this->filterGyroscopeDataBatch(
+        myo, batch, [this](uint64_t, const myo::Vector3<float>& gyro) {
+          return UpdateVector(GyroscopeGroup, gyro);
+        });
+  } else {
+    Base::forwardGyroscopeDataBatch(myo, batch);
+  }
+}
+
+template <typename Kernel, typename Base>
+myo::Quaternion<float> BasicStaticInfiniteImpulseResponse<Kernel, Base>::
+    UpdateOrientation(const myo::Quaternion<float>& rotation) {
+  const core::Float4 input = orientation_mode_.input(core::Float4(rotation));
+  return orientation_mode_.output(bank_.update(OrientationGroup, input))
+      .toQuaternion();
+}
+
+template <typename Kernel, typename Base>
+myo::Vector3<float> BasicStaticInfiniteImpulseResponse<Kernel, Base>::
+    UpdateVector(Group group, const myo::Vector3<float>& data) {
+  return bank_.update(group, core::Float4(data)).toVector3();
+}
+}
+}
@@ -1,20 +1,25 @@
 /* Pose adds gesture detection for poses. Gestures include clicking,
- * double clicking, and holding the pose.
+ * double clicking, and holding the pose. Durations are measured with the given
+ * clock, see Clock.h.
  */
 
 #pragma once
 
+#include <array>
+#include <memory>
 #include <myo/myo.hpp>
 #include <string>
-#include <unordered_map>
+#include <vector>
 
+#include "../../core/Clock.h"
 #include "../../core/DeviceListenerWrapper.h"
 #include "../../core/Gesture.h"
-#include "../../../lib/Basic-Timer/BasicTimer.h"
 
 namespace features {
 namespace gestures {
-class PoseGestures : public core::DeviceListenerWrapper {
+// The gesture type does not depend on BasicPoseGestures's base class, so it
+// lives in a separate class to be shared by every instantiation.
+class PoseGesturesTypes {
  public:
   class Gesture : public core::Gesture {
    public:
@@ -23,32 +28,80 @@ class PoseGestures : public core::DeviceListenerWrapper {
     Gesture(Type type = none);
     Gesture(const std::shared_ptr<core::Pose>& pose, Type type);
 
+    Type type() const;
+
     virtual std::string toString() const override;
 
    private:
+    // The first of the ids reserved for Gesture::Type.
+    static Id FirstId();
+
     Type type_;
   };
+};
 
-  PoseGestures(core::DeviceListenerWrapper& parent_feature,
-               int click_max_hold_min = 1000, int double_click_timeout = 750);
+template <typename Base = core::DeviceListenerWrapper>
+class BasicPoseGestures : public Base, public PoseGesturesTypes {
+ public:
+  BasicPoseGestures(core::DeviceListenerWrapper& parent_feature,
+                    int click_max_hold_min = 1000,
+                    int double_click_timeout = 750,
+                    core::Clock& clock = core::WallClock::instance());
+
+  virtual core::EventMask handledEvents() const override;
 
   virtual void onPose(myo::Myo* myo, uint64_t timestamp,
                       const std::shared_ptr<core::Pose>& pose) override;
   virtual void onPeriodic(myo::Myo* myo) override;
 
  private:
+  struct GestureState {
+    GestureState() : time(0), timestamp(0), triggered(false) {}
+
+    // Emitted for this gesture so that the steady state does not allocate.
+    std::shared_ptr<Gesture> gesture;
+    // When the gesture was last triggered, on the clock and as the timestamp
+    // of the event which triggered it. Only valid if triggered is true.
+    uint64_t time;
+    uint64_t timestamp;
+    bool triggered;
+  };
+
+  // Returns the state of a gesture, creating the states for the pose the first
+  // time it is seen. This may invalidate references to the states of other
+  // poses, but not to those of the same pose.
+  GestureState& gestureState(const std::shared_ptr<core::Pose>& pose,
+                             Gesture::Type type);
+
   const int click_max_hold_min_, double_click_timeout_;
-  std::unordered_map<std::string, BasicTimer> gesture_timers_;
+  core::Clock& clock_;
+  // Indexed by pose id, then by gesture type.
+  std::vector<std::array<GestureState, Gesture::none + 1>> gesture_states_;
   std::shared_ptr<Gesture> last_gesture_;
 };
 
-PoseGestures::Gesture::Gesture(Type type) : core::Gesture(), type_(type) {}
+typedef BasicPoseGestures<> PoseGestures;
+
+PoseGesturesTypes::Gesture::Gesture(Type type) : core::Gesture(), type_(type) {
+  setId(FirstId() + type_);
+}
+
+PoseGesturesTypes::Gesture::Gesture(const std::shared_ptr<core::Pose>& pose,
+                                    Type type)
+    : core::Gesture(pose), type_(type) {
+  setId(FirstId() + type_);
+}
+
+PoseGesturesTypes::Gesture::Id PoseGesturesTypes::Gesture::FirstId() {
+  static const Id first_id = ReserveIds(none + 1);
+  return first_id;
+}
 
-PoseGestures::Gesture::Gesture(const std::shared_ptr<core::Pose>& pose,
-                               Type type)
-    : core::Gesture(pose), type_(type) {}
+PoseGesturesTypes::Gesture::Type PoseGesturesTypes::Gesture::type() const {
+  return type_;
+}
 
-std::string PoseGestures::Gesture::toString() const {
+std::string PoseGesturesTypes::Gesture::toString() const {
   switch (type_) {
     case singleClick:
       return "singleClick";
@@ -63,70 +116,99 @@ std::string PoseGestures::Gesture::toString() const {
   }
 }
 
-bool operator==(const PoseGestures::Gesture& lhs,
-                PoseGestures::Gesture::Type rhs) {
-  return lhs == PoseGestures::Gesture(rhs);
+bool operator==(const PoseGesturesTypes::Gesture& lhs,
+                PoseGesturesTypes::Gesture::Type rhs) {
+  return lhs == PoseGesturesTypes::Gesture(rhs);
 }
 
-bool operator!=(const PoseGestures::Gesture& lhs,
-                PoseGestures::Gesture::Type rhs) {
-  return lhs != PoseGestures::Gesture(rhs);
+bool operator!=(const PoseGesturesTypes::Gesture& lhs,
+                PoseGesturesTypes::Gesture::Type rhs) {
+  return lhs != PoseGesturesTypes::Gesture(rhs);
 }
 
-PoseGestures::PoseGestures(core::DeviceListenerWrapper& parent_feature,
-                           int click_max_hold_min, int double_click_timeout)
+template <typename Base>
+BasicPoseGestures<Base>::BasicPoseGestures(
+    core::DeviceListenerWrapper& parent_feature, int click_max_hold_min,
+    int double_click_timeout, core::Clock& clock)
     : click_max_hold_min_(click_max_hold_min),
       double_click_timeout_(double_click_timeout),
-      last_gesture_(new Gesture()) {
+      clock_(clock),
+      last_gesture_(gestureState(core::Pose::interned(core::Pose::rest),
+                                 Gesture::none).gesture) {
   parent_feature.addChildFeature(this);
 }
 
-void PoseGestures::onPose(myo::Myo* myo, uint64_t timestamp,
-                          const std::shared_ptr<core::Pose>& pose) {
-  BasicTimer now;
-  now.tick();
-
-  if (gesture_timers_.count(last_gesture_->toDescriptiveString()) > 0 &&
-      gesture_timers_[last_gesture_->toDescriptiveString()]
-              .millisecondsSinceTick() <= click_max_hold_min_) {
-    std::shared_ptr<core::Gesture> current_gesture;
-    if (gesture_timers_.count(
-            Gesture(last_gesture_->AssociatedPose(), Gesture::singleClick)
-                .toDescriptiveString()) > 0 &&
-        millisecondsBetweenTicks(
-            gesture_timers_[Gesture(last_gesture_->AssociatedPose(),
-                                    Gesture::singleClick)
-                                .toDescriptiveString()],
-            gesture_timers_[last_gesture_->toDescriptiveString()]) <=
+template <typename Base>
+core::EventMask BasicPoseGestures<Base>::handledEvents() const {
+  return core::EventBit(core::Event::Pose) |
+         core::EventBit(core::Event::Periodic);
+}
+
+template <typename Base>
+void BasicPoseGestures<Base>::onPose(myo::Myo* myo, uint64_t timestamp,
+                                     const std::shared_ptr<core::Pose>& pose) {
+  const uint64_t now = clock_.now();
+
+  const std::shared_ptr<core::Pose>& last_pose =
+      last_gesture_->AssociatedPose();
+  GestureState& last_state = gestureState(last_pose, last_gesture_->type());
+  if (last_state.triggered &&
+      core::millisecondsBetween(last_state.time, now) <= click_max_hold_min_) {
+    GestureState& single_click = gestureState(last_pose, Gesture::singleClick);
+    GestureState* current_state;
+    if (single_click.triggered &&
+        core::millisecondsBetween(single_click.time, last_state.time) <=
             double_click_timeout_) {
       // Double click. Suppress the current single click.
-      current_gesture.reset(
-          new Gesture(last_gesture_->AssociatedPose(), Gesture::doubleClick));
+      current_state = &gestureState(last_pose, Gesture::doubleClick);
     } else {
       // Single click.
-      current_gesture.reset(
-          new Gesture(last_gesture_->AssociatedPose(), Gesture::singleClick));
+      current_state = &single_click;
     }
-    gesture_timers_[current_gesture->toDescriptiveString()] = now;
-    core::DeviceListenerWrapper::onGesture(myo, timestamp, current_gesture);
+    current_state->time = now;
+    current_state->timestamp = timestamp;
+    current_state->triggered = true;
+    Base::onGesture(myo, timestamp, current_state->gesture);
   }
 
-  last_gesture_.reset(new Gesture(pose, Gesture::none));
-  gesture_timers_[last_gesture_->toDescriptiveString()] = now;
-  core::DeviceListenerWrapper::onPose(myo, timestamp, pose);
+  GestureState& pose_state = gestureState(pose, Gesture::none);
+  pose_state.time = now;
+  pose_state.timestamp = timestamp;
+  pose_state.triggered = true;
+  last_gesture_ = pose_state.gesture;
+  Base::onPose(myo, timestamp, pose);
 }
 
-void PoseGestures::onPeriodic(myo::Myo* myo) {
-  if (*last_gesture_ != Gesture(Gesture::hold) &&
-      gesture_timers_.count(Gesture(last_gesture_->AssociatedPose(),
-                                    Gesture::none).toDescriptiveString()) > 0 &&
-      gesture_timers_[Gesture(last_gesture_->AssociatedPose(), Gesture::none)
-                          .toDescriptiveString()].millisecondsSinceTick() >
-          click_max_hold_min_) {
-    last_gesture_.reset(new Gesture(last_gesture_->AssociatedPose(), Gesture::hold));
-    core::DeviceListenerWrapper::onGesture(myo, 0, last_gesture_);
+template <typename Base>
+void BasicPoseGestures<Base>::onPeriodic(myo::Myo* myo) {
+  if (last_gesture_->type() != Gesture::hold) {
+    const std::shared_ptr<core::Pose>& last_pose =
+        last_gesture_->AssociatedPose();
+    const GestureState& pose_state = gestureState(last_pose, Gesture::none);
+    if (pose_state.triggered &&
+        core::millisecondsBetween(pose_state.time, clock_.now()) >
+            click_max_hold_min_) {
+      last_gesture_ = gestureState(last_pose, Gesture::hold).gesture;
+      // A pose becomes a hold click_max_hold_min after it started.
+      Base::onGesture(myo, pose_state.timestamp + 1000 * click_max_hold_min_,
+                      last_gesture_);
+    }
+  }
+  Base::onPeriodic(myo);
+}
+
+template <typename Base>
+typename BasicPoseGestures<Base>::GestureState&
+BasicPoseGestures<Base>::gestureState(const std::shared_ptr<core::Pose>& pose,
+                                      Gesture::Type type) {
+  if (pose->id() >= gesture_states_.size()) {
+    gesture_states_.resize(pose->id() + 1);
+  }
+  GestureState& state = gesture_states_[pose->id()][type];
+  if (!state.gesture) {
+    state.gesture = std::make_shared<Gesture>(pose, type);
   }
-  core::DeviceListenerWrapper::onPeriodic(myo);
+  return state;
 }
 }
 }
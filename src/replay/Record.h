@@ -0,0 +1,309 @@
+/* Record is a compact, fixed size copy of one event from a Myo. A recorded
+ * session is a sequence of records, which Replayer can feed into a feature
+ * tree. Records are trivially copyable so that they can be stored as raw
+ * bytes.
+ *
+ * A session file is a SessionHeader followed by the records, both in the
+ * native byte order. See SessionRecorder.h and SessionReader.h.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <myo/myo.hpp>
+#include <type_traits>
+
+#include "../core/Event.h"
+#include "../core/Pose.h"
+
+namespace replay {
+struct Record {
+  // One factory per recordable event. myo_index is the index of the Myo which
+  // sent the event, see Replayer.
+  static Record pair(uint8_t myo_index, uint64_t timestamp,
+                     myo::FirmwareVersion firmware_version);
+  static Record unpair(uint8_t myo_index, uint64_t timestamp);
+  static Record connect(uint8_t myo_index, uint64_t timestamp,
+                        myo::FirmwareVersion firmware_version);
+  static Record disconnect(uint8_t myo_index, uint64_t timestamp);
+  static Record armSync(uint8_t myo_index, uint64_t timestamp, myo::Arm arm,
+                        myo::XDirection x_direction);
+  static Record armUnsync(uint8_t myo_index, uint64_t timestamp);
+  static Record unlock(uint8_t myo_index, uint64_t timestamp);
+  static Record lock(uint8_t myo_index, uint64_t timestamp);
+  static Record pose(uint8_t myo_index, uint64_t timestamp, myo::Pose pose);
+  // Poses added by derived classes of core::Pose are recorded as unknown.
+  static Record pose(uint8_t myo_index, uint64_t timestamp,
+                     const core::Pose& pose);
+  static Record orientationData(uint8_t myo_index, uint64_t timestamp,
+                                const myo::Quaternion<float>& rotation);
+  static Record accelerometerData(uint8_t myo_index, uint64_t timestamp,
+                                  const myo::Vector3<float>& acceleration);
+  static Record gyroscopeData(uint8_t myo_index, uint64_t timestamp,
+                              const myo::Vector3<float>& gyro);
+  static Record rssi(uint8_t myo_index, uint64_t timestamp, int8_t rssi);
+  static Record emgData(uint8_t myo_index, uint64_t timestamp,
+                        const int8_t* emg);
+  // Periodic calls are not part of a session file, but are queued along with
+  // the events by features::QueuedRootFeature.
+  static Record periodic(uint8_t myo_index);
+  // Nor are EMG envelopes, which are queued by features::Parallel.
+  static Record emgEnvelope(uint8_t myo_index, uint64_t timestamp,
+                            const int16_t* envelope);
+
+  // Calls the listener's method for this event. myo::DeviceListener has no
+  // onPeriodic, so periodic records are ignored.
+  void dispatch(myo::DeviceListener& listener, myo::Myo* myo) const;
+
+  core::Event::Type eventType() const;
+
+  uint8_t type;  // A core::Event::Type.
+  uint8_t myo_index;
+  uint64_t timestamp;
+  union {
+    myo::FirmwareVersion firmware_version;
+    struct {
+      myo::Arm arm;
+      myo::XDirection x_direction;
+    } arm_sync;
+    myo::Pose::Type pose_type;
+    float quaternion[4];  // x, y, z, w
+    float vector[3];      // x, y, z
+    int8_t rssi_value;
+    int8_t emg[8];
+    int16_t emg_envelope[8];
+  } data;
+
+ private:
+  static Record make(core::Event::Type type, uint8_t myo_index,
+                     uint64_t timestamp);
+};
+
+static_assert(std::is_trivially_copyable<Record>::value,
+              "Records are stored as raw bytes.");
+
+struct SessionHeader {
+  static const uint32_t kVersion = 1;
+
+  // A header for a session file written by this version of the library.
+  static SessionHeader current();
+
+  // Whether a session file with this header can be read.
+  bool valid() const;
+
+  char magic[8];
+  uint32_t version;
+  // sizeof(Record) of the writer.
+  uint32_t record_size;
+};
+
+SessionHeader SessionHeader::current() {
+  SessionHeader header = {{'M', 'Y', 'O', 'S', 'E', 'S', 'S', '\0'},
+                          kVersion,
+                          sizeof(Record)};
+  return header;
+}
+
+bool SessionHeader::valid() const {
+  SessionHeader expected = current();
+  return std::equal(magic, magic + sizeof(magic), expected.magic) &&
+         version == expected.version && record_size == expected.record_size;
+}
+
+Record Record::make(core::Event::Type type, uint8_t myo_index,
+                    uint64_t timestamp) {
+  Record record = Record();
+  record.type = type;
+  record.myo_index = myo_index;
+  record.timestamp = timestamp;
+  return record;
+}
+
+Record Record::pair(uint8_t myo_index, uint64_t timestamp,
+                    myo::FirmwareVersion firmware_version) {
+  Record record = make(core::Event::Pair, myo_index, timestamp);
+  record.data.firmware_version = firmware_version;
+  return record;
+}
+
+Record Record::unpair(uint8_t myo_index, uint64_t timestamp) {
+  return make(core::Event::Unpair, myo_index, timestamp);
+}
+
+Record Record::connect(uint8_t myo_index, uint64_t timestamp,
+                       myo::FirmwareVersion firmware_version) {
+  Record record = make(core::Event::Connect, myo_index, timestamp);
+  record.data.firmware_version = firmware_version;
+  return record;
+}
+
+Record Record::disconnect(uint8_t myo_index, uint64_t timestamp) {
+  return make(core::Event::Disconnect, myo_index, timestamp);
+}
+
+Record Record::armSync(uint8_t myo_index, uint64_t timestamp, myo::Arm arm,
+                       myo::XDirection x_direction) {
+  Record record = make(core::Event::ArmSync, myo_index, timestamp);
+  record.data.arm_sync.arm = arm;
+  record.data.arm_sync.x_direction = x_direction;
+  return record;
+}
+
+Record Record::armUnsync(uint8_t myo_index, uint64_t timestamp) {
+  return make(core::Event::ArmUnsync, myo_index, timestamp);
+}
+
+Record Record::unlock(uint8_t myo_index, uint64_t timestamp) {
+  return make(core::Event::Unlock, myo_index, timestamp);
+}
+
+Record Record::lock(uint8_t myo_index, uint64_t timestamp) {
+  return make(core::Event::Lock, myo_index, timestamp);
+}
+
+Record Record::pose(uint8_t myo_index, uint64_t timestamp, myo::Pose pose) {
+  Record record = make(core::Event::Pose, myo_index, timestamp);
+  record.data.pose_type = pose.type();
+  return record;
+}
+
+Record Record::pose(uint8_t myo_index, uint64_t timestamp,
+                    const core::Pose& pose) {
+  switch (pose.type()) {
+    case core::Pose::rest:
+      return Record::pose(myo_index, timestamp, myo::Pose::rest);
+    case core::Pose::fist:
+      return Record::pose(myo_index, timestamp, myo::Pose::fist);
+    case core::Pose::waveIn:
+      return Record::pose(myo_index, timestamp, myo::Pose::waveIn);
+    case core::Pose::waveOut:
+      return Record::pose(myo_index, timestamp, myo::Pose::waveOut);
+    case core::Pose::fingersSpread:
+      return Record::pose(myo_index, timestamp, myo::Pose::fingersSpread);
+    case core::Pose::doubleTap:
+      return Record::pose(myo_index, timestamp, myo::Pose::doubleTap);
+    default:
+      return Record::pose(myo_index, timestamp, myo::Pose::unknown);
+  }
+}
+
+Record Record::orientationData(uint8_t myo_index, uint64_t timestamp,
+                               const myo::Quaternion<float>& rotation) {
+  Record record = make(core::Event::OrientationData, myo_index, timestamp);
+  record.data.quaternion[0] = rotation.x();
+  record.data.quaternion[1] = rotation.y();
+  record.data.quaternion[2] = rotation.z();
+  record.data.quaternion[3] = rotation.w();
+  return record;
+}
+
+Record Record::accelerometerData(uint8_t myo_index, uint64_t timestamp,
+                                 const myo::Vector3<float>& acceleration) {
+  Record record = make(core::Event::AccelerometerData, myo_index, timestamp);
+  record.data.vector[0] = acceleration.x();
+  record.data.vector[1] = acceleration.y();
+  record.data.vector[2] = acceleration.z();
+  return record;
+}
+
+Record Record::gyroscopeData(uint8_t myo_index, uint64_t timestamp,
+                             const myo::Vector3<float>& gyro) {
+  Record record = make(core::Event::GyroscopeData, myo_index, timestamp);
+  record.data.vector[0] = gyro.x();
+  record.data.vector[1] = gyro.y();
+  record.data.vector[2] = gyro.z();
+  return record;
+}
+
+Record Record::rssi(uint8_t myo_index, uint64_t timestamp, int8_t rssi) {
+  Record record = make(core::Event::Rssi, myo_index, timestamp);
+  record.data.rssi_value = rssi;
+  return record;
+}
+
+Record Record::emgData(uint8_t myo_index, uint64_t timestamp,
+                       const int8_t* emg) {
+  Record record = make(core::Event::EmgData, myo_index, timestamp);
+  for (int i = 0; i < 8; ++i) {
+    record.data.emg[i] = emg[i];
+  }
+  return record;
+}
+
+Record Record::periodic(uint8_t myo_index) {
+  return make(core::Event::Periodic, myo_index, 0);
+}
+
+Record Record::emgEnvelope(uint8_t myo_index, uint64_t timestamp,
+                           const int16_t* envelope) {
+  Record record = make(core::Event::EmgEnvelope, myo_index, timestamp);
+  for (int i = 0; i < 8; ++i) {
+    record.data.emg_envelope[i] = envelope[i];
+  }
+  return record;
+}
+
+void Record::dispatch(myo::DeviceListener& listener, myo::Myo* myo) const {
+  switch (eventType()) {
+    case core::Event::Pair:
+      listener.onPair(myo, timestamp, data.firmware_version);
+      break;
+    case core::Event::Unpair:
+      listener.onUnpair(myo, timestamp);
+      break;
+    case core::Event::Connect:
+      listener.onConnect(myo, timestamp, data.firmware_version);
+      break;
+    case core::Event::Disconnect:
+      listener.onDisconnect(myo, timestamp);
+      break;
+    case core::Event::ArmSync:
+      listener.onArmSync(myo, timestamp, data.arm_sync.arm,
+                         data.arm_sync.x_direction);
+      break;
+    case core::Event::ArmUnsync:
+      listener.onArmUnsync(myo, timestamp);
+      break;
+    case core::Event::Unlock:
+      listener.onUnlock(myo, timestamp);
+      break;
+    case core::Event::Lock:
+      listener.onLock(myo, timestamp);
+      break;
+    case core::Event::Pose:
+      listener.onPose(myo, timestamp, myo::Pose(data.pose_type));
+      break;
+    case core::Event::OrientationData:
+      listener.onOrientationData(
+          myo, timestamp,
+          myo::Quaternion<float>(data.quaternion[0], data.quaternion[1],
+                                 data.quaternion[2], data.quaternion[3]));
+      break;
+    case core::Event::AccelerometerData:
+      listener.onAccelerometerData(
+          myo, timestamp,
+          myo::Vector3<float>(data.vector[0], data.vector[1], data.vector[2]));
+      break;
+    case core::Event::GyroscopeData:
+      listener.onGyroscopeData(
+          myo, timestamp,
+          myo::Vector3<float>(data.vector[0], data.vector[1], data.vector[2]));
+      break;
+    case core::Event::Rssi:
+      listener.onRssi(myo, timestamp, data.rssi_value);
+      break;
+    case core::Event::EmgData:
+      listener.onEmgData(myo, timestamp, data.emg);
+      break;
+    default:
+      // Gestures, EMG envelopes and periodic calls are not part of a
+      // recording.
+      break;
+  }
+}
+
+core::Event::Type Record::eventType() const {
+  return static_cast<core::Event::Type>(type);
+}
+}
@@ -0,0 +1,142 @@
+/* Replayer feeds a recorded session straight into a feature tree, as fast as
+ * the feature tree can process it. onPeriodic is called at the times it would
+ * have been called while recording, and the root feature's device clock
+ * follows the recording, so features given that clock (see Clock.h) produce
+ * the same results as they did live.
+ *
+ *   features::RootFeature root_feature;
+ *   features::filters::Debounce debounce(root_feature, 10,
+ *                                        root_feature.deviceClock());
+ *   replay::Replayer<> replayer(root_feature);
+ *   replay::ReplayStats stats = replayer.play(records);
+ *   std::cout << stats.eventsPerSecond() << " events/sec" << std::endl;
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <iterator>
+#include <myo/myo.hpp>
+#include <vector>
+
+#include "../features/RootFeature.h"
+#include "Record.h"
+
+namespace replay {
+struct ReplayStats {
+  ReplayStats();
+
+  // Events passed to on* methods other than onPeriodic, per real second.
+  double eventsPerSecond() const;
+  // How many times faster than real time the session was played.
+  double realTimeFactor() const;
+
+  uint64_t events;
+  uint64_t periodic_calls;
+  // Timestamp of the last record minus that of the first, in microseconds.
+  uint64_t recorded_us;
+  // Real time spent playing the session.
+  double seconds;
+};
+
+template <typename RootFeature = features::RootFeature>
+class Replayer {
+ public:
+  // periodic_ms is how often onPeriodic was called while recording, e.g. 50
+  // for a loop around hub.run(1000 / 20).
+  Replayer(RootFeature& root_feature, int periodic_ms = 50);
+
+  // Sets the Myo passed to the feature tree for records with the given
+  // myo_index. By default every record is passed a null Myo. onPeriodic is
+  // passed the Myo with index 0.
+  void setMyo(uint8_t myo_index, myo::Myo* myo);
+
+  // Plays a range of records, which must be in timestamp order. Like the
+  // usual hub.run loop, onPeriodic is called once more after the last record.
+  template <typename Iterator>
+  ReplayStats play(Iterator begin, Iterator end);
+  template <typename Records>
+  ReplayStats play(const Records& records);
+
+ private:
+  myo::Myo* myoFor(uint8_t myo_index) const;
+  void periodic(uint64_t timestamp);
+
+  RootFeature& root_feature_;
+  const uint64_t periodic_us_;
+  std::vector<myo::Myo*> myos_;
+};
+
+ReplayStats::ReplayStats()
+    : events(0), periodic_calls(0), recorded_us(0), seconds(0) {}
+
+double ReplayStats::eventsPerSecond() const { return events / seconds; }
+
+double ReplayStats::realTimeFactor() const {
+  return recorded_us / (seconds * 1e6);
+}
+
+template <typename RootFeature>
+Replayer<RootFeature>::Replayer(RootFeature& root_feature, int periodic_ms)
+    : root_feature_(root_feature), periodic_us_(periodic_ms * 1000) {}
+
+template <typename RootFeature>
+void Replayer<RootFeature>::setMyo(uint8_t myo_index, myo::Myo* myo) {
+  if (myo_index >= myos_.size()) {
+    myos_.resize(myo_index + 1, nullptr);
+  }
+  myos_[myo_index] = myo;
+}
+
+template <typename RootFeature>
+template <typename Iterator>
+ReplayStats Replayer<RootFeature>::play(Iterator begin, Iterator end) {
+  ReplayStats stats;
+  if (begin == end) {
+    return stats;
+  }
+
+  std::chrono::steady_clock::time_point start =
+      std::chrono::steady_clock::now();
+  const uint64_t first_timestamp = begin->timestamp;
+  uint64_t last_timestamp = first_timestamp;
+  uint64_t next_periodic = first_timestamp + periodic_us_;
+  for (Iterator record = begin; record != end; ++record) {
+    // Every event which arrived during a call to hub.run is followed by the
+    // onPeriodic call at the end of that run.
+    while (record->timestamp >= next_periodic) {
+      periodic(next_periodic);
+      next_periodic += periodic_us_;
+      ++stats.periodic_calls;
+    }
+    record->dispatch(root_feature_, myoFor(record->myo_index));
+    last_timestamp = record->timestamp;
+    ++stats.events;
+  }
+  periodic(next_periodic);
+  ++stats.periodic_calls;
+
+  stats.seconds = std::chrono::duration<double>(
+                      std::chrono::steady_clock::now() - start).count();
+  stats.recorded_us = last_timestamp - first_timestamp;
+  return stats;
+}
+
+template <typename RootFeature>
+template <typename Records>
+ReplayStats Replayer<RootFeature>::play(const Records& records) {
+  return play(std::begin(records), std::end(records));
+}
+
+template <typename RootFeature>
+myo::Myo* Replayer<RootFeature>::myoFor(uint8_t myo_index) const {
+  return myo_index < myos_.size() ? myos_[myo_index] : nullptr;
+}
+
+template <typename RootFeature>
+void Replayer<RootFeature>::periodic(uint64_t timestamp) {
+  root_feature_.deviceClock().advance(timestamp);
+  root_feature_.onPeriodic(myoFor(0));
+}
+}
@@ -0,0 +1,88 @@
+/* SessionReader memory maps a session file written by SessionRecorder. The
+ * records are used in place, without being copied, so a session of any length
+ * can be played with Replayer:
+ *
+ *   replay::SessionReader session("session.myo");
+ *   replayer.play(session);
+ *
+ * The file is mapped read only and must not be modified while it is open.
+ * A trailing partial record, e.g. from a recording which was interrupted, is
+ * ignored. Memory mapping uses the POSIX API.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <fcntl.h>
+#include <stdexcept>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "Record.h"
+
+namespace replay {
+class SessionReader {
+ public:
+  // Throws std::runtime_error if the file can not be mapped or is not a
+  // session file written by this version of the library.
+  explicit SessionReader(const std::string& path);
+  ~SessionReader();
+
+  SessionReader(const SessionReader&) = delete;
+  SessionReader& operator=(const SessionReader&) = delete;
+
+  const Record* begin() const;
+  const Record* end() const;
+  std::size_t size() const;
+
+ private:
+  void* data_;
+  std::size_t length_;
+  const Record* records_;
+  std::size_t size_;
+};
+
+SessionReader::SessionReader(const std::string& path)
+    : data_(MAP_FAILED), length_(0), records_(nullptr), size_(0) {
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    throw std::runtime_error("Unable to open " + path + ".");
+  }
+  struct stat file_stat;
+  if (fstat(fd, &file_stat) < 0) {
+    close(fd);
+    throw std::runtime_error("Unable to read the size of " + path + ".");
+  }
+  length_ = file_stat.st_size;
+  if (length_ < sizeof(SessionHeader)) {
+    close(fd);
+    throw std::runtime_error(path + " is not a session file.");
+  }
+  data_ = mmap(nullptr, length_, PROT_READ, MAP_PRIVATE, fd, 0);
+  // The mapping stays valid after the file is closed.
+  close(fd);
+  if (data_ == MAP_FAILED) {
+    throw std::runtime_error("Unable to map " + path + ".");
+  }
+  if (!static_cast<const SessionHeader*>(data_)->valid()) {
+    munmap(data_, length_);
+    throw std::runtime_error(path + " is not a compatible session file.");
+  }
+  // Records are read front to back.
+  madvise(data_, length_, MADV_SEQUENTIAL);
+
+  records_ = reinterpret_cast<const Record*>(static_cast<const char*>(data_) +
+                                             sizeof(SessionHeader));
+  size_ = (length_ - sizeof(SessionHeader)) / sizeof(Record);
+}
+
+SessionReader::~SessionReader() { munmap(data_, length_); }
+
+const Record* SessionReader::begin() const { return records_; }
+
+const Record* SessionReader::end() const { return records_ + size_; }
+
+std::size_t SessionReader::size() const { return size_; }
+}
@@ -1,3 +1,4 @@
+#include <array>
 #include <string>
 #include <sstream>
 #include "../src/core/DeviceListenerWrapper.h"
@@ -23,6 +24,16 @@ std::ostream& operator<<(std::ostream& out,
   return out;
 }
 
+template <typename T>
+std::ostream& operator<<(std::ostream& out, const std::array<T, 8>& values) {
+  out << "(" << values[0];
+  for (std::size_t i = 1; i < 8; ++i) {
+    out << ", " << values[i];
+  }
+  out << ")";
+  return out;
+}
+
 std::ostream& operator<<(std::ostream& out, const myo::Vector3<float>& quat) {
   out << "(" << quat.x();
   out << ", " << quat.y();
@@ -98,6 +109,10 @@ class PrintEvents : public core::DeviceListenerWrapper {
   virtual void onEmgData(myo::Myo* myo, uint64_t timestamp,
                          const int8_t* emg) override;
   virtual void onPeriodic(myo::Myo* myo) override;
+  virtual void onEmgEnvelope(myo::Myo* myo, uint64_t timestamp,
+                             const int16_t* envelope) override;
+  virtual void onEmgFeatures(myo::Myo* myo, uint64_t timestamp,
+                             const core::EmgFeatures& features) override;
 
  private:
   std::string& out_;
@@ -275,3 +290,34 @@ void PrintEvents::onPeriodic(myo::Myo* myo) {
   ss << "\n";
   out_ += ss.str();
 }
+
+void PrintEvents::onEmgEnvelope(myo::Myo* myo, uint64_t timestamp,
+                                const int16_t* envelope) {
+  std::stringstream ss;
+  ss << "onEmgEnvelope -";
+  ss << PRINT_NAME_AND_VAR(myo);
+  ss << PRINT_NAME_AND_VAR(timestamp);
+  ss << " envelope: (";
+  ss << envelope[0];
+  for (std::size_t i = 1; i < 8; ++i) {
+    ss << ", " << envelope[i];
+  }
+  ss << ")\n";
+  out_ += ss.str();
+}
+
+void PrintEvents::onEmgFeatures(myo::Myo* myo, uint64_t timestamp,
+                                const core::EmgFeatures& features) {
+  std::stringstream ss;
+  ss << "onEmgFeatures -";
+  ss << PRINT_NAME_AND_VAR(myo);
+  ss << PRINT_NAME_AND_VAR(timestamp);
+  ss << " window_size: " << features.window_size;
+  ss << " mav: " << features.mean_absolute_value;
+  ss << " rms: " << features.root_mean_square;
+  ss << " wl: " << features.waveform_length;
+  ss << " zc: " << features.zero_crossings;
+  ss << " ssc: " << features.slope_sign_changes;
+  ss << "\n";
+  out_ += ss.str();
+}
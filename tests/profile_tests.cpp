@@ -0,0 +1,80 @@
+// The profiler is compiled only with MYO_INTELLIGESTURE_PROFILE, so its tests
+// are a program of their own. tests.cpp tests the library without it.
+#define MYO_INTELLIGESTURE_PROFILE
+
+#include <cassert>
+#include <myo/myo.hpp>
+#include <sstream>
+#include <string>
+
+#include "../src/core/Pipeline.h"
+#include "../src/core/Profile.h"
+#include "../src/features/RootFeature.h"
+#include "../src/features/filters/Debounce.h"
+#include "../src/features/filters/MovingAverage.h"
+
+#include "PrintEventsFeature.h"
+
+void testProfile();
+void testPipelineProfile();
+
+int main() {
+  testProfile();
+  testPipelineProfile();
+
+  return 0;
+}
+
+void testProfile() {
+  using features::filters::MovingAverage;
+  features::RootFeature root_feature;
+  MovingAverage moving_average(root_feature, MovingAverage::OrientationData,
+                               2);
+  std::string str;
+  PrintEvents print_events(moving_average, str);
+  for (uint64_t timestamp = 0; timestamp < 5; ++timestamp) {
+    root_feature.onOrientationData(nullptr, timestamp,
+                                   myo::Quaternion<float>(0.f, 0.f, 0.f, 1.f));
+  }
+  root_feature.onPose(nullptr, 5, myo::Pose::fist);
+
+  // The root feature is not called by another feature.
+  assert(root_feature.profile().event(core::Event::OrientationData).calls ==
+         0);
+  const core::EventProfile& parent =
+      moving_average.profile().event(core::Event::OrientationData);
+  const core::EventProfile& child =
+      print_events.profile().event(core::Event::OrientationData);
+  assert(parent.calls == 5);
+  assert(child.calls == 5);
+  assert(parent.latency.count() == 5);
+  assert(parent.exclusive_ns + child.inclusive_ns == parent.inclusive_ns);
+  assert(child.exclusive_ns == child.inclusive_ns);
+  assert(moving_average.profile().event(core::Event::Pose).calls == 1);
+  assert(print_events.profile().event(core::Event::Pose).calls == 1);
+
+  std::ostringstream out;
+  root_feature.writeProfile(out);
+  std::string profile = out.str();
+  assert(profile.find("\n    OrientationData calls=5 ") != std::string::npos);
+  assert(profile.find("\n      OrientationData calls=5 ") !=
+         std::string::npos);
+  assert(profile.find("\n      Pose calls=1 ") != std::string::npos);
+
+  moving_average.profile().reset();
+  assert(moving_average.profile().event(core::Event::Pose).calls == 0);
+}
+
+void testPipelineProfile() {
+  core::Pipeline<features::BasicRootFeature, features::filters::BasicDebounce>
+      pipeline;
+  std::string str;
+  PrintEvents print_events(pipeline.leaf(), str);
+  pipeline.root().onPose(nullptr, 0, myo::Pose::fist);
+
+  // The statically dispatched stage is profiled like a dynamic child.
+  assert(pipeline.leaf().profile().event(core::Event::Pose).calls == 1);
+  std::ostringstream out;
+  pipeline.root().writeProfile(out);
+  assert(out.str().find("\n    Pose calls=1 ") != std::string::npos);
+}
@@ -1,11 +1,41 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
 #include <myo/myo.hpp>
+#include <sstream>
 #include <string>
+#include <thread>
 
 #include "../src/core/DeviceListenerWrapper.h"
+#include "../src/core/OrderStatisticTree.h"
+#include "../src/core/Pipeline.h"
+#include "../src/core/SpscRing.h"
+#include "../src/core/ThreadPool.h"
 #include "../src/features/RootFeature.h"
+#include "../src/features/Blocker.h"
+#include "../src/features/CorrectForOrientation.h"
+#include "../src/features/EmgFeatureExtractor.h"
+#include "../src/features/LatencyTracer.h"
+#include "../src/features/Orientation.h"
+#include "../src/features/Parallel.h"
+#include "../src/features/PerMyo.h"
+#include "../src/features/QueuedRootFeature.h"
+#include "../src/features/SessionRecorder.h"
+#include "../src/features/OrientationPoses.h"
+#include "../src/features/filters/Biquad.h"
+#include "../src/features/filters/Convolution.h"
 #include "../src/features/filters/Debounce.h"
+#include "../src/features/filters/EmgFilter.h"
 #include "../src/features/filters/ExponentialMovingAverage.h"
+#include "../src/features/filters/StaticInfiniteImpulseResponse.h"
+#include "../src/features/filters/Median.h"
 #include "../src/features/filters/MovingAverage.h"
+#include "../src/features/filters/OneEuroFilter.h"
+#include "../src/features/gestures/PoseGestures.h"
+#include "../src/replay/Record.h"
+#include "../src/replay/Replayer.h"
+#include "../src/replay/SessionReader.h"
 
 #include "../lib/MyoSimulator/src/Hub.h"
 #include "../lib/MyoSimulator/src/EventTypes.h"
@@ -18,6 +48,30 @@ void testRootFeature();
 void testDebounce();
 void testExponentialMovingAverage();
 void testMovingAverage();
+void testPipeline();
+void testSubscriptions();
+void testTypeIds();
+void testInterning();
+void testDeviceClock();
+void testReplayer();
+void testSessionFile();
+void testLatencyTracer();
+void testSpscRing();
+void testQueuedRootFeature();
+void testPerMyo();
+void testThreadPool();
+void testParallel();
+void testSampleBatch();
+void testInfiniteImpulseResponseBank();
+void testConvolution();
+void testEmgFilter();
+void testEmgFeatureExtractor();
+void testStaticMovingAverage();
+void testBiquad();
+void testOneEuroFilter();
+void testMedianFilter();
+void testQuaternionOrientation();
+void testOrientation();
 
 // Test using MyoSimulator.
 void myoSimTestRootFeature(MyoSim::Hub& hub);
@@ -31,6 +85,30 @@ int main() {
   testDebounce();
   testExponentialMovingAverage();
   testMovingAverage();
+  testPipeline();
+  testSubscriptions();
+  testTypeIds();
+  testInterning();
+  testDeviceClock();
+  testReplayer();
+  testSessionFile();
+  testLatencyTracer();
+  testSpscRing();
+  testQueuedRootFeature();
+  testPerMyo();
+  testThreadPool();
+  testParallel();
+  testSampleBatch();
+  testInfiniteImpulseResponseBank();
+  testConvolution();
+  testEmgFilter();
+  testEmgFeatureExtractor();
+  testStaticMovingAverage();
+  testBiquad();
+  testOneEuroFilter();
+  testMedianFilter();
+  testQuaternionOrientation();
+  testOrientation();
 
   // Test using MyoSimulator.
   MyoSim::Hub hub("com.voidingwarranties.myo-intelligesture-tests");
@@ -230,6 +308,1691 @@ void testMovingAverage() {
   }
 }
 
+// A pipeline stage which needs only poses, and counts the poses and
+// orientation samples it is given.
+template <typename Base>
+class BasicCountEvents : public Base {
+ public:
+  explicit BasicCountEvents(core::DeviceListenerWrapper& parent_feature)
+      : poses(0), orientations(0) {
+    parent_feature.addChildFeature(this);
+  }
+  virtual core::EventMask handledEvents() const override {
+    return core::EventBit(core::Event::Pose);
+  }
+  virtual void onPose(myo::Myo* myo, uint64_t timestamp,
+                      const std::shared_ptr<core::Pose>& pose) override {
+    ++poses;
+    Base::onPose(myo, timestamp, pose);
+  }
+  virtual void onOrientationData(
+      myo::Myo* myo, uint64_t timestamp,
+      const myo::Quaternion<float>& rotation) override {
+    ++orientations;
+    Base::onOrientationData(myo, timestamp, rotation);
+  }
+  int poses;
+  int orientations;
+};
+
+void testPipeline() {
+  using features::filters::MovingAverage;
+  using features::filters::ExponentialMovingAverage;
+  auto average_flags =
+      MovingAverage::OrientationData | MovingAverage::AccelerometerData;
+  auto exponential_flags = ExponentialMovingAverage::AccelerometerData |
+                           ExponentialMovingAverage::GyroscopeData;
+
+  features::RootFeature root_feature;
+  MovingAverage moving_average(root_feature, average_flags, 2);
+  ExponentialMovingAverage exponential_moving_average(moving_average,
+                                                      exponential_flags, 0.5f);
+  features::filters::Debounce debounce(exponential_moving_average, 5);
+  std::string dynamic_str;
+  PrintEvents dynamic_print_events(debounce, dynamic_str);
+
+  core::Pipeline<features::BasicRootFeature,
+                 features::filters::BasicMovingAverage,
+                 features::filters::BasicExponentialMovingAverage,
+                 features::filters::BasicDebounce>
+      pipeline(std::make_tuple(), std::make_tuple(average_flags, 2),
+               std::make_tuple(exponential_flags, 0.5f), std::make_tuple(5));
+  std::string static_str;
+  PrintEvents static_print_events(pipeline.leaf(), static_str);
+
+  // The pipeline must emit exactly the same events as the equivalent dynamic
+  // feature tree.
+  auto send_events = [](auto& root) {
+    uint64_t timestamp = 0;
+    for (std::size_t i = 0; i < 3; ++i) {
+      root.onOrientationData(nullptr, timestamp++,
+                             myo::Quaternion<float>(i, i, i, i));
+      root.onAccelerometerData(nullptr, timestamp++,
+                               myo::Vector3<float>(i, i, i));
+      root.onGyroscopeData(nullptr, timestamp++, myo::Vector3<float>(i, i, i));
+    }
+    root.onPose(nullptr, timestamp++, myo::Pose::fist);
+    root.onPose(nullptr, timestamp + 5001, myo::Pose::rest);
+    root.onRssi(nullptr, timestamp++, 123);
+  };
+  send_events(root_feature);
+  send_events(pipeline.root());
+
+  assert(!static_str.empty());
+  assert(static_str == dynamic_str);
+
+  // A statically dispatched stage only receives the events its subtree
+  // subscribes to, also when a pipeline is attached below an existing feature.
+  features::RootFeature parent_feature;
+  core::Pipeline<BasicCountEvents, BasicCountEvents> attached(
+      parent_feature, std::make_tuple(), std::make_tuple());
+  auto& first = attached.root();
+  auto& second = attached.leaf();
+  parent_feature.onOrientationData(nullptr, 0, myo::Quaternion<float>());
+  parent_feature.onPose(nullptr, 1, myo::Pose::fist);
+  assert(first.orientations == 0 && second.orientations == 0);
+  assert(first.poses == 1 && second.poses == 1);
+  std::string attached_str;
+  PrintEvents attached_print_events(second, attached_str);
+  parent_feature.onOrientationData(nullptr, 2, myo::Quaternion<float>());
+  assert(first.orientations == 1 && second.orientations == 1);
+  assert(!attached_str.empty());
+}
+
+void testSubscriptions() {
+  using core::EventBit;
+  features::RootFeature root_feature;
+  features::filters::MovingAverage moving_average(
+      root_feature, features::filters::MovingAverage::OrientationData, 2);
+  features::Orientation orientation(moving_average);
+  features::filters::Debounce debounce(root_feature);
+  features::Blocker blocker(
+      root_feature, features::Blocker::EmgData | features::Blocker::Rssi);
+  std::string str;
+  PrintEvents print_events(blocker, str);
+
+  assert(orientation.subscribedEvents() ==
+         (EventBit(core::Event::OrientationData) |
+          EventBit(core::Event::ArmSync)));
+  assert(moving_average.subscribedEvents() ==
+         orientation.subscribedEvents());
+  assert(debounce.subscribedEvents() ==
+         (EventBit(core::Event::Pose) | EventBit(core::Event::Periodic)));
+  assert(blocker.subscribedEvents() ==
+         (core::AllEvents & ~EventBit(core::Event::EmgData) &
+          ~EventBit(core::Event::Rssi)));
+  assert(root_feature.subscribedEvents() ==
+         (core::AllEvents & ~EventBit(core::Event::EmgData) &
+          ~EventBit(core::Event::Rssi)));
+
+  // Removing the only feature which wants every event must prune the
+  // subscriptions of all of its ancestors.
+  blocker.removeChildFeature(&print_events);
+  assert(blocker.subscribedEvents() == core::NoEvents);
+  assert(root_feature.subscribedEvents() ==
+         (orientation.subscribedEvents() | debounce.subscribedEvents()));
+}
+
+void testTypeIds() {
+  typedef features::OrientationPoses::Pose OrientationPose;
+  typedef features::gestures::PoseGestures::Gesture PoseGesture;
+  std::hash<core::Pose> pose_hash;
+
+  assert(core::Pose(core::Pose::fist) == core::Pose(myo::Pose::fist));
+  assert(core::Pose(core::Pose::fist) != core::Pose(core::Pose::rest));
+  // Derived poses are equal to the core poses they wrap, but not to any new
+  // poses they add.
+  assert(OrientationPose(core::Pose::waveIn) == core::Pose(core::Pose::waveIn));
+  assert(OrientationPose(OrientationPose::unknown) == core::Pose());
+  assert(OrientationPose(OrientationPose::waveUp) != core::Pose());
+  assert(OrientationPose(OrientationPose::waveUp) !=
+         OrientationPose(OrientationPose::waveDown));
+  for (int type = core::Pose::rest; type <= core::Pose::unknown; ++type) {
+    assert(OrientationPose(OrientationPose::waveUp) !=
+           core::Pose(static_cast<core::Pose::Type>(type)));
+    assert(OrientationPose(OrientationPose::waveDown) !=
+           core::Pose(static_cast<core::Pose::Type>(type)));
+  }
+  assert(pose_hash(OrientationPose(OrientationPose::waveUp)) ==
+         pose_hash(OrientationPose(OrientationPose::waveUp)));
+  assert(pose_hash(OrientationPose(OrientationPose::waveUp)) !=
+         pose_hash(OrientationPose(OrientationPose::waveDown)));
+
+  // The associated pose is not part of a gesture's identity.
+  std::shared_ptr<core::Pose> fist(new core::Pose(core::Pose::fist));
+  assert(PoseGesture(fist, PoseGesture::hold) ==
+         PoseGesture(PoseGesture::hold));
+  assert(PoseGesture(PoseGesture::hold) != PoseGesture(PoseGesture::none));
+  assert(PoseGesture(PoseGesture::singleClick) != core::Gesture());
+  assert(PoseGesture(PoseGesture::none).toString() == "none");
+}
+
+void testInterning() {
+  typedef features::OrientationPoses::Pose OrientationPose;
+  assert(core::Pose::interned(core::Pose::fist) ==
+         core::Pose::interned(myo::Pose(myo::Pose::fist)));
+  assert(*core::Pose::interned(core::Pose::fist) ==
+         core::Pose(core::Pose::fist));
+  assert(*OrientationPose::interned(OrientationPose::waveUp) ==
+         OrientationPose(OrientationPose::waveUp));
+
+  // Repeated poses and gestures are the same instances.
+  class RecordPoses : public core::DeviceListenerWrapper {
+   public:
+    RecordPoses(core::DeviceListenerWrapper& parent_feature) {
+      parent_feature.addChildFeature(this);
+    }
+    virtual void onPose(myo::Myo*, uint64_t,
+                        const std::shared_ptr<core::Pose>& pose) override {
+      poses.push_back(pose.get());
+    }
+    virtual void onGesture(myo::Myo*, uint64_t,
+                           const std::shared_ptr<core::Gesture>& gesture)
+        override {
+      gestures.push_back(gesture.get());
+    }
+    std::vector<core::Pose*> poses;
+    std::vector<core::Gesture*> gestures;
+  };
+  features::RootFeature root_feature;
+  features::gestures::PoseGestures pose_gestures(root_feature);
+  RecordPoses record(pose_gestures);
+  for (int i = 0; i < 3; ++i) {
+    root_feature.onPose(nullptr, 0, myo::Pose::fist);
+    root_feature.onPose(nullptr, 0, myo::Pose::rest);
+  }
+  // Single clicks of fist and rest followed by three double clicks.
+  assert(record.poses.size() == 6);
+  assert(record.poses[0] == record.poses[4]);
+  assert(record.poses[1] == record.poses[5]);
+  assert(record.gestures.size() == 5);
+  assert(record.gestures[0] != record.gestures[2]);
+  assert(record.gestures[2] == record.gestures[4]);
+}
+
+void testDeviceClock() {
+  core::DeviceClock clock;
+  clock.advance(10);
+  clock.advance(5);
+  assert(clock.now() == 10);
+
+  // Nothing here depends on how long the test takes to run.
+  features::RootFeature root_feature;
+  features::filters::Debounce debounce(root_feature, 10,
+                                       root_feature.deviceClock());
+  features::gestures::PoseGestures pose_gestures(
+      debounce, 1000, 750, root_feature.deviceClock());
+  std::string str;
+  PrintEvents print_events(pose_gestures, str);
+  uint64_t ms = 1000;
+  root_feature.onPose(nullptr, 0, myo::Pose::fist);
+  root_feature.onPeriodic(nullptr);
+  root_feature.onLock(nullptr, 20 * ms);
+  root_feature.onPeriodic(nullptr);
+  root_feature.onPose(nullptr, 100 * ms, myo::Pose::rest);
+  root_feature.onLock(nullptr, 120 * ms);
+  root_feature.onPeriodic(nullptr);
+  root_feature.onLock(nullptr, 1200 * ms);
+  root_feature.onPeriodic(nullptr);
+  root_feature.onPeriodic(nullptr);
+
+  assert(str ==
+         "onPeriodic - myo: 0x0\n"
+         "onLock - myo: 0x0 timestamp: 20000\n"
+         "onPose - myo: 0x0 timestamp: 0 *pose: fist\n"
+         "onPeriodic - myo: 0x0\n"
+         "onLock - myo: 0x0 timestamp: 120000\n"
+         "onGesture - myo: 0x0 timestamp: 100000 *gesture: singleClick\n"
+         "onPose - myo: 0x0 timestamp: 100000 *pose: rest\n"
+         "onPeriodic - myo: 0x0\n"
+         "onLock - myo: 0x0 timestamp: 1200000\n"
+         "onGesture - myo: 0x0 timestamp: 1100000 *gesture: hold\n"
+         "onPeriodic - myo: 0x0\n"
+         "onPeriodic - myo: 0x0\n");
+}
+
+void testReplayer() {
+  const uint64_t ms = 1000;
+  std::vector<replay::Record> records;
+  records.push_back(replay::Record::pose(0, 0, myo::Pose::fist));
+  records.push_back(replay::Record::lock(0, 20 * ms));
+  records.push_back(replay::Record::pose(0, 100 * ms, myo::Pose::rest));
+  records.push_back(replay::Record::rssi(0, 120 * ms, 42));
+  records.push_back(replay::Record::lock(0, 1200 * ms));
+
+  features::RootFeature root_feature;
+  features::filters::Debounce debounce(root_feature, 10,
+                                       root_feature.deviceClock());
+  features::gestures::PoseGestures pose_gestures(
+      debounce, 1000, 750, root_feature.deviceClock());
+  std::string str;
+  PrintEvents print_events(pose_gestures, str);
+  replay::Replayer<> replayer(root_feature, 50);
+  replay::ReplayStats stats = replayer.play(records);
+
+  // onPeriodic is called every 50ms up to and including the call which
+  // follows the last record.
+  assert(stats.events == 5);
+  assert(stats.periodic_calls == 25);
+  assert(stats.recorded_us == 1200 * ms);
+  assert(root_feature.deviceClock().now() == 1250 * ms);
+  // Poses are debounced on the first onPeriodic call after them, and rest is
+  // held for 1000ms by the call at 1200ms.
+  std::string expected =
+      "onLock - myo: 0x0 timestamp: 20000\n"
+      "onPose - myo: 0x0 timestamp: 0 *pose: fist\n"
+      "onPeriodic - myo: 0x0\n"
+      "onPeriodic - myo: 0x0\n"
+      "onRssi - myo: 0x0 timestamp: 120000 rssi: 42\n"
+      "onGesture - myo: 0x0 timestamp: 100000 *gesture: singleClick\n"
+      "onPose - myo: 0x0 timestamp: 100000 *pose: rest\n";
+  for (int i = 0; i < 21; ++i) {
+    expected += "onPeriodic - myo: 0x0\n";
+  }
+  expected +=
+      "onGesture - myo: 0x0 timestamp: 1100000 *gesture: hold\n"
+      "onPeriodic - myo: 0x0\n"
+      "onLock - myo: 0x0 timestamp: 1200000\n"
+      "onPeriodic - myo: 0x0\n";
+  assert(str == expected);
+}
+
+void testSessionFile() {
+  char path[] = "/tmp/myo-intelligesture-session-XXXXXX";
+  close(mkstemp(path));
+
+  std::string recorded_str;
+  {
+    features::RootFeature root_feature;
+    features::SessionRecorder recorder(root_feature, path);
+    PrintEvents print_events(recorder, recorded_str);
+    int8_t emg[] = {0, 1, 2, 3, 4, 5, 6, -7};
+    uint64_t timestamp = 0;
+    root_feature.onPair(nullptr, timestamp++, myo::FirmwareVersion{0, 1, 2, 3});
+    root_feature.onConnect(nullptr, timestamp++,
+                           myo::FirmwareVersion{0, 1, 2, 3});
+    root_feature.onArmSync(nullptr, timestamp++, myo::armLeft,
+                           myo::xDirectionTowardWrist);
+    root_feature.onUnlock(nullptr, timestamp++);
+    root_feature.onPose(nullptr, timestamp++, myo::Pose::fingersSpread);
+    root_feature.onOrientationData(nullptr, timestamp++,
+                                   myo::Quaternion<float>(0.f, 1.f, 2.f, 3.f));
+    root_feature.onAccelerometerData(nullptr, timestamp++,
+                                     myo::Vector3<float>(0.f, 1.f, 2.f));
+    root_feature.onGyroscopeData(nullptr, timestamp++,
+                                 myo::Vector3<float>(0.f, 1.f, 2.f));
+    root_feature.onRssi(nullptr, timestamp++, -42);
+    root_feature.onEmgData(nullptr, timestamp++, emg);
+    root_feature.onLock(nullptr, timestamp++);
+    root_feature.onArmUnsync(nullptr, timestamp++);
+    root_feature.onDisconnect(nullptr, timestamp++);
+    root_feature.onUnpair(nullptr, timestamp++);
+  }
+
+  replay::SessionReader session(path);
+  assert(session.size() == 14);
+  features::RootFeature root_feature;
+  features::Blocker blocker(root_feature, features::Blocker::Periodic);
+  std::string replayed_str;
+  PrintEvents print_events(blocker, replayed_str);
+  replay::Replayer<> replayer(root_feature);
+  replayer.play(session);
+  std::remove(path);
+
+  assert(!recorded_str.empty());
+  assert(replayed_str == recorded_str);
+
+#ifdef __linux__
+  // Every write to /dev/full fails as if the disk were full. The events are
+  // still passed on.
+  features::RootFeature full_root;
+  features::SessionRecorder full_recorder(full_root, "/dev/full");
+  assert(full_recorder.good());
+  std::string full_str;
+  PrintEvents full_print_events(full_recorder, full_str);
+  full_root.onRssi(nullptr, 0, -42);
+  full_recorder.flush();
+  assert(!full_recorder.good());
+  assert(!full_str.empty());
+  full_root.onRssi(nullptr, 1, -42);
+  full_recorder.flush();
+  assert(!full_recorder.good());
+#endif
+}
+
+void testLatencyTracer() {
+  class ManualClock : public core::Clock {
+   public:
+    virtual uint64_t now() const override { return time; }
+    uint64_t time = 0;
+  };
+  ManualClock host_clock;
+
+  features::RootFeature root_feature;
+  features::gestures::PoseGestures pose_gestures(
+      root_feature, 1000, 750, root_feature.deviceClock());
+  features::LatencyTracer tracer(pose_gestures, root_feature.deviceClock(),
+                                 host_clock);
+  uint64_t ms = 1000;
+  // The Myo's clock is 1ms behind the host's.
+  host_clock.time = 1 * ms;
+  root_feature.onPose(nullptr, 0, myo::Pose::fist);
+  // The hold is detected 300ms after the pose became a hold, because nothing
+  // arrived from the Myo in between.
+  host_clock.time = 1300 * ms;
+  root_feature.onLock(nullptr, 1200 * ms);
+  root_feature.onPeriodic(nullptr);
+  host_clock.time = 1401 * ms;
+  root_feature.onPose(nullptr, 1400 * ms, myo::Pose::rest);
+  // A hold of another pose is a series of its own. Rest is held for too long
+  // to be a click.
+  host_clock.time = 2501 * ms;
+  root_feature.onPose(nullptr, 2500 * ms, myo::Pose::fingersSpread);
+  host_clock.time = 3601 * ms;
+  root_feature.onLock(nullptr, 3600 * ms);
+  root_feature.onPeriodic(nullptr);
+  host_clock.time = 3701 * ms;
+  root_feature.onPose(nullptr, 3700 * ms, myo::Pose::rest);
+
+  std::vector<features::LatencyTracer::LatencySummary> poses =
+      tracer.poseLatencies();
+  assert(poses.size() == 3);
+  assert(poses[0].name == "fingersSpread" && poses[0].count == 1);
+  assert(poses[1].name == "fist" && poses[1].count == 1);
+  assert(poses[1].max_us == 0);
+  assert(poses[2].name == "rest" && poses[2].count == 2);
+  assert(poses[2].max_us == 0);
+  std::vector<features::LatencyTracer::LatencySummary> gestures =
+      tracer.gestureLatencies();
+  assert(gestures.size() == 2);
+  assert(gestures[0].name == "hold: fingersSpread");
+  assert(gestures[0].p50_us == 100 * ms && gestures[0].max_us == 100 * ms);
+  assert(gestures[1].name == "hold: fist");
+  assert(gestures[1].p50_us == 299 * ms && gestures[1].max_us == 299 * ms);
+
+  std::ostringstream out;
+  tracer.writeReport(out);
+  assert(out.str() ==
+         "pose fingersSpread count=1 p50_us=0 p99_us=0 max_us=0\n"
+         "pose fist count=1 p50_us=0 p99_us=0 max_us=0\n"
+         "pose rest count=2 p50_us=0 p99_us=0 max_us=0\n"
+         "gesture hold: fingersSpread count=1 p50_us=100000 p99_us=100000 "
+         "max_us=100000\n"
+         "gesture hold: fist count=1 p50_us=299000 p99_us=299000 "
+         "max_us=299000\n");
+
+  // The percentiles of a series are upper bounds within a factor of two.
+  core::LatencyHistogram histogram;
+  for (uint64_t latency : {0, 1, 3, 1000}) {
+    histogram.add(latency);
+  }
+  assert(histogram.count() == 4);
+  assert(histogram.bucket(0) == 2);
+  assert(histogram.bucket(1) == 1);
+  assert(histogram.bucket(9) == 1);
+  assert(histogram.percentile(0.5) == 1);
+  assert(histogram.percentile(0.75) == 3);
+  assert(histogram.percentile(1) == 1023);
+}
+
+void testSpscRing() {
+  core::SpscRing<int> ring(3);
+  assert(ring.capacity() == 4);
+  int item = -1;
+  assert(!ring.tryPop(item) && item == -1);
+  for (int i = 0; i < 4; ++i) {
+    assert(ring.tryPush(i));
+  }
+  assert(!ring.tryPush(4));
+  assert(ring.size() == 4);
+  // Wrap around the end of the ring.
+  for (int i = 0; i < 10; ++i) {
+    assert(ring.tryPop(item) && item == i);
+    assert(ring.tryPush(i + 4));
+  }
+  assert(ring.size() == 4);
+
+  // One producer thread and one consumer thread.
+  core::SpscRing<int> shared_ring(64);
+  const int count = 100000;
+  std::thread producer([&shared_ring, count] {
+    for (int i = 0; i < count; ++i) {
+      while (!shared_ring.tryPush(i)) {
+        std::this_thread::yield();
+      }
+    }
+  });
+  for (int i = 0; i < count; ++i) {
+    while (!shared_ring.tryPop(item)) {
+      std::this_thread::yield();
+    }
+    assert(item == i);
+  }
+  producer.join();
+  assert(shared_ring.empty());
+}
+
+void testQueuedRootFeature() {
+  typedef features::QueuedRootFeature<> QueuedRootFeature;
+  int8_t emg[] = {0, 1, 2, 3, 4, 5, 6, -7};
+  auto send = [&emg](myo::DeviceListener& listener) {
+    uint64_t timestamp = 0;
+    listener.onPair(nullptr, timestamp++, myo::FirmwareVersion{0, 1, 2, 3});
+    listener.onArmSync(nullptr, timestamp++, myo::armLeft,
+                       myo::xDirectionTowardWrist);
+    listener.onUnlock(nullptr, timestamp++);
+    for (int i = 0; i < 50; ++i) {
+      listener.onPose(nullptr, timestamp++,
+                      i % 2 ? myo::Pose::fist : myo::Pose::rest);
+      listener.onOrientationData(nullptr, timestamp++,
+                                 myo::Quaternion<float>(0.f, 1.f, 2.f, 3.f));
+      listener.onEmgData(nullptr, timestamp++, emg);
+    }
+    listener.onLock(nullptr, timestamp++);
+  };
+
+  // Blocking on overflow passes on every event, in order, even through a ring
+  // which is much smaller than the number of events.
+  std::string expected;
+  {
+    features::RootFeature root_feature;
+    PrintEvents print_events(root_feature, expected);
+    send(root_feature);
+    root_feature.onPeriodic(nullptr);
+  }
+  std::string str;
+  {
+    features::RootFeature root_feature;
+    PrintEvents print_events(root_feature, str);
+    QueuedRootFeature queued_root_feature(
+        root_feature, 4, QueuedRootFeature::OverflowPolicy::block);
+    send(queued_root_feature);
+    queued_root_feature.onPeriodic(nullptr);
+    queued_root_feature.stop();
+    QueuedRootFeature::QueueStats stats = queued_root_feature.stats();
+    assert(stats.pushed == 155 && stats.dispatched == 155);
+    assert(stats.dropped == 0);
+    assert(stats.high_water_mark <= 4);
+  }
+  assert(str == expected);
+
+  // Hold the worker thread in the feature tree while the ring fills up.
+  class Gate : public core::DeviceListenerWrapper {
+   public:
+    Gate(core::DeviceListenerWrapper& parent_feature)
+        : entered(false), open(false) {
+      parent_feature.addChildFeature(this);
+    }
+    virtual void onUnlock(myo::Myo*, uint64_t) override {
+      entered = true;
+      while (!open) {
+        std::this_thread::yield();
+      }
+    }
+    std::atomic<bool> entered, open;
+  };
+  features::RootFeature root_feature;
+  Gate gate(root_feature);
+  QueuedRootFeature queued_root_feature(
+      root_feature, 4, QueuedRootFeature::OverflowPolicy::dropSamples);
+  queued_root_feature.onUnlock(nullptr, 0);
+  while (!gate.entered) {
+    std::this_thread::yield();
+  }
+  for (int i = 0; i < 6; ++i) {
+    queued_root_feature.onEmgData(nullptr, 1, emg);
+  }
+  QueuedRootFeature::QueueStats stats = queued_root_feature.stats();
+  assert(stats.pushed == 5 && stats.dropped == 2 && stats.blocked == 0);
+  // Other events wait for space instead.
+  std::thread opener([&gate] {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    gate.open = true;
+  });
+  queued_root_feature.onLock(nullptr, 2);
+  opener.join();
+  queued_root_feature.stop();
+  stats = queued_root_feature.stats();
+  assert(stats.pushed == 6 && stats.dispatched == 6);
+  assert(stats.dropped == 2 && stats.blocked == 1);
+}
+
+void testPerMyo() {
+  struct Tree {
+    Tree()
+        : pose_gestures(root_feature, 1000, 750, root_feature.deviceClock()),
+          print_events(pose_gestures, str) {}
+    features::RootFeature& root() { return root_feature; }
+
+    features::RootFeature root_feature;
+    features::gestures::PoseGestures pose_gestures;
+    std::string str;
+    PrintEvents print_events;
+  };
+  features::PerMyo<Tree> per_myo(
+      [](myo::Myo*) { return std::make_unique<Tree>(); });
+  myo::Myo* first = reinterpret_cast<myo::Myo*>(0x10);
+  myo::Myo* second = reinterpret_cast<myo::Myo*>(0x20);
+  uint64_t ms = 1000;
+  // If both Myos shared one PoseGestures, the second Myo's pose would turn the
+  // first Myo's click into a click of waveIn.
+  per_myo.onPose(first, 0, myo::Pose::fist);
+  per_myo.onPose(second, 50 * ms, myo::Pose::waveIn);
+  per_myo.onPose(first, 100 * ms, myo::Pose::rest);
+  per_myo.onPeriodic();
+  per_myo.stop();
+
+  assert(per_myo.size() == 2);
+  assert(per_myo.myoAt(0) == first && per_myo.myoAt(1) == second);
+  const std::string& first_str = per_myo.tree(0).str;
+  const std::string& second_str = per_myo.tree(1).str;
+  assert(first_str.find("*gesture: singleClick") != std::string::npos);
+  assert(first_str.find("*pose: waveIn") == std::string::npos);
+  assert(first_str.find("myo: 0x20") == std::string::npos);
+  assert(second_str.find("onGesture") == std::string::npos);
+  assert(second_str.find("*pose: waveIn") != std::string::npos);
+  assert(second_str.find("onPeriodic - myo: 0x20\n") != std::string::npos);
+  assert(per_myo.queue(0).stats().dispatched == 3);
+  assert(per_myo.queue(1).stats().dispatched == 2);
+}
+
+void testThreadPool() {
+  std::atomic<int> count(0);
+  {
+    core::ThreadPool pool(4);
+    assert(pool.size() == 4);
+    for (int i = 0; i < 1000; ++i) {
+      pool.submit([&pool, &count] {
+        // Tasks submitted by a task go to its own worker's queue.
+        pool.submit([&count] { ++count; });
+        ++count;
+      });
+    }
+  }
+  assert(count == 2000);
+}
+
+void testParallel() {
+  int8_t emg[] = {0, 1, 2, 3, 4, 5, 6, -7};
+  auto send = [&emg](core::DeviceListenerWrapper& feature) {
+    for (uint64_t timestamp = 0; timestamp < 200; timestamp += 4) {
+      feature.onPose(nullptr, timestamp,
+                     core::Pose::interned(timestamp % 8 ? core::Pose::fist
+                                                        : core::Pose::rest));
+      feature.onOrientationData(nullptr, timestamp + 1,
+                                myo::Quaternion<float>(0.f, 1.f, 2.f, 3.f));
+      feature.onEmgData(nullptr, timestamp + 2, emg);
+      feature.onLock(nullptr, timestamp + 3);
+      feature.onPeriodic(nullptr);
+    }
+  };
+  std::string expected;
+  {
+    core::DeviceListenerWrapper root;
+    PrintEvents print_events(root, expected);
+    send(root);
+  }
+
+  core::ThreadPool pool(4);
+  {
+    // Every child receives every event in order.
+    core::DeviceListenerWrapper root;
+    features::Parallel parallel(root, pool);
+    std::string first_str, second_str;
+    PrintEvents first(parallel, first_str), second(parallel, second_str);
+    send(root);
+    parallel.wait();
+    assert(first_str == expected);
+    assert(second_str == expected);
+  }
+  {
+    // Children which share state run one at a time, so they may write to the
+    // same string. Each event is passed to both before the next.
+    core::DeviceListenerWrapper root;
+    features::Parallel parallel(root, pool);
+    std::string str;
+    PrintEvents first(parallel, str), second(parallel, str);
+    parallel.shareState(&first, &second);
+    send(root);
+    parallel.wait();
+    std::string doubled;
+    std::istringstream lines(expected);
+    for (std::string line; std::getline(lines, line);) {
+      doubled += line + "\n" + line + "\n";
+    }
+    assert(str == doubled);
+  }
+  {
+    // Siblings run concurrently: each one waits for the other to start.
+    class Rendezvous : public core::DeviceListenerWrapper {
+     public:
+      Rendezvous(core::DeviceListenerWrapper& parent_feature,
+                 std::atomic<int>& arrived)
+          : arrived_(arrived), met(false) {
+        parent_feature.addChildFeature(this);
+      }
+      virtual void onLock(myo::Myo*, uint64_t) override {
+        ++arrived_;
+        auto deadline =
+            std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (arrived_ < 2 && std::chrono::steady_clock::now() < deadline) {
+          std::this_thread::yield();
+        }
+        met = arrived_ == 2;
+      }
+      std::atomic<int>& arrived_;
+      bool met;
+    };
+    core::DeviceListenerWrapper root;
+    features::Parallel parallel(root, pool);
+    std::atomic<int> arrived(0);
+    Rendezvous first(parallel, arrived), second(parallel, arrived);
+    root.onLock(nullptr, 0);
+    parallel.wait();
+    assert(first.met && second.met);
+  }
+  {
+    // A batch reaches each child whole, with the same samples as one at a
+    // time.
+    const std::size_t kSize = 10;
+    class BatchCalls : public core::DeviceListenerWrapper {
+     public:
+      BatchCalls(core::DeviceListenerWrapper& parent_feature) : calls(0) {
+        parent_feature.addChildFeature(this);
+      }
+      virtual void onOrientationDataBatch(
+          myo::Myo*, const core::OrientationBatch& batch) override {
+        calls += batch.size == kSize;
+      }
+      virtual void onAccelerometerDataBatch(
+          myo::Myo*, const core::VectorBatch& batch) override {
+        calls += batch.size == kSize;
+      }
+      virtual void onGyroscopeDataBatch(
+          myo::Myo*, const core::VectorBatch& batch) override {
+        calls += batch.size == kSize;
+      }
+      virtual void onEmgDataBatch(myo::Myo*,
+                                  const core::EmgBatch& batch) override {
+        calls += batch.size == kSize;
+      }
+      int calls;
+    };
+    uint64_t timestamps[kSize];
+    myo::Quaternion<float> rotations[kSize];
+    myo::Vector3<float> vectors[kSize];
+    core::EmgSample emg_samples[kSize];
+    for (std::size_t i = 0; i < kSize; ++i) {
+      timestamps[i] = i;
+      rotations[i] = myo::Quaternion<float>(0.f, 0.f, 0.f, 1.f);
+      vectors[i] = myo::Vector3<float>(i, 2.f * i, 3.f * i);
+      emg_samples[i].fill(static_cast<int8_t>(i));
+    }
+    auto send_batches = [&](core::DeviceListenerWrapper& feature) {
+      feature.onOrientationDataBatch(
+          nullptr, core::OrientationBatch(timestamps, rotations, kSize));
+      feature.onAccelerometerDataBatch(
+          nullptr, core::VectorBatch(timestamps, vectors, kSize));
+      feature.onGyroscopeDataBatch(
+          nullptr, core::VectorBatch(timestamps, vectors, kSize));
+      feature.onEmgDataBatch(nullptr,
+                             core::EmgBatch(timestamps, emg_samples, kSize));
+    };
+    std::string expected_batches;
+    {
+      core::DeviceListenerWrapper root;
+      PrintEvents print_events(root, expected_batches);
+      send_batches(print_events);
+    }
+    core::DeviceListenerWrapper root;
+    features::Parallel parallel(root, pool);
+    std::string str;
+    PrintEvents print_events(parallel, str);
+    BatchCalls batch_calls(parallel);
+    send_batches(parallel);
+    parallel.wait();
+    assert(!expected_batches.empty());
+    assert(str == expected_batches);
+    assert(batch_calls.calls == 4);
+  }
+}
+
+void testSampleBatch() {
+  using features::CorrectForOrientation;
+  using features::filters::MovingAverage;
+  using features::filters::ExponentialMovingAverage;
+  auto correct_flags = CorrectForOrientation::AccelerometerData |
+                       CorrectForOrientation::GyroscopeData;
+  auto average_flags = MovingAverage::OrientationData |
+                       MovingAverage::AccelerometerData |
+                       MovingAverage::GyroscopeData;
+  auto exponential_flags = ExponentialMovingAverage::OrientationData |
+                           ExponentialMovingAverage::AccelerometerData |
+                           ExponentialMovingAverage::GyroscopeData;
+
+  const std::size_t kSize = 10;
+  uint64_t timestamps[kSize];
+  myo::Quaternion<float> rotations[kSize];
+  myo::Vector3<float> vectors[kSize];
+  core::EmgSample emg[kSize];
+  for (std::size_t i = 0; i < kSize; ++i) {
+    timestamps[i] = i;
+    rotations[i] = myo::Quaternion<float>(0.1f * i, 0.f, 0.f, 1.f);
+    vectors[i] = myo::Vector3<float>(i, 2.f * i, i % 3);
+    emg[i].fill(static_cast<int8_t>(i));
+  }
+  auto send_samples = [&](auto& root) {
+    for (std::size_t i = 0; i < kSize; ++i) {
+      root.onOrientationData(nullptr, timestamps[i], rotations[i]);
+    }
+    for (std::size_t i = 0; i < kSize; ++i) {
+      root.onAccelerometerData(nullptr, timestamps[i], vectors[i]);
+    }
+    for (std::size_t i = 0; i < kSize; ++i) {
+      root.onGyroscopeData(nullptr, timestamps[i], vectors[i]);
+    }
+    for (std::size_t i = 0; i < kSize; ++i) {
+      root.onEmgData(nullptr, timestamps[i], emg[i].data());
+    }
+  };
+  // Split into batches of uneven sizes.
+  auto send_batches = [&](auto& root) {
+    for (std::size_t begin = 0; begin < kSize; begin += 4) {
+      std::size_t size = std::min<std::size_t>(4, kSize - begin);
+      root.onOrientationDataBatch(
+          nullptr, core::OrientationBatch(timestamps + begin,
+                                          rotations + begin, size));
+    }
+    for (std::size_t begin = 0; begin < kSize; begin += 4) {
+      std::size_t size = std::min<std::size_t>(4, kSize - begin);
+      root.onAccelerometerDataBatch(
+          nullptr,
+          core::VectorBatch(timestamps + begin, vectors + begin, size));
+    }
+    root.onGyroscopeDataBatch(nullptr,
+                              core::VectorBatch(timestamps, vectors, kSize));
+    root.onEmgDataBatch(nullptr, core::EmgBatch(timestamps, emg, kSize));
+  };
+
+  // Batches must produce exactly the same events as single samples, through
+  // both dynamic and static dispatch.
+  std::string expected;
+  {
+    features::RootFeature root_feature;
+    CorrectForOrientation correct(root_feature, correct_flags);
+    MovingAverage moving_average(correct, average_flags, 3);
+    ExponentialMovingAverage exponential_moving_average(
+        moving_average, exponential_flags, 0.5f);
+    PrintEvents print_events(exponential_moving_average, expected);
+    send_samples(root_feature);
+  }
+  std::string dynamic_str;
+  {
+    features::RootFeature root_feature;
+    CorrectForOrientation correct(root_feature, correct_flags);
+    MovingAverage moving_average(correct, average_flags, 3);
+    ExponentialMovingAverage exponential_moving_average(
+        moving_average, exponential_flags, 0.5f);
+    PrintEvents print_events(exponential_moving_average, dynamic_str);
+    send_batches(root_feature);
+    assert(root_feature.deviceClock().now() == kSize - 1);
+  }
+  std::string static_str;
+  {
+    core::Pipeline<features::BasicRootFeature,
+                   features::BasicCorrectForOrientation,
+                   features::filters::BasicMovingAverage,
+                   features::filters::BasicExponentialMovingAverage>
+        pipeline(std::make_tuple(), std::make_tuple(correct_flags),
+                 std::make_tuple(average_flags, 3),
+                 std::make_tuple(exponential_flags, 0.5f));
+    PrintEvents print_events(pipeline.leaf(), static_str);
+    send_batches(pipeline.root());
+  }
+  assert(!expected.empty());
+  assert(dynamic_str == expected);
+  assert(static_str == expected);
+
+  // By default QueuedRootFeature keeps the order in which the samples arrived,
+  // so a tree which combines streams gives the same events as when fed
+  // directly. With BatchPolicy::perStream, it collects each stream of samples
+  // into its own batch, so the interleaved orientation, accelerometer and
+  // gyroscope samples of the Myo still form batches. Every stream keeps its
+  // events and their order.
+  auto send_mixed = [&](myo::DeviceListener& listener) {
+    listener.onUnlock(nullptr, 0);
+    for (std::size_t i = 0; i < kSize; ++i) {
+      listener.onEmgData(nullptr, timestamps[i], emg[i].data());
+    }
+    listener.onPose(nullptr, kSize, myo::Pose::fist);
+    for (std::size_t i = 0; i < kSize; ++i) {
+      listener.onOrientationData(nullptr, timestamps[i], rotations[i]);
+      listener.onAccelerometerData(nullptr, timestamps[i], vectors[i]);
+      listener.onGyroscopeData(nullptr, timestamps[i], vectors[i]);
+    }
+  };
+  // Holds the worker thread until every event is in the ring, so that the
+  // batches do not depend on the timing of the threads.
+  class Gate : public core::DeviceListenerWrapper {
+   public:
+    Gate(core::DeviceListenerWrapper& parent_feature) : open(false) {
+      parent_feature.addChildFeature(this);
+    }
+    virtual void onUnlock(myo::Myo*, uint64_t) override {
+      while (!open) {
+        std::this_thread::yield();
+      }
+    }
+    std::atomic<bool> open;
+  };
+  // Records the size of the largest batch of each type.
+  class BatchSizes : public core::DeviceListenerWrapper {
+   public:
+    BatchSizes(core::DeviceListenerWrapper& parent_feature)
+        : orientation(0), accelerometer(0), gyroscope(0), emg(0) {
+      parent_feature.addChildFeature(this);
+    }
+    virtual void onOrientationDataBatch(
+        myo::Myo*, const core::OrientationBatch& batch) override {
+      orientation = std::max(orientation, batch.size);
+    }
+    virtual void onAccelerometerDataBatch(
+        myo::Myo*, const core::VectorBatch& batch) override {
+      accelerometer = std::max(accelerometer, batch.size);
+    }
+    virtual void onGyroscopeDataBatch(myo::Myo*,
+                                      const core::VectorBatch& batch) override {
+      gyroscope = std::max(gyroscope, batch.size);
+    }
+    virtual void onEmgDataBatch(myo::Myo*,
+                                const core::EmgBatch& batch) override {
+      emg = std::max(emg, batch.size);
+    }
+    std::size_t orientation, accelerometer, gyroscope, emg;
+  };
+  // The lines of one type of event.
+  auto lines_of = [](const std::string& str, const std::string& event) {
+    std::istringstream in(str);
+    std::string line, lines;
+    while (std::getline(in, line)) {
+      if (line.compare(0, event.size() + 2, event + " -") == 0) {
+        lines += line + "\n";
+      }
+    }
+    return lines;
+  };
+  std::string direct_correct_str;
+  {
+    features::RootFeature root_feature;
+    CorrectForOrientation correct(root_feature, correct_flags);
+    PrintEvents print_events(correct, direct_correct_str);
+    send_mixed(root_feature);
+  }
+  std::string queued_correct_str;
+  {
+    features::RootFeature root_feature;
+    Gate gate(root_feature);
+    BatchSizes batch_sizes(root_feature);
+    CorrectForOrientation correct(root_feature, correct_flags);
+    PrintEvents print_events(correct, queued_correct_str);
+    features::QueuedRootFeature<> queued_root_feature(root_feature);
+    send_mixed(queued_root_feature);
+    gate.open = true;
+    queued_root_feature.stop();
+    assert(batch_sizes.orientation == 1);
+    assert(batch_sizes.emg == kSize);
+  }
+  assert(!direct_correct_str.empty());
+  assert(queued_correct_str == direct_correct_str);
+
+  std::string direct_str;
+  {
+    features::RootFeature root_feature;
+    MovingAverage moving_average(root_feature, average_flags, 3);
+    PrintEvents print_events(moving_average, direct_str);
+    send_mixed(root_feature);
+  }
+  std::string queued_str;
+  {
+    features::RootFeature root_feature;
+    Gate gate(root_feature);
+    BatchSizes batch_sizes(root_feature);
+    MovingAverage moving_average(root_feature, average_flags, 3);
+    PrintEvents print_events(moving_average, queued_str);
+    typedef features::QueuedRootFeature<> QueuedRootFeature;
+    QueuedRootFeature queued_root_feature(
+        root_feature, 4096, QueuedRootFeature::OverflowPolicy::dropSamples,
+        QueuedRootFeature::BatchPolicy::perStream);
+    send_mixed(queued_root_feature);
+    gate.open = true;
+    queued_root_feature.stop();
+    assert(batch_sizes.orientation == kSize);
+    assert(batch_sizes.accelerometer == kSize);
+    assert(batch_sizes.gyroscope == kSize);
+    assert(batch_sizes.emg == kSize);
+  }
+  for (const char* event :
+       {"onUnlock", "onEmgData", "onPose", "onOrientationData",
+        "onAccelerometerData", "onGyroscopeData"}) {
+    assert(!lines_of(direct_str, event).empty());
+    assert(lines_of(queued_str, event) == lines_of(direct_str, event));
+  }
+  // The pose still follows the EMG samples sent before it.
+  assert(queued_str.rfind("onEmgData -") < queued_str.find("onPose -"));
+}
+
+void testInfiniteImpulseResponseBank() {
+  using features::filters::ExponentialMovingAverageKernel;
+  using features::filters::InfiniteImpulseResponseBank;
+  const std::size_t kGroups = 5;
+  const float alpha = 0.3f;
+  InfiniteImpulseResponseBank<ExponentialMovingAverageKernel> bank(
+      ExponentialMovingAverageKernel(alpha), kGroups);
+  InfiniteImpulseResponseBank<ExponentialMovingAverageKernel,
+                              core::ScalarFloat4>
+      scalar_bank(ExponentialMovingAverageKernel(alpha), kGroups);
+
+  // Every lane must match the scalar formula of ExponentialMovingAverage
+  // exactly, whichever implementation of the lanes is used.
+  float input[4 * kGroups], output[4 * kGroups], scalar_output[4 * kGroups];
+  float expected[4 * kGroups];
+  for (int step = 0; step < 100; ++step) {
+    for (std::size_t i = 0; i < 4 * kGroups; ++i) {
+      input[i] = std::sin(0.37f * step + i) * (i + 1);
+      if (step == 0) {
+        expected[i] = input[i];
+      } else {
+        expected[i] = (alpha * input[i]) + ((1 - alpha) * expected[i]);
+      }
+    }
+    bank.update(input, output);
+    scalar_bank.update(input, scalar_output);
+    for (std::size_t i = 0; i < 4 * kGroups; ++i) {
+      assert(output[i] == expected[i]);
+      assert(scalar_output[i] == expected[i]);
+    }
+  }
+
+  // A reset bank starts again from its next sample.
+  bank.reset();
+  bank.update(input, output);
+  for (std::size_t i = 0; i < 4 * kGroups; ++i) {
+    assert(output[i] == input[i]);
+  }
+}
+
+void testConvolution() {
+  using features::filters::Convolution;
+  std::string expected =
+      "onAccelerometerData - myo: 0x0 timestamp: 0 accel: (0, 0, 0)\n"
+      "onGyroscopeData - myo: 0x0 timestamp: 0 gyro: (0, 0, 0)\n"
+      "onAccelerometerData - myo: 0x0 timestamp: 1 accel: (1, 0.5, 0)\n"
+      "onGyroscopeData - myo: 0x0 timestamp: 1 gyro: (100, 50, 0)\n"
+      "onAccelerometerData - myo: 0x0 timestamp: 2 accel: (4, 2, 0)\n"
+      "onGyroscopeData - myo: 0x0 timestamp: 2 gyro: (200, 100, 0)\n"
+      "onAccelerometerData - myo: 0x0 timestamp: 3 accel: (8, 4, 0)\n"
+      "onGyroscopeData - myo: 0x0 timestamp: 3 gyro: (200, 100, 0)\n"
+      "onAccelerometerData - myo: 0x0 timestamp: 4 accel: (12, 6, 0)\n"
+      "onGyroscopeData - myo: 0x0 timestamp: 4 gyro: (200, 100, 0)\n";
+
+  features::RootFeature root_feature;
+  Convolution smooth(root_feature, Convolution::AccelerometerData,
+                     {0.25f, 0.5f, 0.25f});
+  Convolution differentiate(smooth, Convolution::GyroscopeData,
+                            features::filters::taps::differentiator(50));
+  std::string str;
+  PrintEvents print_events(differentiate, str);
+  for (uint64_t timestamp = 0; timestamp < 5; ++timestamp) {
+    float x = 4.f * timestamp;
+    root_feature.onAccelerometerData(nullptr, timestamp,
+                                     myo::Vector3<float>(x, x / 2, 0));
+    root_feature.onGyroscopeData(nullptr, timestamp,
+                                 myo::Vector3<float>(x, x / 2, 0));
+  }
+  assert(str == expected);
+
+  // The designed filters pass or block a constant signal.
+  auto gain_at_0_hz = [](const std::vector<float>& taps) {
+    float sum = 0;
+    for (float tap : taps) {
+      sum += tap;
+    }
+    return sum;
+  };
+  using namespace features::filters::taps;
+  assert(std::abs(gain_at_0_hz(lowPass(5, 50, 15)) - 1) < 1e-6f);
+  assert(std::abs(gain_at_0_hz(highPass(5, 50, 15))) < 1e-6f);
+  assert(std::abs(gain_at_0_hz(bandPass(2, 10, 50, 15))) < 1e-6f);
+}
+
+void testEmgFilter() {
+  using features::filters::EmgFilter;
+  using features::filters::EmgFilterChannel;
+  // The offset of the first sample is removed, and a step away from it passes
+  // through, less the DC average moving towards it. The envelope moves a
+  // sixteenth of the way to the rectified step, in 1/32 units.
+  std::string expected =
+      "onEmgData - myo: 0x0 timestamp: 0 emg: (0, 0, 0, 0, 0, 0, 0, 0)\n"
+      "onEmgEnvelope - myo: 0x0 timestamp: 0 envelope: "
+      "(0, 0, 0, 0, 0, 0, 0, 0)\n"
+      "onEmgData - myo: 0x0 timestamp: 1 emg: (0, -19, 0, 0, 0, 0, 0, 0)\n"
+      "onEmgEnvelope - myo: 0x0 timestamp: 1 envelope: "
+      "(0, 39, 0, 0, 0, 0, 0, 0)\n";
+
+  features::RootFeature root_feature;
+  EmgFilter emg_filter(root_feature);
+  std::string str;
+  PrintEvents print_events(emg_filter, str);
+  for (uint64_t timestamp = 0; timestamp < 2; ++timestamp) {
+    int8_t emg[8] = {10, int8_t(timestamp % 2 ? -10 : 10), 0, 0, 0, 0, 0, 0};
+    root_feature.onEmgData(nullptr, timestamp, emg);
+  }
+  assert(str == expected);
+
+  // A batch gives the same events in the same order as its samples: each
+  // filtered sample followed by its envelope.
+  const std::size_t kSize = 6;
+  uint64_t timestamps[kSize];
+  core::EmgSample samples[kSize];
+  for (std::size_t i = 0; i < kSize; ++i) {
+    timestamps[i] = i;
+    samples[i].fill(int8_t(i % 2 ? -20 : 30));
+  }
+  std::string sample_str;
+  {
+    features::RootFeature root_feature;
+    EmgFilter emg_filter(root_feature);
+    PrintEvents print_events(emg_filter, sample_str);
+    for (std::size_t i = 0; i < kSize; ++i) {
+      root_feature.onEmgData(nullptr, timestamps[i], samples[i].data());
+    }
+  }
+  std::string batch_str;
+  {
+    features::RootFeature root_feature;
+    EmgFilter emg_filter(root_feature);
+    PrintEvents print_events(emg_filter, batch_str);
+    root_feature.onEmgDataBatch(nullptr,
+                                core::EmgBatch(timestamps, samples, kSize));
+  }
+  assert(!sample_str.empty());
+  assert(batch_str == sample_str);
+
+  // Every lane must match the scalar lanes exactly, and a 50 Hz hum is removed
+  // by a notch at 50 Hz.
+  EmgFilterChannel<> channel(EmgFilter::notch(50, 2), 5, 4);
+  EmgFilterChannel<core::ScalarInt16x8> scalar_channel(
+      EmgFilter::notch(50, 2), 5, 4);
+  const int8_t hum[4] = {0, 40, 0, -40};
+  for (int step = 0; step < 200; ++step) {
+    int8_t emg[8];
+    for (int i = 0; i < 8; ++i) {
+      emg[i] = int8_t(hum[step % 4] + 10 * i - 40);
+    }
+    int8_t filtered[8], scalar_filtered[8];
+    int16_t envelope[8], scalar_envelope[8];
+    channel.update(emg, filtered, envelope);
+    scalar_channel.update(emg, scalar_filtered, scalar_envelope);
+    for (int i = 0; i < 8; ++i) {
+      assert(filtered[i] == scalar_filtered[i]);
+      assert(envelope[i] == scalar_envelope[i]);
+      if (step >= 100) {
+        assert(std::abs(filtered[i]) <= 1);
+        assert(envelope[i] < core::kEmgEnvelopeScale);
+      }
+    }
+  }
+
+  // A child which only wants the envelope still needs the EMG data.
+  features::RootFeature envelope_root;
+  EmgFilter envelope_filter(envelope_root);
+  features::Blocker blocker(
+      envelope_filter,
+      static_cast<features::Blocker::EventFlags>(
+          core::AllEvents & ~core::EventBit(core::Event::EmgEnvelope)));
+  PrintEvents envelope_print_events(blocker, str);
+  assert(envelope_root.subscribedEvents() ==
+         (core::EventBit(core::Event::EmgData) |
+          core::EventBit(core::Event::EmgEnvelope)));
+}
+
+void testEmgFeatureExtractor() {
+  // Channel 0 goes 0, 3, -2, -2, 5, 4. Features are sent once the first 4
+  // samples are in the window, and then every 2 samples. Each sample counts
+  // its difference, zero crossing and slope change against the samples before
+  // it, so that the second window counts the crossing from 3 to -2 and the
+  // slope change at 3.
+  std::string expected =
+      "onEmgFeatures - myo: 0x0 timestamp: 3 window_size: 4"
+      " mav: (1.75, 0, 0, 0, 0, 0, 0, 0)"
+      " rms: (2.06155, 0, 0, 0, 0, 0, 0, 0)"
+      " wl: (8, 0, 0, 0, 0, 0, 0, 0) zc: (1, 0, 0, 0, 0, 0, 0, 0)"
+      " ssc: (1, 0, 0, 0, 0, 0, 0, 0)\n"
+      "onEmgFeatures - myo: 0x0 timestamp: 5 window_size: 4"
+      " mav: (3.25, 0, 0, 0, 0, 0, 0, 0)"
+      " rms: (3.5, 0, 0, 0, 0, 0, 0, 0)"
+      " wl: (13, 0, 0, 0, 0, 0, 0, 0) zc: (2, 0, 0, 0, 0, 0, 0, 0)"
+      " ssc: (2, 0, 0, 0, 0, 0, 0, 0)\n";
+
+  features::RootFeature root_feature;
+  features::EmgFeatureExtractor extractor(root_feature, 4, 2);
+  features::Blocker blocker(extractor, features::Blocker::EmgData);
+  std::string str;
+  PrintEvents print_events(blocker, str);
+  const int8_t channel_0[] = {0, 3, -2, -2, 5, 4};
+  for (uint64_t timestamp = 0; timestamp < 6; ++timestamp) {
+    int8_t emg[8] = {channel_0[timestamp], 0, 0, 0, 0, 0, 0, 0};
+    root_feature.onEmgData(nullptr, timestamp, emg);
+  }
+  assert(str == expected);
+
+  // The running features must match the features computed from scratch over
+  // each window.
+  class RecordFeatures : public core::DeviceListenerWrapper {
+   public:
+    explicit RecordFeatures(core::DeviceListenerWrapper& parent_feature) {
+      parent_feature.addChildFeature(this);
+    }
+    virtual void onEmgFeatures(myo::Myo*, uint64_t timestamp,
+                               const core::EmgFeatures& features) override {
+      timestamps.push_back(timestamp);
+      recorded.push_back(features);
+    }
+    std::vector<uint64_t> timestamps;
+    std::vector<core::EmgFeatures> recorded;
+  };
+  const std::size_t kWindow = 16, kHop = 5;
+  const int kThreshold = 10;
+  features::RootFeature random_root;
+  features::EmgFeatureExtractor random_extractor(random_root, kWindow, kHop,
+                                                 kThreshold);
+  RecordFeatures record_features(random_extractor);
+  std::vector<core::EmgSample> samples;
+  for (uint64_t timestamp = 0; timestamp < 200; ++timestamp) {
+    core::EmgSample emg;
+    for (int i = 0; i < 8; ++i) {
+      emg[i] = int8_t(100 * std::sin(0.9 * timestamp * (i + 1)));
+    }
+    samples.push_back(emg);
+    random_root.onEmgData(nullptr, timestamp, emg.data());
+  }
+  assert(record_features.timestamps.size() == (200 - kWindow) / kHop + 1);
+  for (std::size_t n = 0; n < record_features.timestamps.size(); ++n) {
+    const std::size_t last = record_features.timestamps[n];
+    assert(last == kWindow - 1 + n * kHop);
+    const core::EmgFeatures& features = record_features.recorded[n];
+    assert(features.window_size == kWindow);
+    for (int i = 0; i < 8; ++i) {
+      int sum_absolute = 0, sum_squares = 0, length = 0, crossings = 0;
+      int slope_changes = 0;
+      for (std::size_t k = last + 1 - kWindow; k <= last; ++k) {
+        const int x = samples[k][i];
+        sum_absolute += std::abs(x);
+        sum_squares += x * x;
+        if (k >= 1) {
+          const int previous = samples[k - 1][i];
+          length += std::abs(x - previous);
+          crossings += previous * x < 0 && std::abs(x - previous) >= kThreshold;
+        }
+        if (k >= 2) {
+          const int left = samples[k - 1][i] - samples[k - 2][i];
+          const int right = samples[k - 1][i] - x;
+          slope_changes += left * right > 0 && (std::abs(left) >= kThreshold ||
+                                                std::abs(right) >= kThreshold);
+        }
+      }
+      assert(features.mean_absolute_value[i] == sum_absolute / float(kWindow));
+      assert(features.root_mean_square[i] ==
+             std::sqrt(sum_squares / float(kWindow)));
+      assert(features.waveform_length[i] == length);
+      assert(features.zero_crossings[i] == crossings);
+      assert(features.slope_sign_changes[i] == slope_changes);
+    }
+  }
+
+  // With a hop longer than the window, the first features are still sent on
+  // the sample which fills the window.
+  features::RootFeature hop_root;
+  features::EmgFeatureExtractor hop_extractor(hop_root, 2, 3);
+  RecordFeatures hop_features(hop_extractor);
+  for (uint64_t timestamp = 0; timestamp < 8; ++timestamp) {
+    hop_root.onEmgData(nullptr, timestamp, samples[timestamp].data());
+  }
+  assert((hop_features.timestamps == std::vector<uint64_t>{1, 4, 7}));
+}
+
+void testStaticMovingAverage() {
+  using features::filters::MovingAverage;
+  using features::filters::BasicStaticMovingAverage;
+  // The same streams as MovingAverage, one sample at a time and in batches.
+  features::RootFeature root_feature;
+  MovingAverage avg(root_feature, MovingAverage::AccelerometerData |
+                                      MovingAverage::GyroscopeData,
+                    3);
+  BasicStaticMovingAverage<3, MovingAverage::AccelerometerData |
+                                  MovingAverage::GyroscopeData>
+      static_avg(root_feature);
+  std::string str, static_str;
+  PrintEvents print_events(avg, str);
+  PrintEvents static_print_events(static_avg, static_str);
+  uint64_t timestamps[4];
+  myo::Vector3<float> samples[4];
+  myo::Quaternion<float> rotations[4];
+  for (int step = 0; step < 5; ++step) {
+    for (int i = 0; i < 4; ++i) {
+      float x = std::sin(0.7f * (4 * step + i));
+      timestamps[i] = 4 * step + i;
+      samples[i] = myo::Vector3<float>(x, 2 * x, -x);
+      rotations[i] = myo::Quaternion<float>(x, 0, 0, 1);
+      root_feature.onAccelerometerData(nullptr, timestamps[i], samples[i]);
+      root_feature.onGyroscopeData(nullptr, timestamps[i], samples[i]);
+      root_feature.onOrientationData(nullptr, timestamps[i], rotations[i]);
+    }
+    root_feature.onAccelerometerDataBatch(
+        nullptr, core::VectorBatch(timestamps, samples, 4));
+    root_feature.onOrientationDataBatch(
+        nullptr, core::OrientationBatch(timestamps, rotations, 4));
+  }
+  assert(!str.empty());
+  assert(static_str == str);
+
+  // A batch longer than a chunk of the filter is passed on in chunks, with the
+  // same samples as one sample at a time.
+  typedef BasicStaticMovingAverage<3, MovingAverage::AccelerometerData>
+      AccelerometerAverage;
+  const std::size_t kLongSize = 3 * AccelerometerAverage::kChunkSize + 5;
+  uint64_t long_timestamps[kLongSize];
+  myo::Vector3<float> long_samples[kLongSize];
+  for (std::size_t i = 0; i < kLongSize; ++i) {
+    float x = std::sin(0.3f * i);
+    long_timestamps[i] = i;
+    long_samples[i] = myo::Vector3<float>(x, -x, 2 * x);
+  }
+  std::string sample_str, batch_str;
+  {
+    features::RootFeature root_feature;
+    AccelerometerAverage average(root_feature);
+    PrintEvents print_events(average, sample_str);
+    for (std::size_t i = 0; i < kLongSize; ++i) {
+      root_feature.onAccelerometerData(nullptr, long_timestamps[i],
+                                       long_samples[i]);
+    }
+  }
+  {
+    features::RootFeature root_feature;
+    AccelerometerAverage average(root_feature);
+    PrintEvents print_events(average, batch_str);
+    root_feature.onAccelerometerDataBatch(
+        nullptr, core::VectorBatch(long_timestamps, long_samples, kLongSize));
+  }
+  assert(!sample_str.empty());
+  assert(batch_str == sample_str);
+
+  // Streams which are not filtered take no space.
+  typedef BasicStaticMovingAverage<5, MovingAverage::OrientationData>
+      OneStream;
+  typedef BasicStaticMovingAverage<5, MovingAverage::OrientationData |
+                                          MovingAverage::AccelerometerData |
+                                          MovingAverage::GyroscopeData>
+      ThreeStreams;
+  typedef features::filters::StaticFiniteImpulseResponseStream<
+      features::filters::MovingAverageKernel, 5, 0, true>
+      Stream;
+  assert(sizeof(ThreeStreams) == sizeof(OneStream) + 2 * sizeof(Stream));
+  // Nor does the orientation mode unless orientation is filtered as
+  // quaternions.
+  typedef BasicStaticMovingAverage<5, MovingAverage::AccelerometerData>
+      AccelerometerStream;
+  typedef BasicStaticMovingAverage<5, MovingAverage::OrientationData |
+                                          MovingAverage::QuaternionOrientation>
+      QuaternionStream;
+  assert(sizeof(AccelerometerStream) == sizeof(OneStream));
+  assert(sizeof(QuaternionStream) ==
+         sizeof(OneStream) +
+             sizeof(features::filters::OrientationFilterMode));
+}
+
+void testBiquad() {
+  using features::filters::BiquadCascadeChannel;
+  using features::filters::BiquadFilter;
+  namespace butterworth = features::filters::butterworth;
+  // The coefficients are designed at compile time. A second order low-pass at
+  // a quarter of the sample rate has well known ones.
+  constexpr auto kQuarter = butterworth::lowPass<2>(12.5, 50);
+  static_assert(kQuarter.sections[0].b0 > 0.29289 &&
+                    kQuarter.sections[0].b0 < 0.29290,
+                "b0 is 1 / (2 + sqrt(2)).");
+  static_assert(kQuarter.sections[0].a2 > 0.17157 &&
+                    kQuarter.sections[0].a2 < 0.17158,
+                "a2 is 3 - 2 * sqrt(2).");
+  constexpr auto kLowPass = butterworth::lowPass<4>(5, 50);
+  constexpr auto kHighPass = butterworth::highPass<4>(5, 50);
+  constexpr auto kBandPass = butterworth::bandPass<2>(2, 10, 50);
+
+  // A constant passes the low-pass unchanged from the first sample, and is
+  // removed by the high-pass.
+  BiquadCascadeChannel<2> low_pass(kLowPass);
+  BiquadCascadeChannel<2> high_pass(kHighPass);
+  BiquadCascadeChannel<2> band_pass(kBandPass);
+  for (int i = 0; i < 10; ++i) {
+    float out[4];
+    low_pass.update(core::Float4(1, -2, 3, 0.5f)).store(out);
+    assert(std::abs(out[0] - 1) < 1e-5f && std::abs(out[1] + 2) < 1e-5f &&
+           std::abs(out[2] - 3) < 1e-5f && std::abs(out[3] - 0.5f) < 1e-5f);
+    high_pass.update(core::Float4(1, -2, 3, 0.5f)).store(out);
+    assert(std::abs(out[0]) < 1e-5f && std::abs(out[2]) < 1e-5f);
+  }
+
+  // Well below the cutoff a sine keeps its amplitude, well above it is
+  // removed, and the band-pass keeps only the middle one.
+  low_pass.reset();
+  high_pass.reset();
+  float low_pass_peak[3] = {}, high_pass_peak[3] = {}, band_pass_peak[3] = {};
+  for (int i = 0; i < 500; ++i) {
+    const float t = i / 50.f;
+    const float pi = 3.14159265f;
+    float out[4];
+    float* peaks[3] = {low_pass_peak, high_pass_peak, band_pass_peak};
+    const core::Float4 sample(std::sin(2 * pi * 0.5f * t),
+                              std::sin(2 * pi * 5 * t),
+                              std::sin(2 * pi * 20 * t), 0);
+    for (int filter = 0; filter < 3; ++filter) {
+      if (filter == 0) {
+        low_pass.update(sample).store(out);
+      } else if (filter == 1) {
+        high_pass.update(sample).store(out);
+      } else {
+        band_pass.update(sample).store(out);
+      }
+      // Once the start has died away.
+      for (int lane = 0; lane < 3 && i >= 250; ++lane) {
+        peaks[filter][lane] =
+            std::max(peaks[filter][lane], std::abs(out[lane]));
+      }
+    }
+  }
+  assert(low_pass_peak[0] > 0.99f && low_pass_peak[2] < 0.001f);
+  assert(high_pass_peak[0] < 0.001f && high_pass_peak[2] > 0.99f);
+  assert(band_pass_peak[0] < 0.3f && band_pass_peak[1] > 0.9f &&
+         band_pass_peak[2] < 0.3f);
+
+  // The feature filters only its streams, the same one sample at a time and
+  // in batches.
+  features::RootFeature root_feature, batch_root_feature;
+  BiquadFilter<2> filter(root_feature, BiquadFilter<2>::AccelerometerData,
+                         kLowPass);
+  BiquadFilter<2> batch_filter(batch_root_feature,
+                               BiquadFilter<2>::AccelerometerData, kLowPass);
+  std::string str, batch_str;
+  PrintEvents print_events(filter, str);
+  PrintEvents batch_print_events(batch_filter, batch_str);
+  uint64_t timestamps[4];
+  myo::Vector3<float> samples[4];
+  for (int step = 0; step < 5; ++step) {
+    for (int i = 0; i < 4; ++i) {
+      float x = std::sin(0.7f * (4 * step + i));
+      timestamps[i] = 4 * step + i;
+      samples[i] = myo::Vector3<float>(x, 2 * x, -x);
+      root_feature.onAccelerometerData(nullptr, timestamps[i], samples[i]);
+    }
+    batch_root_feature.onAccelerometerDataBatch(
+        nullptr, core::VectorBatch(timestamps, samples, 4));
+  }
+  assert(!str.empty());
+  assert(batch_str == str);
+  str.clear();
+  root_feature.onGyroscopeData(nullptr, 20, myo::Vector3<float>(1, 2, 3));
+  assert(str == "onGyroscopeData - myo: 0x0 timestamp: 20 gyro: (1, 2, 3)\n");
+}
+
+void testOneEuroFilter() {
+  using features::filters::OneEuroChannel;
+  using features::filters::OneEuroFilter;
+  const uint64_t ms = 1000;
+  // A constant passes unchanged.
+  OneEuroChannel<> still(1, 1, 1);
+  for (int i = 0; i < 10; ++i) {
+    float out[4];
+    still.update(20 * ms * i, core::Float4(1, -2, 3, 0.5f)).store(out);
+    assert(out[0] == 1 && out[1] == -2 && out[2] == 3 && out[3] == 0.5f);
+  }
+  // A sample at the same time changes nothing, and one from before the last
+  // starts over.
+  float out[4];
+  still.update(180 * ms, core::Float4(5)).store(out);
+  assert(out[0] == 1);
+  still.update(0, core::Float4(5)).store(out);
+  assert(out[0] == 5);
+
+  // While the signal moves, the cutoff rises with beta, which cuts the lag.
+  OneEuroChannel<> fixed(1, 0, 1);
+  OneEuroChannel<> adaptive(1, 1, 1);
+  float fixed_lag = 0, adaptive_lag = 0;
+  for (int i = 0; i <= 100; ++i) {
+    const float x = 2 * (i / 50.f);
+    fixed.update(20 * ms * i, core::Float4(x)).store(out);
+    fixed_lag = x - out[0];
+    adaptive.update(20 * ms * i, core::Float4(x)).store(out);
+    adaptive_lag = x - out[0];
+  }
+  assert(fixed_lag > 0.3f && fixed_lag < 0.35f);
+  assert(adaptive_lag > 0 && adaptive_lag < fixed_lag / 2);
+
+  // The time between samples comes from their timestamps, so a recording
+  // played back as fast as possible gives the same result as the same events
+  // in real time.
+  std::vector<replay::Record> records;
+  for (int i = 0; i < 10; ++i) {
+    float x = std::sin(0.7f * i);
+    records.push_back(replay::Record::gyroscopeData(
+        0, 5 * ms * i, myo::Vector3<float>(x, 2 * x, -x)));
+    records.push_back(replay::Record::orientationData(
+        0, 5 * ms * i, myo::Quaternion<float>(x, 0, 0, 1)));
+  }
+  std::string replayed_str;
+  {
+    features::RootFeature root_feature;
+    features::Blocker blocker(root_feature, features::Blocker::Periodic);
+    OneEuroFilter filter(
+        blocker, OneEuroFilter::OrientationData | OneEuroFilter::GyroscopeData,
+        1, 0.5f);
+    PrintEvents print_events(filter, replayed_str);
+    replay::Replayer<> replayer(root_feature);
+    replayer.play(records);
+  }
+  std::string real_time_str;
+  {
+    features::RootFeature root_feature;
+    OneEuroFilter filter(
+        root_feature,
+        OneEuroFilter::OrientationData | OneEuroFilter::GyroscopeData, 1,
+        0.5f);
+    PrintEvents print_events(filter, real_time_str);
+    for (const replay::Record& record : records) {
+      record.dispatch(root_feature, nullptr);
+      std::this_thread::sleep_for(std::chrono::microseconds(2500));
+    }
+  }
+  assert(!replayed_str.empty());
+  assert(replayed_str == real_time_str);
+}
+
+void testMedianFilter() {
+  using features::filters::HampelFilter;
+  using features::filters::MedianFilter;
+  // The tree against a sorted copy of the same window, with many duplicates.
+  const std::size_t kWindow = 25;
+  core::OrderStatisticTree<float> tree(kWindow);
+  std::vector<float> window;
+  for (int i = 0; i < 400; ++i) {
+    const float value = float(int(37 * std::sin(1.3 * i)));
+    if (window.size() == kWindow) {
+      assert(tree.erase(window.front()));
+      window.erase(window.begin());
+    }
+    tree.insert(value);
+    window.push_back(value);
+    std::vector<float> sorted = window;
+    std::sort(sorted.begin(), sorted.end());
+    assert(tree.size() == sorted.size());
+    for (std::size_t k = 0; k < sorted.size(); ++k) {
+      assert(tree.select(k) == sorted[k]);
+    }
+    assert(tree.rank(value) ==
+           std::size_t(std::lower_bound(sorted.begin(), sorted.end(), value) -
+                       sorted.begin()));
+  }
+  assert(!tree.erase(1000));
+
+  // A ramp with a spike in x. The median removes the spike but lags by half
+  // its window, and the Hampel filter replaces only the spike.
+  class RecordAccelerometer : public core::DeviceListenerWrapper {
+   public:
+    explicit RecordAccelerometer(core::DeviceListenerWrapper& parent_feature) {
+      parent_feature.addChildFeature(this);
+    }
+    virtual void onAccelerometerData(
+        myo::Myo*, uint64_t, const myo::Vector3<float>& acceleration) override {
+      recorded.push_back(acceleration);
+    }
+    std::vector<myo::Vector3<float>> recorded;
+  };
+  features::RootFeature root_feature;
+  MedianFilter median(root_feature, MedianFilter::AccelerometerData, 5);
+  HampelFilter hampel(root_feature, HampelFilter::AccelerometerData, 7);
+  RecordAccelerometer median_out(median), hampel_out(hampel);
+  auto ramp = [](int i) { return 0.1f * i; };
+  const int kSpike = 20;
+  for (int i = 0; i < 40; ++i) {
+    root_feature.onAccelerometerData(
+        nullptr, i,
+        myo::Vector3<float>(i == kSpike ? 50 : ramp(i), -ramp(i), 2));
+  }
+  assert(median_out.recorded.size() == 40 && hampel_out.recorded.size() == 40);
+  for (int i = 0; i < 40; ++i) {
+    const myo::Vector3<float>& median_sample = median_out.recorded[i];
+    assert(median_sample.x() < ramp(39) && median_sample.z() == 2);
+    if (i >= 4 && (i < kSpike || i > kSpike + 4)) {
+      assert(median_sample.x() == ramp(i - 2));
+      assert(median_sample.y() == -ramp(i - 2));
+    }
+    const myo::Vector3<float>& hampel_sample = hampel_out.recorded[i];
+    assert(hampel_sample.x() == (i == kSpike ? ramp(kSpike - 3) : ramp(i)));
+    assert(hampel_sample.y() == -ramp(i) && hampel_sample.z() == 2);
+  }
+}
+
+void testQuaternionOrientation() {
+  using features::filters::ExponentialMovingAverage;
+  using features::filters::MovingAverage;
+  class RecordOrientation : public core::DeviceListenerWrapper {
+   public:
+    explicit RecordOrientation(core::DeviceListenerWrapper& parent_feature) {
+      parent_feature.addChildFeature(this);
+    }
+    virtual void onOrientationData(
+        myo::Myo*, uint64_t, const myo::Quaternion<float>& rotation) override {
+      recorded.push_back(rotation);
+    }
+    std::vector<myo::Quaternion<float>> recorded;
+  };
+  auto about_z = [](float angle) {
+    return myo::Quaternion<float>(0, 0, std::sin(angle / 2),
+                                  std::cos(angle / 2));
+  };
+  auto near = [](const myo::Quaternion<float>& lhs,
+                 const myo::Quaternion<float>& rhs) {
+    return std::abs(lhs.x() - rhs.x()) < 1e-5f &&
+           std::abs(lhs.y() - rhs.y()) < 1e-5f &&
+           std::abs(lhs.z() - rhs.z()) < 1e-5f &&
+           std::abs(lhs.w() - rhs.w()) < 1e-5f;
+  };
+
+  // The same rotation with its sign flipped every other sample. Component-wise
+  // the average shrinks towards 0, but as rotations it stays the rotation.
+  features::RootFeature root_feature;
+  ExponentialMovingAverage component_wise(
+      root_feature, ExponentialMovingAverage::OrientationData, 0.5f);
+  ExponentialMovingAverage rotations(
+      root_feature,
+      ExponentialMovingAverage::OrientationData |
+          ExponentialMovingAverage::QuaternionOrientation,
+      0.5f);
+  MovingAverage moving_average(
+      root_feature,
+      MovingAverage::OrientationData | MovingAverage::QuaternionOrientation,
+      3);
+  RecordOrientation component_wise_out(component_wise);
+  RecordOrientation rotations_out(rotations);
+  RecordOrientation moving_average_out(moving_average);
+  const myo::Quaternion<float> rotation = about_z(1);
+  const myo::Quaternion<float> flipped(-rotation.x(), -rotation.y(),
+                                       -rotation.z(), -rotation.w());
+  for (int i = 0; i < 6; ++i) {
+    root_feature.onOrientationData(nullptr, i, i % 2 ? flipped : rotation);
+  }
+  assert(std::abs(component_wise_out.recorded.back().w()) < 0.5f);
+  for (int i = 0; i < 6; ++i) {
+    assert(near(rotations_out.recorded[i], rotation));
+    assert(near(moving_average_out.recorded[i], rotation));
+  }
+
+  // Averaging rotations gives a unit quaternion halfway between them, the same
+  // in batches.
+  myo::Quaternion<float> samples[3] = {about_z(0), about_z(0.2f),
+                                       about_z(0.4f)};
+  samples[1] = myo::Quaternion<float>(-samples[1].x(), -samples[1].y(),
+                                      -samples[1].z(), -samples[1].w());
+  uint64_t timestamps[3] = {10, 11, 12};
+  root_feature.onOrientationDataBatch(
+      nullptr, core::OrientationBatch(timestamps, samples, 3));
+  assert(near(moving_average_out.recorded.back(), about_z(0.2f)));
+}
+
+void testOrientation() {
+  using features::Orientation;
+  auto about_x = [](float angle) {
+    return myo::Quaternion<float>(std::sin(angle / 2), 0, 0,
+                                  std::cos(angle / 2));
+  };
+  auto about_y = [](float angle) {
+    return myo::Quaternion<float>(0, std::sin(angle / 2), 0,
+                                  std::cos(angle / 2));
+  };
+  auto near = [](float lhs, float rhs) { return std::abs(lhs - rhs) < 1e-5f; };
+
+  features::RootFeature root_feature;
+  Orientation orientation(root_feature);
+  assert(orientation.getRelativeArmAngle() == 0);
+  assert(orientation.getRelativeWristAngle() == 0);
+  assert(orientation.getArmOrientation() == Orientation::Arm::forearmLevel);
+  assert(orientation.getWristOrientation() ==
+         Orientation::Wrist::palmSideways);
+
+  // The angles follow each new sample, however often they are read.
+  root_feature.onOrientationData(nullptr, 0, about_y(1));
+  assert(near(orientation.getRelativeArmAngle(), 1));
+  assert(near(orientation.getRelativeArmAngle(), 1));
+  assert(orientation.getArmOrientation() == Orientation::Arm::forearmDown);
+  root_feature.onOrientationData(nullptr, 1, about_y(-1));
+  assert(orientation.getArmOrientation() == Orientation::Arm::forearmUp);
+  assert(near(orientation.getRelativeArmAngle(), -1));
+
+  // Calibrating moves the reference even without a new sample.
+  orientation.calibrateOrientation();
+  assert(near(orientation.getRelativeArmAngle(), 0));
+  assert(orientation.getArmOrientation() == Orientation::Arm::forearmLevel);
+  root_feature.onOrientationData(nullptr, 2, about_y(-0.5f));
+  assert(near(orientation.getRelativeArmAngle(), 0.5f));
+
+  // Relative roll wraps around at pi.
+  root_feature.onOrientationData(nullptr, 3, about_x(3));
+  orientation.calibrateOrientation();
+  root_feature.onOrientationData(nullptr, 4, about_x(-2.8f));
+  assert(near(orientation.getRelativeWristAngle(), 2 * M_PI - 5.8f));
+  assert(orientation.getWristOrientation() == Orientation::Wrist::palmUp);
+}
+
 //////////////////////////////
 // Tests using MyoSimulator //
 //////////////////////////////